@@ -0,0 +1,90 @@
+#include "Benchmark.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace jh{
+	namespace bench{
+		namespace{
+			struct Registered{
+				std::string name;
+				Function function;
+			};
+
+			std::vector<Registered>& registry()
+			{
+				static std::vector<Registered> benchmarks;
+				return benchmarks;
+			}
+
+			//prints rate with binary prefix, like 512.3 M/s
+			void printRate(double perSecond, const char* unit)
+			{
+				const char* prefixes[] = { "", "k", "M", "G" };
+				int prefix = 0;
+				while(perSecond >= 1024.0 && prefix < 3)
+				{
+					perSecond /= 1024.0;
+					++prefix;
+				}
+
+				std::printf(" %9.2f %s%s/s", perSecond, prefixes[prefix], unit);
+			}
+		}
+
+		void registerBenchmark(std::string name, Function function)
+		{
+			registry().push_back({ std::move(name), std::move(function) });
+		}
+
+		size_t runBenchmarks(const std::string& filter, double minTime)
+		{
+			size_t width = 10;
+			for(const auto& benchmark : registry())
+				width = std::max(width, benchmark.name.size());
+
+			std::printf("%-*s %12s %14s\n", static_cast<int>(width), "Benchmark", "Iterations", "Time/iter");
+
+			size_t ran = 0;
+			for(const auto& benchmark : registry())
+			{
+				if(benchmark.name.find(filter) == std::string::npos)
+					continue;
+
+				//grow iteration count until one run takes at least minTime
+				size_t iterations = 1;
+				while(true)
+				{
+					State state(iterations);
+					benchmark.function(state);
+
+					double elapsed = state.getElapsed();
+					if(elapsed >= minTime || iterations >= 1000000000)
+					{
+						double perIteration = elapsed / iterations;
+						std::printf("%-*s %12zu %11.0f ns", static_cast<int>(width), benchmark.name.c_str(),
+									iterations, perIteration * 1e9);
+
+						if(state.getBytesProcessed())
+							printRate(state.getBytesProcessed() / perIteration, "B");
+
+						if(state.getItemsProcessed())
+							printRate(state.getItemsProcessed() / perIteration, "items");
+
+						std::printf("\n");
+						break;
+					}
+
+					//aim a bit over minTime, but do not grow more than 10 times at once
+					double estimate = elapsed > 0.0 ? minTime * 1.4 / (elapsed / iterations) : iterations * 10.0;
+					iterations = static_cast<size_t>(std::min(std::max(estimate, iterations + 1.0), iterations * 10.0));
+				}
+
+				++ran;
+			}
+
+			return ran;
+		}
+	}
+}
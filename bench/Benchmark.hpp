@@ -0,0 +1,87 @@
+#ifndef _JH_HEADER_BENCHMARK_
+#define _JH_HEADER_BENCHMARK_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace jh{
+	namespace bench{
+		/*
+			Loop control handed to every benchmark, used the same way as in Google Benchmark:
+
+				registerBenchmark("name", [](State& state){
+					//setup, not measured
+					while(state.keepRunning())
+						//measured code
+					state.setBytesProcessed(bytes per iteration);
+				});
+		*/
+		class State{
+			using Clock = std::chrono::steady_clock;
+
+			size_t iterations;
+			size_t remaining;
+			Clock::time_point start;
+			Clock::time_point end;
+
+			size_t bytes = 0;
+			size_t items = 0;
+		public:
+			explicit State(size_t iterationCount) : iterations(iterationCount), remaining(iterationCount)
+			{
+			}
+
+			bool keepRunning()
+			{
+				if(remaining == iterations)
+					start = Clock::now();
+
+				if(remaining == 0)
+				{
+					end = Clock::now();
+					return false;
+				}
+
+				--remaining;
+				return true;
+			}
+
+			size_t getIterations() const { return iterations; }
+
+			//seconds spent inside the keepRunning loop
+			double getElapsed() const { return std::chrono::duration<double>(end - start).count(); }
+
+			//amount of data one iteration processed, used for MB/s and items/s
+			void setBytesProcessed(size_t perIteration) { bytes = perIteration; }
+			void setItemsProcessed(size_t perIteration) { items = perIteration; }
+
+			size_t getBytesProcessed() const { return bytes; }
+			size_t getItemsProcessed() const { return items; }
+		};
+
+		using Function = std::function<void(State&)>;
+
+		void registerBenchmark(std::string name, Function function);
+
+		//runs every registered benchmark whose name contains filter, each one for at
+		//least minTime seconds, and prints a line for each
+		//returns number of benchmarks run
+		size_t runBenchmarks(const std::string& filter, double minTime);
+
+		//keeps compiler from optimizing away computation of value
+		template<class T>
+		inline void doNotOptimize(const T& value)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			asm volatile("" : : "g"(&value) : "memory");
+#else
+			static volatile const void* sink;
+			sink = &value;
+#endif
+		}
+	}
+}
+
+#endif	//_JH_HEADER_BENCHMARK_
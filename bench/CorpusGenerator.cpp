@@ -0,0 +1,323 @@
+#include "CorpusGenerator.hpp"
+#include <random>
+
+namespace jh{
+	namespace bench{
+		namespace{
+			const char* identifiers[] = {
+				"u", "i", "count", "whichUnit", "caster", "target", "damage", "Index", "data",
+				"GetTriggerUnit", "GetUnitX", "GetUnitY", "CreateUnit", "KillUnit", "udg_Heroes",
+				"TimerStart", "GetExpiredTimer", "SaveInteger", "LoadInteger", "hashTable", "angle",
+			};
+
+			const char* types[] = {
+				"integer", "real", "boolean", "string", "unit", "timer", "player", "thistype",
+			};
+
+			const char* words[] = {
+				"the", "hero", "deals", "bonus", "damage", "to", "nearby", "enemies", "for",
+				"seconds", "and", "heals", "allies", "|cffffcc00Level|r", "\\\"quoted\\\"",
+			};
+
+			class Generator{
+				std::mt19937 random;
+				std::string out;
+				size_t size;
+
+				template<size_t N>
+				const char* pick(const char* (&from)[N])
+				{
+					return from[random() % N];
+				}
+
+				size_t below(size_t limit)
+				{
+					return random() % limit;
+				}
+
+				void indent(size_t depth)
+				{
+					out.append(depth, '\t');
+				}
+
+				void number()
+				{
+					switch(below(5))
+					{
+						case 0: out += std::to_string(below(100)); break;
+						case 1: out += std::to_string(below(100000)); break;
+						case 2: out += std::to_string(below(1000)) + "." + std::to_string(below(100)); break;
+						case 3: out += "0x" + std::to_string(below(9000) + 1000); break;
+						default: out += "." + std::to_string(below(1000)); break;
+					}
+				}
+
+				void rawcode()
+				{
+					static const char letters[] = "AHhnoeuIBRS0123456789";
+					out += '\'';
+					for(int i = 0; i < 4; ++i)
+						out += letters[below(sizeof(letters) - 1)];
+
+					out += '\'';
+				}
+
+				void statement(size_t depth)
+				{
+					indent(depth);
+					switch(below(5))
+					{
+						case 0:
+							out += "local ";
+							out += pick(types);
+							out += " ";
+							out += pick(identifiers);
+							out += " = ";
+							number();
+							break;
+						case 1:
+							out += "set ";
+							out += pick(identifiers);
+							out += " = ";
+							out += pick(identifiers);
+							out += " + ";
+							number();
+							out += " * ";
+							out += pick(identifiers);
+							break;
+						case 2:
+							out += "call ";
+							out += pick(identifiers);
+							out += "(";
+							out += pick(identifiers);
+							out += ", ";
+							number();
+							out += ", \"";
+							out += pick(words);
+							out += "\")";
+							break;
+						case 3:
+							out += "if ";
+							out += pick(identifiers);
+							out += " >= ";
+							number();
+							out += " and not ";
+							out += pick(identifiers);
+							out += " then\n";
+							statement(depth + 1);
+							indent(depth);
+							out += "endif";
+							break;
+						default:
+							out += "// ";
+							out += pick(words);
+							out += " ";
+							out += pick(words);
+							break;
+					}
+
+					out += '\n';
+				}
+
+				void function()
+				{
+					out += "function ";
+					out += pick(identifiers);
+					out += std::to_string(below(1000));
+					out += " takes ";
+					out += pick(types);
+					out += " a returns nothing\n";
+
+					for(size_t i = 0, count = 3 + below(8); i < count; ++i)
+						statement(1);
+
+					out += "endfunction\n\n";
+				}
+
+				void nestedComment(size_t depth)
+				{
+					out += "/* ";
+					for(size_t line = 0, lines = 1 + below(4); line < lines; ++line)
+					{
+						for(int word = 0; word < 6; ++word)
+						{
+							out += pick(words);
+							out += ' ';
+						}
+
+						out += '\n';
+					}
+
+					if(depth > 1)
+						nestedComment(depth - 1);
+
+					out += " * end of level ";
+					out += std::to_string(depth);
+					out += " */\n";
+				}
+
+				void stringTable()
+				{
+					auto name = std::string("STRINGS_") + std::to_string(below(1000));
+
+					out += "globals\n\tconstant string array ";
+					out += name;
+					out += "\nendglobals\n\nfunction Init";
+					out += name;
+					out += " takes nothing returns nothing\n";
+
+					for(size_t i = 0, count = 10 + below(30); i < count; ++i)
+					{
+						out += "\tset ";
+						out += name;
+						out += "[";
+						out += std::to_string(i);
+						out += "] = \"";
+						for(size_t word = 0, count = 4 + below(20); word < count; ++word)
+						{
+							out += pick(words);
+							out += ' ';
+						}
+
+						out += "\"\n";
+					}
+
+					out += "endfunction\n\n";
+				}
+
+				void rawcodeFunction()
+				{
+					out += "function SetupAbilities";
+					out += std::to_string(below(1000));
+					out += " takes unit u returns nothing\n";
+
+					for(size_t i = 0, count = 5 + below(10); i < count; ++i)
+					{
+						if(below(2))
+						{
+							out += "\tcall UnitAddAbility(u, ";
+							rawcode();
+							out += ")\n";
+						}
+						else
+						{
+							out += "\tif GetUnitTypeId(u) == ";
+							rawcode();
+							out += " then\n\t\tcall SetUnitAbilityLevel(u, ";
+							rawcode();
+							out += ", ";
+							number();
+							out += ")\n\tendif\n";
+						}
+					}
+
+					out += "endfunction\n\n";
+				}
+
+				void structBody()
+				{
+					out += "library Lib";
+					out += std::to_string(below(1000));
+					out += " requires Table, optional TimerUtils\n\n\tprivate struct Data extends array\n";
+					out += "\t\treadonly static integer count = 0\n\t\tprivate thistype next\n\t\treal value\n\n";
+
+					for(size_t i = 0, count = 2 + below(4); i < count; ++i)
+					{
+						out += "\t\tprivate static method ";
+						out += pick(identifiers);
+						out += " takes thistype this, integer i returns thistype\n";
+						out += "\t\t\tlocal thistype node = this.next\n";
+						out += "\t\t\tloop\n\t\t\t\texitwhen node == 0 or not node.value > this.value\n";
+						out += "\t\t\t\tset node = node.next\n\t\t\tendloop\n";
+						out += "\t\t\treturn thistype.allocate()\n\t\tendmethod\n\n";
+					}
+
+					out += "\t\tstatic method onInit takes nothing returns nothing\n";
+					out += "\t\t\tset thistype.count = thistype.count + 1\n\t\tendmethod\n";
+					out += "\tendstruct\nendlibrary\n\n";
+				}
+
+				void mixed()
+				{
+					switch(below(8))
+					{
+						case 0: nestedComment(1 + below(3)); break;
+						case 1: stringTable(); break;
+						case 2: rawcodeFunction(); break;
+						case 3: structBody(); break;
+						default: function(); break;
+					}
+				}
+			public:
+				Generator(size_t wanted, unsigned seed) : random(seed), size(wanted)
+				{
+					out.reserve(size + 4096);
+				}
+
+				std::string generate(CorpusKind kind)
+				{
+					while(out.size() < size)
+					{
+						switch(kind)
+						{
+							case CorpusKind::NestedComments:
+								nestedComment(2 + below(6));
+								function();
+								break;
+							case CorpusKind::StringTables:
+								stringTable();
+								break;
+							case CorpusKind::Rawcodes:
+								rawcodeFunction();
+								break;
+							case CorpusKind::KeywordDense:
+								structBody();
+								break;
+							case CorpusKind::Mixed:
+							case CorpusKind::Crlf:
+								mixed();
+								break;
+						}
+					}
+
+					if(kind == CorpusKind::Crlf)
+					{
+						std::string converted;
+						converted.reserve(out.size() + out.size() / 16);
+						for(char c : out)
+						{
+							if(c == '\n')
+								converted += '\r';
+
+							converted += c;
+						}
+
+						return converted;
+					}
+
+					return std::move(out);
+				}
+			};
+		}
+
+		const char* corpusName(CorpusKind kind)
+		{
+			switch(kind)
+			{
+				case CorpusKind::Mixed: return "mixed";
+				case CorpusKind::NestedComments: return "nested_comments";
+				case CorpusKind::StringTables: return "string_tables";
+				case CorpusKind::Rawcodes: return "rawcodes";
+				case CorpusKind::KeywordDense: return "keyword_dense";
+				case CorpusKind::Crlf: return "crlf";
+			}
+
+			return "unknown";
+		}
+
+		std::string generateCorpus(CorpusKind kind, size_t size, unsigned seed)
+		{
+			return Generator(size, seed).generate(kind);
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#ifndef _JH_HEADER_CORPUSGENERATOR_
+#define _JH_HEADER_CORPUSGENERATOR_
+
+#include <cstddef>
+#include <string>
+
+namespace jh{
+	namespace bench{
+		//kinds of synthetic eJass, each stressing different part of the lexer
+		enum class CorpusKind{
+			Mixed,				//a bit of everything, like average map script
+			NestedComments,		//deeply nested /* */ spanning many lines
+			StringTables,		//globals with long string arrays, escapes and color codes
+			Rawcodes,			//ability/unit id heavy code, lots of 'A000'
+			KeywordDense,		//struct and method bodies, mostly keywords and identifiers
+			Crlf,				//same as Mixed, but with \r\n line endings
+		};
+
+		constexpr CorpusKind allCorpusKinds[] = {
+			CorpusKind::Mixed,
+			CorpusKind::NestedComments,
+			CorpusKind::StringTables,
+			CorpusKind::Rawcodes,
+			CorpusKind::KeywordDense,
+			CorpusKind::Crlf,
+		};
+
+		const char* corpusName(CorpusKind kind);
+
+		//generates at least size bytes of given kind of eJass, ending on line boundary
+		//the same seed always gives the same text
+		std::string generateCorpus(CorpusKind kind, size_t size, unsigned seed = 1);
+	}
+}
+
+#endif	//_JH_HEADER_CORPUSGENERATOR_
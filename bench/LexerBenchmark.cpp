@@ -0,0 +1,339 @@
+/*
+	Lexer benchmarks
+
+	Usage: lexer_bench [--filter text] [--min-time seconds] [--large] [--profile file] [file...]
+
+	Every synthetic corpus kind is lexed at 1 KB, 64 KB and 1 MB(and 16 MB, 50 MB
+	with --large), files given on the command line are lexed as they are. Besides
+	whole tokenize, keyword lookup and number literal checks are measured on their own.
+
+	With --profile, nothing is measured, every corpus kind at 1 MB and every file is
+	lexed once instead, and the LexerProfile of each is written into file as one JSON
+	object, keyed by the corpus kind or path. This needs JH_LEXER_PROFILE defined.
+*/
+
+//build from the repository root, e.g.:
+//	g++ -std=c++17 -O2 bench/*.cpp src/Lexer/*.cpp src/Core/SourceFile.cpp src/Core/Interner.cpp src/Core/Arena.cpp
+//		src/Core/Hash.cpp src/Preprocessor/Defines.cpp -o lexer_bench
+//Defines are there for #if conditions the Lexer evaluates, add -DJH_LEXER_PROFILE for --profile
+
+#include "Benchmark.hpp"
+#include "CorpusGenerator.hpp"
+#include "../src/Core/Error.hpp"
+#include "../src/Core/SourceFile.hpp"
+#include "../src/Lexer/CharClass.hpp"
+#include "../src/Lexer/Lexer.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jh{
+	//gives benchmarks access to the private helpers of Lexer
+	struct LexerBenchmark{
+		static Token::Type findKeyword(const Lexer& lexer, std::string_view input, size_t start, size_t end)
+		{
+			return lexer._findKeyword(input, start, end);
+		}
+
+		static int isIntegerLiteral(Lexer& lexer, std::string_view input, size_t start)
+		{
+			return lexer._isIntegerLiteral(input, start);
+		}
+
+		static int isRealLiteral(Lexer& lexer, std::string_view input, size_t start)
+		{
+			return lexer._isRealLiteral(input, start);
+		}
+	};
+}
+
+namespace{
+	using namespace jh;
+	using namespace jh::bench;
+
+	struct Word{
+		size_t start;
+		size_t end;
+	};
+
+	std::string sizeName(size_t size)
+	{
+		if(size >= 1024 * 1024)
+			return std::to_string(size / (1024 * 1024)) + "MB";
+
+		return std::to_string(size / 1024) + "KB";
+	}
+
+	void registerTokenize(const std::string& name, std::shared_ptr<const std::string> input)
+	{
+		Lexer counter;
+		size_t tokens = counter.tokenize(*input).size();
+
+		registerBenchmark("tokenize/" + name, [input, tokens](State& state){
+			while(state.keepRunning())
+			{
+				Lexer lexer;
+				doNotOptimize(lexer.tokenize(*input).data());
+			}
+
+			state.setBytesProcessed(input->size());
+			state.setItemsProcessed(tokens);
+		});
+
+		//the same with one Lexer reset between runs, as a compile server would do
+		registerBenchmark("tokenizeReused/" + name, [input, tokens](State& state){
+			Lexer lexer;
+			while(state.keepRunning())
+			{
+				lexer.reset();
+				doNotOptimize(lexer.tokenize(*input).data());
+			}
+
+			state.setBytesProcessed(input->size());
+			state.setItemsProcessed(tokens);
+		});
+
+		//reused Lexer that also interns identifiers
+		registerBenchmark("tokenizeInterned/" + name, [input, tokens](State& state){
+			Lexer lexer;
+			Interner identifiers;
+			lexer.setInterner(&identifiers);
+			while(state.keepRunning())
+			{
+				lexer.reset();
+				identifiers.clear();
+				doNotOptimize(lexer.tokenize(*input).data());
+			}
+
+			state.setBytesProcessed(input->size());
+			state.setItemsProcessed(tokens);
+		});
+	}
+
+	//every word(keyword or identifier) of the input, as the lexer would see it
+	std::vector<Word> collectWords(const std::string& input)
+	{
+		std::vector<Word> words;
+		for(size_t i = 0; i < input.size();)
+		{
+			if(!hasCharClass(input[i], CharClass::Alpha))
+			{
+				++i;
+				continue;
+			}
+
+			size_t end = i + 1;
+			while(end < input.size() && hasCharClass(input[end], CharClass::Ident))
+				++end;
+
+			words.push_back({ i, end });
+			i = end;
+		}
+
+		return words;
+	}
+
+	void registerKeywordLookup(const std::string& name, std::shared_ptr<const std::string> input)
+	{
+		auto words = std::make_shared<std::vector<Word>>(collectWords(*input));
+
+		size_t bytes = 0;
+		for(const auto& word : *words)
+			bytes += word.end - word.start;
+
+		registerBenchmark("findKeyword/" + name, [input, words, bytes](State& state){
+			Lexer lexer;
+			while(state.keepRunning())
+			{
+				for(const auto& word : *words)
+					doNotOptimize(LexerBenchmark::findKeyword(lexer, *input, word.start, word.end));
+			}
+
+			state.setBytesProcessed(bytes);
+			state.setItemsProcessed(words->size());
+		});
+	}
+
+	void registerLiterals()
+	{
+		//space separated, the checks run until white space
+		auto integers = std::make_shared<std::string>();
+		auto reals = std::make_shared<std::string>();
+		auto integerStarts = std::make_shared<std::vector<size_t>>();
+		auto realStarts = std::make_shared<std::vector<size_t>>();
+
+		const char* integerSpellings[] = { "0", "7", "42", "1337", "65535", "2147483647", "0x1F", "0xFFFFFF", "017", "0777" };
+		const char* realSpellings[] = { "0.5", "3.14159", "100.", ".25", "1024.0", "0.0001", "99999.99", "2." };
+
+		for(int repeat = 0; repeat < 100; ++repeat)
+		{
+			for(const char* spelling : integerSpellings)
+			{
+				integerStarts->push_back(integers->size());
+				*integers += spelling;
+				*integers += ' ';
+			}
+
+			for(const char* spelling : realSpellings)
+			{
+				realStarts->push_back(reals->size());
+				*reals += spelling;
+				*reals += ' ';
+			}
+		}
+
+		registerBenchmark("isIntegerLiteral", [integers, integerStarts](State& state){
+			Lexer lexer;
+			while(state.keepRunning())
+			{
+				for(size_t start : *integerStarts)
+					doNotOptimize(LexerBenchmark::isIntegerLiteral(lexer, *integers, start));
+			}
+
+			state.setBytesProcessed(integers->size() - integerStarts->size());
+			state.setItemsProcessed(integerStarts->size());
+		});
+
+		registerBenchmark("isRealLiteral", [reals, realStarts](State& state){
+			Lexer lexer;
+			while(state.keepRunning())
+			{
+				for(size_t start : *realStarts)
+					doNotOptimize(LexerBenchmark::isRealLiteral(lexer, *reals, start));
+			}
+
+			state.setBytesProcessed(reals->size() - realStarts->size());
+			state.setItemsProcessed(realStarts->size());
+		});
+	}
+
+	using Input = std::pair<std::string, std::shared_ptr<const std::string>>;
+
+	//writes profile of every input into path, returns false if it can not be written
+	bool writeProfiles(const std::string& path, const std::vector<Input>& inputs)
+	{
+#ifdef JH_LEXER_PROFILE
+		std::string json = "{";
+		for(const auto& input : inputs)
+		{
+			Lexer lexer;
+			lexer.tokenize(*input.second);
+
+			json += json.size() > 1 ? ",\n\"" : "\n\"";
+			for(char c : input.first)
+			{
+				if(c == '"' || c == '\\')
+					json += '\\';
+
+				json += c;
+			}
+
+			//every profile is its own object, ending by newline
+			auto profile = lexer.getProfile().toJson();
+			profile.pop_back();
+			json += "\": " + profile;
+		}
+
+		json += "\n}\n";
+
+		std::ofstream file(path, std::ios::binary);
+		if(!file.write(json.data(), json.size()))
+		{
+			jh::error() << "Cannot write profile into '" << path << "'\n";
+			return false;
+		}
+
+		return true;
+#else
+		(void)path;
+		(void)inputs;
+		jh::error() << "lexer_bench was built without JH_LEXER_PROFILE, there is no profile to write\n";
+		return false;
+#endif
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string filter;
+	double minTime = 0.5;
+	bool large = false;
+	std::string profilePath;
+	std::vector<std::string> files;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if(arg == "--filter" && i + 1 < argc)
+			filter = argv[++i];
+		else if(arg == "--min-time" && i + 1 < argc)
+			minTime = std::atof(argv[++i]);
+		else if(arg == "--large")
+			large = true;
+		else if(arg == "--profile" && i + 1 < argc)
+			profilePath = argv[++i];
+		else
+			files.push_back(arg);
+	}
+
+	if(!profilePath.empty())
+	{
+		std::vector<Input> inputs;
+		for(auto kind : allCorpusKinds)
+			inputs.emplace_back(corpusName(kind), std::make_shared<const std::string>(generateCorpus(kind, 1024 * 1024)));
+
+		for(const auto& path : files)
+		{
+			SourceFile file(path);
+			if(!file.isOpen())
+				return 1;
+
+			inputs.emplace_back(path, std::make_shared<const std::string>(file.getView()));
+		}
+
+		return writeProfiles(profilePath, inputs) ? 0 : 1;
+	}
+
+	std::vector<size_t> sizes = { 1024, 64 * 1024, 1024 * 1024 };
+	if(large)
+	{
+		sizes.push_back(16 * 1024 * 1024);
+		sizes.push_back(50 * 1024 * 1024);
+	}
+
+	for(auto kind : allCorpusKinds)
+	{
+		for(size_t size : sizes)
+		{
+			auto input = std::make_shared<const std::string>(generateCorpus(kind, size));
+			registerTokenize(std::string(corpusName(kind)) + "/" + sizeName(size), input);
+		}
+	}
+
+	for(auto kind : allCorpusKinds)
+		registerKeywordLookup(corpusName(kind), std::make_shared<const std::string>(generateCorpus(kind, 64 * 1024)));
+
+	registerLiterals();
+
+	//real-world scripts
+	for(const auto& path : files)
+	{
+		SourceFile file(path);
+		if(!file.isOpen())
+			return 1;
+
+		auto input = std::make_shared<const std::string>(file.getView());
+		registerTokenize(path, input);
+	}
+
+	if(!runBenchmarks(filter, minTime))
+	{
+		jh::error() << "No benchmark matches '" << filter << "'\n";
+		return 1;
+	}
+
+	return 0;
+}
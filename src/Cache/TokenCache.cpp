@@ -0,0 +1,271 @@
+#include "TokenCache.hpp"
+#include "../Core/Error.hpp"
+#include "../Core/Hash.hpp"
+#include "../Lexer/KeywordTable.hpp"
+#include "../Preprocessor/Defines.hpp"
+#include "../Lexer/TokenStream.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <utility>
+
+namespace jh{
+	namespace{
+		/*
+			Layout of cache entry, all numbers little endian
+				char[4]		magic "eJTC"
+				uint32		format version
+				uint32		keyword table version
+				uint32		zero
+				uint64		source size
+				uint64		source key
+				uint64		token count
+				uint64		size of token bytes
+				...			token bytes
+				uint64		XXH64 of token bytes
+		*/
+		constexpr char entryMagic[4] = { 'e', 'J', 'T', 'C' };
+		constexpr std::uint32_t entryVersion = 1;
+		constexpr size_t headerSize = 4 + 3 * 4 + 4 * 8;
+
+		void putInt(std::string& out, std::uint64_t value, size_t bytes)
+		{
+			for(size_t i = 0; i < bytes; ++i, value >>= 8)
+				out.push_back(static_cast<char>(value & 0xFF));
+		}
+
+		std::uint64_t getInt(const char* at, size_t bytes)
+		{
+			std::uint64_t value = 0;
+			for(size_t i = bytes; i > 0; --i)
+				value = (value << 8) | static_cast<unsigned char>(at[i - 1]);
+
+			return value;
+		}
+
+		//deltas are usually small positive numbers, but can go back in theory,
+		//so they are zigzag encoded before going into varint
+		void putVarint(std::string& out, std::uint64_t value)
+		{
+			while(value >= 0x80)
+			{
+				out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+				value >>= 7;
+			}
+
+			out.push_back(static_cast<char>(value));
+		}
+
+		bool getVarint(const char*& at, const char* end, std::uint64_t& value)
+		{
+			value = 0;
+			for(int shift = 0; at < end && shift < 64; shift += 7)
+			{
+				auto byte = static_cast<unsigned char>(*at++);
+				value |= std::uint64_t(byte & 0x7F) << shift;
+				if(!(byte & 0x80))
+					return true;
+			}
+
+			return false;
+		}
+
+		std::uint64_t zigzag(std::int64_t value)
+		{
+			return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+		}
+
+		std::int64_t unzigzag(std::uint64_t value)
+		{
+			return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+		}
+
+		bool readWholeFile(const std::string& path, std::string& out)
+		{
+			std::ifstream file(path, std::ios::binary);
+			if(!file)
+				return false;
+
+			file.seekg(0, std::ios::end);
+			auto size = file.tellg();
+			if(size < 0)
+				return false;
+
+			out.resize(static_cast<size_t>(size));
+			file.seekg(0, std::ios::beg);
+			return static_cast<bool>(file.read(&out[0], size));
+		}
+	}
+
+	TokenCache::TokenCache(std::string cacheDirectory) : directory(std::move(cacheDirectory))
+	{
+	}
+
+	void TokenCache::setDefines(const Defines* conditionDefines)
+	{
+		defines = conditionDefines;
+	}
+
+	std::uint64_t TokenCache::keyOf(std::string_view source) const
+	{
+		std::uint64_t seed = keywordTableVersion;
+		if(defines)
+			seed ^= defines->hash();
+
+		return hash64(source, seed);
+	}
+
+	std::string TokenCache::pathOf(std::uint64_t key) const
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.jtc", static_cast<unsigned long long>(key));
+		return (std::filesystem::path(directory) / name).string();
+	}
+
+	bool TokenCache::load(std::string_view source, Lexer::TokenList& tokens)
+	{
+		auto key = keyOf(source);
+
+		std::string entry;
+		if(!readWholeFile(pathOf(key), entry) || entry.size() < headerSize + 8)
+		{
+			++misses;
+			return false;
+		}
+
+		const char* at = entry.data();
+		size_t payloadSize = getInt(at + 40, 8);
+
+		bool valid = std::equal(entryMagic, entryMagic + 4, at) && getInt(at + 4, 4) == entryVersion &&
+					 getInt(at + 8, 4) == keywordTableVersion && getInt(at + 16, 8) == source.size() &&
+					 getInt(at + 24, 8) == key && payloadSize == entry.size() - headerSize - 8;
+
+		const char* payload = at + headerSize;
+		if(!valid || getInt(payload + payloadSize, 8) != hash64(payload, payloadSize))
+		{
+			++misses;
+			return false;
+		}
+
+		size_t count = getInt(at + 32, 8);
+		tokens.clear();
+		tokens.reserve(count);
+
+		const char* end = payload + payloadSize;
+		std::int64_t position = 0;
+		std::int64_t line = 1;
+		for(size_t i = 0; i < count; ++i)
+		{
+			std::uint64_t positionDelta, lineDelta, length = 0;
+			if(payload >= end)
+				break;
+
+			auto type = static_cast<Token::Type>(static_cast<unsigned char>(*payload++));
+			if(!getVarint(payload, end, positionDelta) || !getVarint(payload, end, lineDelta) ||
+			   (tokenHasLength(type) && !getVarint(payload, end, length)))
+				break;
+
+			position += unzigzag(positionDelta);
+			line += unzigzag(lineDelta);
+			tokens.emplace_back(type, static_cast<int>(position), static_cast<int>(line), static_cast<int>(length));
+		}
+
+		if(tokens.size() != count || payload != end)
+		{
+			tokens.clear();
+			++misses;
+			return false;
+		}
+
+		++hits;
+		return true;
+	}
+
+	bool TokenCache::store(std::string_view source, const Lexer::TokenList& tokens)
+	{
+		auto key = keyOf(source);
+
+		std::string payload;
+		payload.reserve(tokens.size() * 3);
+
+		std::int64_t position = 0;
+		std::int64_t line = 1;
+		for(const auto& token : tokens)
+		{
+			payload.push_back(static_cast<char>(token.type));
+			putVarint(payload, zigzag(token.position - position));
+			putVarint(payload, zigzag(token.line - line));
+			if(tokenHasLength(token.type))
+				putVarint(payload, static_cast<std::uint32_t>(token.length));
+
+			position = token.position;
+			line = token.line;
+		}
+
+		std::string entry;
+		entry.reserve(headerSize + payload.size() + 8);
+		entry.append(entryMagic, 4);
+		putInt(entry, entryVersion, 4);
+		putInt(entry, keywordTableVersion, 4);
+		putInt(entry, 0, 4);
+		putInt(entry, source.size(), 8);
+		putInt(entry, key, 8);
+		putInt(entry, tokens.size(), 8);
+		putInt(entry, payload.size(), 8);
+		entry += payload;
+		putInt(entry, hash64(payload), 8);
+
+		std::error_code code;
+		std::filesystem::create_directories(directory, code);
+
+		//unique per thread, so that two threads storing same source do not collide
+		auto path = pathOf(key);
+		auto temporary = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+		{
+			std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+			if(!file || !file.write(entry.data(), entry.size()))
+			{
+				error() << "Cannot write token cache entry '" << temporary << "'\n";
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temporary, path, code);
+		if(code)
+		{
+			error() << "Cannot write token cache entry '" << path << "'\n";
+			std::filesystem::remove(temporary, code);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TokenCache::tokenize(std::string_view source, Lexer::TokenList& tokens)
+	{
+		if(load(source, tokens))
+			return true;
+
+		Lexer lexer;
+		lexer.setDefines(defines);
+		tokens = std::move(lexer.tokenize(source));
+		if(lexer.getDirectiveErrors().empty())
+			store(source, tokens);
+
+		return false;
+	}
+
+	size_t TokenCache::getHits() const
+	{
+		return hits;
+	}
+
+	size_t TokenCache::getMisses() const
+	{
+		return misses;
+	}
+}
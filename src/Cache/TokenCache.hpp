@@ -0,0 +1,70 @@
+#ifndef _JH_HEADER_TOKENCACHE_
+#define _JH_HEADER_TOKENCACHE_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "../Lexer/Lexer.hpp"
+
+namespace jh{
+	/*
+		On-disk cache of lexed tokens, keyed by the contents of the source
+
+		Key is XXH64 of the source bytes, seeded with keywordTableVersion, so changing
+		the keyword table invalidates every entry without deleting anything. With
+		defines the seed includes their hash too, since they change which code is
+		lexed. Every entry is single file <directory>/<key>.jtc holding the tokens in
+		compact form:
+			header(see TokenCache.cpp), then per token
+			1 byte type, varint position delta, varint line delta, varint length
+			(length only for tokenHasLength types, the others are always 0)
+		and XXH64 of the token bytes, so truncated or damaged entries are ignored.
+
+		Entries are written into temporary file and renamed, so several processes or
+		threads can share one directory.
+	*/
+	class TokenCache{
+		std::string directory;
+
+		//lexes with these when set, see Lexer::setDefines
+		const Defines* defines = nullptr;
+
+		std::atomic<size_t> hits{0};
+		std::atomic<size_t> misses{0};
+	public:
+		//directory is created on first store if it does not exist
+		explicit TokenCache(std::string cacheDirectory);
+
+		TokenCache(const TokenCache&) = delete;
+		TokenCache& operator=(const TokenCache&) = delete;
+
+		//lexes and keys entries with given defines, nullptr for none
+		//the defines have to outlive the cache
+		void setDefines(const Defines* conditionDefines);
+
+		//returns the key given source is stored under
+		std::uint64_t keyOf(std::string_view source) const;
+
+		//returns path of the file holding entry with given key
+		std::string pathOf(std::uint64_t key) const;
+
+		//fills tokens from the cache, returns false if there is no valid entry
+		bool load(std::string_view source, Lexer::TokenList& tokens);
+
+		//stores tokens lexed from source, returns false and reports into error()
+		//if the entry can not be written
+		bool store(std::string_view source, const Lexer::TokenList& tokens);
+
+		//loads tokens of source from the cache, or lexes source and stores them
+		//returns true if the tokens came from the cache
+		//tokens with errors in conditional directives are not stored
+		bool tokenize(std::string_view source, Lexer::TokenList& tokens);
+
+		size_t getHits() const;
+		size_t getMisses() const;
+	};
+}
+
+#endif	//_JH_HEADER_TOKENCACHE_
@@ -0,0 +1,175 @@
+#include "TokenImage.hpp"
+#include "../Core/Hash.hpp"
+#include "../Lexer/KeywordTable.hpp"
+#include "../Preprocessor/Defines.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace jh{
+	namespace{
+		/*
+			Layout of image, all numbers little endian
+				char[4]		magic "eJTI"
+				uint32		format version
+				uint32		0x01020304, reads differently on big endian machine
+				uint32		keyword table version, numbering of token types
+				uint32		size of token record
+				uint32		zero
+				uint64		source size
+				uint64		source key
+				uint64		token count
+				uint64		offset of the first token from the start of image
+				uint64		XXH64 of token records
+				...			token records, from the offset to the end of image
+			token record
+				uint32		type
+				int32		position
+				int32		length
+				int32		line
+		*/
+		constexpr char imageMagic[4] = { 'e', 'J', 'T', 'I' };
+		constexpr std::uint32_t imageVersion = 1;
+		constexpr std::uint32_t byteOrderMark = 0x01020304;
+		constexpr size_t headerSize = 4 + 5 * 4 + 5 * 8;
+		constexpr size_t recordSize = 16;
+
+		//records are used as Tokens, so Token has to look the same
+		static_assert(sizeof(Token) == recordSize, "token record does not match Token");
+		static_assert(offsetof(Token, type) == 0 && offsetof(Token, position) == 4 &&
+					  offsetof(Token, length) == 8 && offsetof(Token, line) == 12, "token record does not match Token");
+		static_assert(headerSize % alignof(Token) == 0, "token records are not aligned");
+
+		char* putInt(char* at, std::uint64_t value, size_t bytes)
+		{
+			for(size_t i = 0; i < bytes; ++i, value >>= 8)
+				*at++ = static_cast<char>(value & 0xFF);
+
+			return at;
+		}
+
+		std::uint64_t getInt(const char* at, size_t bytes)
+		{
+			std::uint64_t value = 0;
+			for(size_t i = bytes; i > 0; --i)
+				value = (value << 8) | static_cast<unsigned char>(at[i - 1]);
+
+			return value;
+		}
+	}
+
+	std::uint64_t TokenImage::keyOf(std::string_view source, const Defines* defines)
+	{
+		std::uint64_t seed = keywordTableVersion;
+		if(defines)
+			seed ^= defines->hash();
+
+		return hash64(source, seed);
+	}
+
+	void TokenImage::encode(const Lexer::TokenList& tokens, std::uint64_t sourceSize, std::uint64_t sourceKey,
+							std::string& out)
+	{
+		size_t start = out.size();
+		out.resize(start + headerSize + tokens.size() * recordSize);
+
+		//records first, the header holds their hash
+		char* records = &out[start + headerSize];
+		char* at = records;
+		for(const auto& token : tokens)
+		{
+			at = putInt(at, static_cast<std::uint32_t>(token.type), 4);
+			at = putInt(at, static_cast<std::uint32_t>(token.position), 4);
+			at = putInt(at, static_cast<std::uint32_t>(token.length), 4);
+			at = putInt(at, static_cast<std::uint32_t>(token.line), 4);
+		}
+
+		at = &out[start];
+		at = std::copy(imageMagic, imageMagic + 4, at);
+		at = putInt(at, imageVersion, 4);
+		at = putInt(at, byteOrderMark, 4);
+		at = putInt(at, keywordTableVersion, 4);
+		at = putInt(at, recordSize, 4);
+		at = putInt(at, 0, 4);
+		at = putInt(at, sourceSize, 8);
+		at = putInt(at, sourceKey, 8);
+		at = putInt(at, tokens.size(), 8);
+		at = putInt(at, headerSize, 8);
+		putInt(at, hash64(records, tokens.size() * recordSize), 8);
+	}
+
+	bool TokenImage::open(const std::string& path)
+	{
+		close();
+		if(!file.open(path))
+			return false;
+
+		if(!view(file.getView()))
+		{
+			file.close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TokenImage::view(std::string_view bytes)
+	{
+		tokens = nullptr;
+		count = 0;
+		if(bytes.size() < headerSize)
+			return false;
+
+		//the mark is read as the machine reads numbers, records are only Tokens on
+		//machines that read it as it was written
+		const char* at = bytes.data();
+		std::uint32_t mark;
+		std::memcpy(&mark, at + 8, 4);
+
+		size_t records = getInt(at + 40, 8);
+		size_t offset = getInt(at + 48, 8);
+		bool valid = std::equal(imageMagic, imageMagic + 4, at) && getInt(at + 4, 4) == imageVersion &&
+					 mark == byteOrderMark && getInt(at + 12, 4) == keywordTableVersion &&
+					 getInt(at + 16, 4) == recordSize && offset == headerSize &&
+					 records == (bytes.size() - headerSize) / recordSize &&
+					 (bytes.size() - headerSize) % recordSize == 0 &&
+					 reinterpret_cast<std::uintptr_t>(at + offset) % alignof(Token) == 0;
+
+		if(!valid)
+			return false;
+
+		sourceSize = getInt(at + 24, 8);
+		sourceKey = getInt(at + 32, 8);
+		tokenHash = getInt(at + 56, 8);
+		tokens = reinterpret_cast<const Token*>(at + offset);
+		count = records;
+		return true;
+	}
+
+	bool TokenImage::verify() const
+	{
+		return hash64(tokens, count * recordSize) == tokenHash;
+	}
+
+	bool TokenImage::matches(std::string_view source, const Defines* defines) const
+	{
+		return tokens && sourceSize == source.size() && sourceKey == keyOf(source, defines);
+	}
+
+	void TokenImage::close()
+	{
+		file.close();
+		tokens = nullptr;
+		count = 0;
+	}
+
+	std::uint64_t TokenImage::getSourceSize() const
+	{
+		return sourceSize;
+	}
+
+	std::uint64_t TokenImage::getSourceKey() const
+	{
+		return sourceKey;
+	}
+}
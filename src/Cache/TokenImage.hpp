@@ -0,0 +1,85 @@
+#ifndef _JH_HEADER_TOKENIMAGE_
+#define _JH_HEADER_TOKENIMAGE_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "../Core/SourceFile.hpp"
+#include "../Lexer/Lexer.hpp"
+
+namespace jh{
+	class Defines;
+
+	/*
+		Binary image of Lexer::TokenList, for processes that share lexed files
+
+		ecomp writes one for every file it compiles with --tokens(see Driver), tools
+		further down the pipeline map the image of the file instead of lexing it
+		again. TokenCache keeps its own compact entries, which are several times
+		smaller on disk and load just as fast.
+
+		The image is laid out to be used straight from memory it is mapped into: fixed
+		header, then every token as 16 byte record of type, position, length and line,
+		each 32 bit little endian, which is how Token itself is laid out on little
+		endian machines. Opening image only checks the header, tokens are neither
+		decoded nor copied, and verify hashes the records only when asked to, so that
+		tools which touch part of the tokens do not read the rest of the file.
+
+		Layout is versioned(see TokenImage.cpp), the Ast is going to follow the tokens
+		as next section of the same file. Images are written on any machine, but only
+		read on little endian ones, elsewhere open fails and the file has to be lexed.
+	*/
+	class TokenImage{
+		//owns the mapping when the image was opened from file
+		SourceFile file;
+
+		const Token* tokens = nullptr;
+		size_t count = 0;
+
+		std::uint64_t sourceSize = 0;
+		std::uint64_t sourceKey = 0;
+		std::uint64_t tokenHash = 0;
+	public:
+		TokenImage() = default;
+
+		TokenImage(const TokenImage&) = delete;
+		TokenImage& operator=(const TokenImage&) = delete;
+
+		//returns key of source lexed with given defines, nullptr for none, the same
+		//TokenCache files its entries by
+		static std::uint64_t keyOf(std::string_view source, const Defines* defines = nullptr);
+
+		//appends image of tokens lexed from source of given size to out, key is any
+		//hash of the source the reader can compare, usually keyOf
+		static void encode(const Lexer::TokenList& tokens, std::uint64_t sourceSize, std::uint64_t sourceKey,
+						   std::string& out);
+
+		//maps image in given file, returns false if it is not valid image
+		//only failing to read the file is reported into error()
+		bool open(const std::string& path);
+
+		//uses image in given bytes, which have to stay alive and unchanged while the
+		//tokens are used, and be aligned to 4 bytes
+		//returns false if they are not valid image
+		bool view(std::string_view bytes);
+
+		//returns whether the tokens match the hash written with them, reads every token
+		bool verify() const;
+
+		//returns whether the image was written for source lexed with given defines,
+		//by size and keyOf
+		bool matches(std::string_view source, const Defines* defines = nullptr) const;
+
+		void close();
+
+		const Token* begin() const { return tokens; }
+		const Token* end() const { return tokens + count; }
+		size_t size() const { return count; }
+
+		std::uint64_t getSourceSize() const;
+		std::uint64_t getSourceKey() const;
+	};
+}
+
+#endif	//_JH_HEADER_TOKENIMAGE_
@@ -0,0 +1,1802 @@
+#include "JassGenerator.hpp"
+#include "../Core/Error.hpp"
+#include "../Lexer/TokenName.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace jh{
+	namespace{
+		constexpr std::string_view indentation = "    ";
+
+		//operator of compound assignment, nullptr for those Jass can not spell
+		const char* compoundOperator(Token::Type type)
+		{
+			switch(type)
+			{
+				case Token::Type::Operator_eqplus:
+				case Token::Type::Operator_increment:
+					return "+";
+				case Token::Type::Operator_eqminus:
+				case Token::Type::Operator_decrement:
+					return "-";
+				case Token::Type::Operator_eqmultiply:
+					return "*";
+				case Token::Type::Operator_eqdivide:
+					return "/";
+				default:
+					return nullptr;
+			}
+		}
+
+		constexpr std::uint64_t kindBit(NodeKind kind)
+		{
+			return std::uint64_t(1) << static_cast<unsigned>(kind);
+		}
+
+		//nodes that are never plain Jass, whatever their token is
+		constexpr std::uint64_t notJass = kindBit(NodeKind::While) | kindBit(NodeKind::For) |
+			kindBit(NodeKind::Break) | kindBit(NodeKind::Member) | kindBit(NodeKind::RunTextmacro);
+
+		//for every token type, kinds of nodes that are not plain Jass when made from it
+		//looked up for every node of a function, so that the check does not branch
+		struct NotJassTable{
+			std::uint64_t kinds[static_cast<size_t>(Token::Type::Id) + 1];
+
+			NotJassTable()
+			{
+				//set with anything else than = is compound assignment
+				for(auto& entry : kinds)
+					entry = notJass | kindBit(NodeKind::Set);
+
+				auto add = [&](Token::Type type, std::uint64_t bits){ kinds[static_cast<size_t>(type)] |= bits; };
+
+				kinds[static_cast<size_t>(Token::Type::Operator_assign)] = notJass;
+				add(Token::Type::Literal_super, kindBit(NodeKind::Name) | kindBit(NodeKind::TypeRef));
+				add(Token::Type::Keyword_thistype, kindBit(NodeKind::Name) | kindBit(NodeKind::TypeRef));
+				add(Token::Type::Operator_modulo, kindBit(NodeKind::Binary));
+				add(Token::Type::Operator_lshift, kindBit(NodeKind::Binary));
+				add(Token::Type::Operator_rshift, kindBit(NodeKind::Binary));
+				add(Token::Type::Operator_plus, kindBit(NodeKind::Unary));
+			}
+		};
+
+		const NotJassTable notJassTable;
+
+		//expressions that do not need parentheses to be operand of not or arithmetic
+		bool isAtom(NodeKind kind)
+		{
+			switch(kind)
+			{
+				case NodeKind::Literal:
+				case NodeKind::Name:
+				case NodeKind::Call:
+				case NodeKind::Index:
+				case NodeKind::Member:
+				case NodeKind::Paren:
+				case NodeKind::FunctionRef:
+					return true;
+				default:
+					return false;
+			}
+		}
+	}
+
+	void JassGenerator::setDebug(bool enabled)
+	{
+		debugMode = enabled;
+	}
+
+	void JassGenerator::setSplices(const std::vector<TokenRange>* ranges)
+	{
+		splices = ranges;
+	}
+
+	void JassGenerator::setNames(const NameResolver* resolver)
+	{
+		names = resolver;
+	}
+
+	void JassGenerator::setAllocator(AllocatorKind kind)
+	{
+		allocator = kind;
+	}
+
+	void JassGenerator::setOptimizer(const Optimizer* tree)
+	{
+		optimizer = tree;
+	}
+
+	void JassGenerator::setMinifier(const Minifier* shortNames)
+	{
+		minifier = shortNames;
+		separator = minifier ? "," : ", ";
+		assignment = minifier ? "=" : " = ";
+		increment = minifier ? "+1" : " + 1";
+		decrement = minifier ? "-1" : " - 1";
+		isZero = minifier ? "==0 then" : " == 0 then";
+	}
+
+	void JassGenerator::_error(NodeIndex node, const std::string& message)
+	{
+		++errorCount;
+
+		size_t line = ast->token(node).line;
+		if(fileName.empty())
+			error() << "line " << line << ": " << message << "\n";
+		else
+			error() << fileName << ":" << line << ": " << message << "\n";
+	}
+
+	void JassGenerator::_unsupported(NodeIndex node, const char* what)
+	{
+		_error(node, std::string(what) + " can not be written as Jass");
+	}
+
+	void JassGenerator::_collect(NodeIndex block)
+	{
+		for(auto declaration : ast->children(block))
+		{
+			const auto& node = (*ast)[declaration];
+			switch(node.kind)
+			{
+				case NodeKind::Globals:
+					for(auto variable : ast->children(declaration))
+						globals.push_back(variable);
+
+					break;
+				case NodeKind::TypeDecl:
+					types.push_back(declaration);
+					break;
+				case NodeKind::Native:
+					natives.push_back(declaration);
+					break;
+				case NodeKind::Function:
+					functions.push_back(declaration);
+					break;
+				case NodeKind::Library:
+					//already collected in requirement order, see _collectLibraries
+					break;
+				case NodeKind::Scope:
+					if(ast->child(declaration, 0) != noNode)
+						scopeInitializers.push_back(ast->child(declaration, 0));
+
+					_collect(ast->child(declaration, 1));
+					break;
+				case NodeKind::Struct:
+					_collectStruct(declaration);
+					break;
+				case NodeKind::Interface:
+					_unsupported(declaration, "interface");
+					break;
+				case NodeKind::RunTextmacro:
+					_unsupported(declaration, "runtextmacro");
+					break;
+				default:
+					//modules and textmacros are only templates, they write nothing themselves
+					break;
+			}
+		}
+	}
+
+	void JassGenerator::_collectLibraries(NodeIndex file)
+	{
+		libraries.clear();
+		for(auto declaration : ast->children(file))
+		{
+			if((*ast)[declaration].kind == NodeKind::Library)
+				libraries.push_back(declaration);
+		}
+
+		//every library is placed once all libraries it requires are, ties keep source
+		//order, maps have tens of libraries, so it just goes through them again
+		size_t placed = 0;
+		while(placed < libraries.size())
+		{
+			size_t next = placed;
+			for(; next < libraries.size(); ++next)
+			{
+				bool ready = true;
+				for(auto requirement : ast->children(ast->child(libraries[next], 1)))
+				{
+					auto required = std::find_if(libraries.begin() + placed, libraries.end(), [&](NodeIndex library){
+						return ast->text(library) == ast->text(requirement);
+					});
+
+					ready = ready && required == libraries.end();
+				}
+
+				if(ready)
+					break;
+			}
+
+			//requirement cycle, LibraryGraph reports those, the rest stays in source order
+			if(next == libraries.size())
+				break;
+
+			std::rotate(libraries.begin() + placed, libraries.begin() + next, libraries.begin() + next + 1);
+			++placed;
+		}
+
+		for(auto library : libraries)
+		{
+			if(ast->child(library, 0) != noNode)
+				libraryInitializers.push_back(ast->child(library, 0));
+
+			_collect(ast->child(library, 2));
+		}
+	}
+
+	void JassGenerator::_collectStruct(NodeIndex declaration)
+	{
+		//members are found through the scopes of the resolver
+		if(!names)
+		{
+			_unsupported(declaration, "struct");
+			return;
+		}
+
+		std::string name(ast->text(declaration));
+		auto parent = ast->child(declaration, 0);
+		if(parent != noNode && ast->token(parent).type != Token::Type::Keyword_array)
+			_unsupported(parent, "struct extending struct");
+
+		for(auto member : ast->children(ast->child(declaration, 1)))
+		{
+			switch((*ast)[member].kind)
+			{
+				case NodeKind::Variable:
+				case NodeKind::Method:
+				case NodeKind::Allocator:
+				case NodeKind::Textmacro:
+					break;
+				case NodeKind::Implement:
+					_unsupported(member, "implement");
+					break;
+				default:
+					_error(member, "only members and methods can be declared inside struct " + name);
+					break;
+			}
+		}
+
+		const auto& info = layout.add(declaration, allocator);
+		if(info.allocator == AllocatorKind::User)
+		{
+			bool allocates = false;
+			bool deallocates = false;
+			for(auto method : info.methods)
+			{
+				allocates = allocates || ast->text(method) == "allocate";
+				deallocates = deallocates || ast->text(method) == "deallocate";
+			}
+
+			if(!allocates || !deallocates)
+				_error(info.allocatorBlock, "allocator of " + name + " has to declare allocate and deallocate");
+		}
+
+		if(info.allocator == AllocatorKind::None && info.constructor != noNode)
+			_error(info.constructor, name + " extends array, it can not have constructor");
+
+		if(info.constructor != noNode && info.create != noNode)
+			_error(info.create, name + " has constructor, it can not declare create");
+
+		if(info.destructor != noNode && info.destroy != noNode)
+			_error(info.destroy, name + " has destructor, it can not declare destroy");
+
+		//allocator functions come before the methods, those usually create instances
+		globals.push_back(declaration);
+		functions.push_back(declaration);
+		_collectMethods(info);
+	}
+
+	void JassGenerator::_collectMethods(const StructInfo& info)
+	{
+		const auto& table = names->getTable();
+		const auto& methods = info.methods;
+
+		//methods of the struct every method calls, gets or refers to, as pairs of
+		//indices into methods, the method and the one it uses
+		std::vector<std::pair<size_t, size_t>> uses;
+		for(size_t i = 0; i < methods.size(); ++i)
+		{
+			auto use = [&](NodeIndex method){
+				auto used = std::find(methods.begin(), methods.end(), method);
+				if(used != methods.end() && size_t(used - methods.begin()) != i)
+					uses.emplace_back(i, used - methods.begin());
+			};
+
+			for(NodeIndex node = ast->subtreeStart(methods[i]); node < methods[i]; ++node)
+			{
+				auto kind = (*ast)[node].kind;
+				MemberAccess access;
+				if(kind == NodeKind::Name && names->symbolOf(node) != noSymbol &&
+				   table[names->symbolOf(node)].kind == SymbolKind::Method)
+					use(table[names->symbolOf(node)].node);
+				else if(kind == NodeKind::Name && _bareOperator(node, &info, access))
+				{
+					use(access.declaration);
+					use(access.setter);
+				}
+				else if(kind == NodeKind::Member && layout.resolveMember(node, &info, access) && access.owner == &info)
+				{
+					use(access.declaration);
+					use(access.setter);
+				}
+			}
+		}
+
+		//Jass has no prototypes, every method is written after the ones it uses, ties
+		//keep the declaration order
+		std::vector<char> written(methods.size());
+		size_t writtenCount = 0;
+		while(writtenCount < methods.size())
+		{
+			size_t next = 0;
+			for(; next < methods.size(); ++next)
+			{
+				bool ready = !written[next] && std::none_of(uses.begin(), uses.end(), [&](const std::pair<size_t, size_t>& use){
+					return use.first == next && !written[use.second];
+				});
+
+				if(ready)
+					break;
+			}
+
+			if(next == methods.size())
+				break;
+
+			written[next] = true;
+			++writtenCount;
+			functions.push_back(methods[next]);
+		}
+
+		if(writtenCount == methods.size())
+			return;
+
+		//vJass calls these through triggers, which is not done here
+		std::string cycle;
+		NodeIndex first = noNode;
+		for(size_t i = 0; i < methods.size(); ++i)
+		{
+			if(written[i])
+				continue;
+
+			first = first == noNode ? methods[i] : first;
+			cycle += cycle.empty() ? "" : ", ";
+			cycle += ast->text(methods[i]);
+			functions.push_back(methods[i]);
+		}
+
+		_error(first, "methods " + cycle + " of " + std::string(ast->text(info.node)) +
+			   " use each other, Jass can not call function declared after the caller");
+	}
+
+	std::string_view JassGenerator::_plainJass(NodeIndex function) const
+	{
+		const auto& tokens = ast->getTokens();
+		auto source = ast->getSource();
+
+		//locals have to be the first statements of the body
+		size_t leadingLocals = 0;
+		for(auto statement : ast->children(ast->child(function, 2)))
+		{
+			if((*ast)[statement].kind != NodeKind::Local)
+				break;
+
+			++leadingLocals;
+		}
+
+		//the source has the original names, and comments and indentation minifier strips
+		if(minifier || (names && names->isRenamed(function)) || (optimizer && optimizer->isRewritten(function)))
+			return std::string_view();
+
+		//the function and everything in it are one range of indices ending at the function
+		NodeIndex start = ast->subtreeStart(function);
+
+		size_t locals = 0;
+		size_t lastToken = (*ast)[function].token;
+		std::uint64_t bad = 0;
+		for(NodeIndex index = start; index < function && !bad; ++index)
+		{
+			const auto& node = (*ast)[index];
+			auto type = static_cast<size_t>(tokens[node.token].type);
+
+			bad = (notJassTable.kinds[type] & kindBit(node.kind)) | (node.flags & (NodeFlag::Debug | NodeFlag::Implicit));
+			locals += node.kind == NodeKind::Local;
+			lastToken = node.token > lastToken ? node.token : lastToken;
+
+			if(names && names->isRenamed(index))
+				return std::string_view();
+
+			//! is lexed as not
+			if(node.kind == NodeKind::Unary && source[tokens[node.token].position] == '!')
+				return std::string_view();
+		}
+
+		//any local past the leading ones is in the middle of the body
+		if(bad || locals != leadingLocals)
+			return std::string_view();
+
+		//the function keyword is right before the name, endfunction is few tokens after
+		//the last one any node was made from, there are only comments and ) between
+		size_t first = (*ast)[function].token;
+		while(first > 0 && tokens[first].type != Token::Type::Keyword_function)
+			--first;
+
+		size_t last = lastToken;
+		while(last < tokens.size() && tokens[last].type != Token::Type::Keyword_endfunction)
+			++last;
+
+		if(last == tokens.size())
+			return std::string_view();
+
+		if(splices)
+		{
+			auto splice = std::lower_bound(splices->begin(), splices->end(), first, [](const TokenRange& range, size_t index){
+				return range.last <= index;
+			});
+
+			if(splice != splices->end() && splice->first <= last)
+				return std::string_view();
+		}
+
+		auto from = tokens[first].position;
+		auto to = tokens[last].position + std::strlen(tokenTypeName(Token::Type::Keyword_endfunction));
+		auto text = source.substr(from, to - from);
+
+		//block comments are not Jass, and neither are #if directives, the text between
+		//them may not even be lexed, this finds both in strings too, those functions
+		//are just written node by node
+		if(text.find("/*") != std::string_view::npos || text.find('#') != std::string_view::npos)
+			return std::string_view();
+
+		return text;
+	}
+
+	void JassGenerator::_indent(size_t depth)
+	{
+		if(minifier)
+			return;
+
+		for(size_t i = 0; i < depth; ++i)
+			out->write(indentation);
+	}
+
+	void JassGenerator::_writeText(NodeIndex node)
+	{
+		if(minifier)
+		{
+			auto symbol = names->symbolOf(node);
+			if(minifier->isRenamed(symbol))
+			{
+				out->write(minifier->nameOf(symbol));
+				return;
+			}
+		}
+
+		out->write(names ? names->outputName(node) : ast->text(node));
+	}
+
+	void JassGenerator::_writeType(NodeIndex typeRef)
+	{
+		if(names && layout.find(names->symbolOf(typeRef)))
+			out->write("integer");
+		else
+			_writeText(typeRef);
+	}
+
+	void JassGenerator::_writeLine(size_t depth, std::initializer_list<std::string_view> parts)
+	{
+		_indent(depth);
+		for(auto part : parts)
+			out->write(part);
+
+		out->put('\n');
+	}
+
+	void JassGenerator::_writeVariable(NodeIndex variable, bool withValue)
+	{
+		const auto& node = (*ast)[variable];
+
+		if(node.flags & NodeFlag::Constant)
+			out->write("constant ");
+
+		_writeType(ast->child(variable, 0));
+		out->write(node.flags & NodeFlag::Array ? " array " : " ");
+		_writeText(variable);
+
+		//array size of eJass is only checked by the compiler, Jass arrays have none
+		auto value = ast->child(variable, 1);
+		if(withValue && value != noNode)
+		{
+			out->write(assignment);
+			_writeExpression(value);
+		}
+	}
+
+	void JassGenerator::_writeParameters(NodeIndex parameters, bool takesThis)
+	{
+		out->write(" takes ");
+		if(takesThis)
+			out->write("integer this");
+		else if(!ast->children(parameters).size())
+			out->write("nothing");
+
+		bool first = !takesThis;
+		for(auto parameter : ast->children(parameters))
+		{
+			if(!first)
+				out->write(separator);
+
+			first = false;
+			_writeType(ast->child(parameter, 0));
+			out->put(' ');
+			_writeText(parameter);
+		}
+	}
+
+	void JassGenerator::_writeSignature(NodeIndex parameters, NodeIndex returns, bool takesThis)
+	{
+		_writeParameters(parameters, takesThis);
+
+		out->write(" returns ");
+		if(returns == noNode)
+			out->write("nothing");
+		else
+			_writeType(returns);
+	}
+
+	size_t JassGenerator::_writeLocals(NodeIndex block)
+	{
+		auto statements = ast->children(block);
+
+		size_t leading = 0;
+		while(leading < statements.size() && (*ast)[statements[leading]].kind == NodeKind::Local &&
+			  !((*ast)[statements[leading]].flags & NodeFlag::Debug))
+		{
+			_indent(1);
+			out->write("local ");
+			_writeVariable(statements[leading], true);
+			out->put('\n');
+			++leading;
+		}
+
+		_hoistLocals(block, leading);
+		return leading;
+	}
+
+	void JassGenerator::_writeFunction(NodeIndex function)
+	{
+		const auto& node = (*ast)[function];
+
+		bool isMain = ast->text(function) == "main";
+		bool initializes = isMain && (libraryInitializers.size() || scopeInitializers.size());
+
+		if(node.flags & NodeFlag::Constant)
+			out->write("constant ");
+
+		if(!initializes)
+		{
+			auto text = _plainJass(function);
+			if(!text.empty())
+			{
+				out->write(text);
+				out->put('\n');
+				++copiedCount;
+				return;
+			}
+		}
+
+		out->write("function ");
+		_writeText(function);
+		_writeSignature(ast->child(function, 0), ast->child(function, 1));
+		out->put('\n');
+
+		auto block = ast->child(function, 2);
+		auto statements = ast->children(block);
+		size_t leading = _writeLocals(block);
+
+		if(initializes)
+		{
+			for(const auto* list : { &libraryInitializers, &scopeInitializers })
+			{
+				for(auto initializer : *list)
+				{
+					_indent(1);
+					out->write("call ExecuteFunc(\"");
+					_writeText(initializer);
+					out->write("\")\n");
+				}
+			}
+		}
+
+		for(size_t i = leading; i < statements.size(); ++i)
+			_writeStatement(statements[i], 1);
+
+		out->write("endfunction\n");
+	}
+
+	void JassGenerator::_writeStructGlobals(const StructInfo& info)
+	{
+		for(auto variable : info.statics)
+		{
+			_indent(1);
+			_writeVariable(variable, true);
+			out->put('\n');
+		}
+
+		for(auto variable : info.members)
+		{
+			_indent(1);
+			_writeType(ast->child(variable, 0));
+			out->write(" array ");
+			_writeText(variable);
+			out->put('\n');
+		}
+
+		//instances are counted from 1, 0 stays null
+		if(info.allocator == AllocatorKind::Bump || info.allocator == AllocatorKind::FreeList)
+		{
+			_writeLine(1, { "integer array ", _structName(info, StructName::Free) });
+			_writeLine(1, { "integer ", _structName(info, StructName::Count), assignment, "0" });
+		}
+
+		if(info.allocator == AllocatorKind::Bump)
+			_writeLine(1, { "integer ", _structName(info, StructName::Freed), assignment, "0" });
+	}
+
+	void JassGenerator::_writeAllocator(const StructInfo& info)
+	{
+		if(info.allocator != AllocatorKind::Bump && info.allocator != AllocatorKind::FreeList)
+			return;
+
+		_writeLine(0, { "function ", _structName(info, StructName::Allocate), " takes nothing returns integer" });
+		_writeLine(1, { "local integer this" });
+		_writeAllocation(info, 1);
+		_writeLine(1, { "return this" });
+		_writeLine(0, { "endfunction" });
+
+		_writeLine(0, { "function ", _structName(info, StructName::Deallocate), " takes integer this returns nothing" });
+		_writeDeallocation(info, 1);
+		_writeLine(0, { "endfunction" });
+	}
+
+	std::string_view JassGenerator::_structName(const StructInfo& info, StructName part)
+	{
+		if(minifier)
+		{
+			auto name = minifier->structName(info.node, part);
+			if(!name.empty())
+				return name;
+		}
+
+		auto& name = structNames[static_cast<size_t>(part)];
+		name.assign(info.prefix);
+		name += structSuffixes[static_cast<size_t>(part)];
+		return name;
+	}
+
+	void JassGenerator::_writeAllocation(const StructInfo& info, size_t depth)
+	{
+		auto free = _structName(info, StructName::Free);
+		auto count = _structName(info, StructName::Count);
+		auto freed = _structName(info, StructName::Freed);
+		switch(info.allocator)
+		{
+			case AllocatorKind::Bump:
+				//freed instances are on stack of _freed entries, popping one is one read
+				_writeLine(depth, { "if ", freed, isZero });
+				_writeLine(depth + 1, { "set ", count, assignment, count, increment });
+				_writeLine(depth + 1, { "set this", assignment, count });
+				_writeLine(depth, { "else" });
+				_writeLine(depth + 1, { "set ", freed, assignment, freed, decrement });
+				_writeLine(depth + 1, { "set this", assignment, free, "[", freed, "]" });
+				_writeLine(depth, { "endif" });
+				break;
+			case AllocatorKind::FreeList:
+				//_free[0] is the last freed instance, every freed one links the one before
+				_writeLine(depth, { "set this", assignment, free, "[0]" });
+				_writeLine(depth, { "if this", isZero });
+				_writeLine(depth + 1, { "set ", count, assignment, count, increment });
+				_writeLine(depth + 1, { "set this", assignment, count });
+				_writeLine(depth, { "else" });
+				_writeLine(depth + 1, { "set ", free, "[0]", assignment, free, "[this]" });
+				_writeLine(depth, { "endif" });
+				break;
+			case AllocatorKind::User:
+				_writeLine(depth, { "set this", assignment, _structName(info, StructName::Allocate), "()" });
+				break;
+			case AllocatorKind::None:
+				break;
+		}
+
+		//initial values of members
+		for(auto variable : info.members)
+		{
+			auto value = ast->child(variable, 1);
+			if(value == noNode || ((*ast)[variable].flags & NodeFlag::Array))
+				continue;
+
+			_indent(depth);
+			out->write("set ");
+			_writeText(variable);
+			out->write("[this]");
+			out->write(assignment);
+			_writeExpression(value);
+			out->put('\n');
+		}
+	}
+
+	void JassGenerator::_writeDeallocation(const StructInfo& info, size_t depth)
+	{
+		auto free = _structName(info, StructName::Free);
+		auto freed = _structName(info, StructName::Freed);
+		switch(info.allocator)
+		{
+			case AllocatorKind::Bump:
+				_writeLine(depth, { "set ", free, "[", freed, "]", assignment, "this" });
+				_writeLine(depth, { "set ", freed, assignment, freed, increment });
+				break;
+			case AllocatorKind::FreeList:
+				_writeLine(depth, { "set ", free, "[this]", assignment, free, "[0]" });
+				_writeLine(depth, { "set ", free, "[0]", assignment, "this" });
+				break;
+			case AllocatorKind::User:
+				_writeLine(depth, { "call ", _structName(info, StructName::Deallocate), "(this)" });
+				break;
+			case AllocatorKind::None:
+				break;
+		}
+	}
+
+	void JassGenerator::_writeMethodName(const StructInfo& info, NodeIndex method)
+	{
+		const auto& node = (*ast)[method];
+		if(!(node.flags & NodeFlag::Operator) && method != info.constructor && method != info.destructor)
+		{
+			_writeText(method);
+			return;
+		}
+
+		if(minifier)
+		{
+			//onDestroy written as destructor keeps the name of the method
+			auto symbol = names->symbolOf(method);
+			auto name = minifier->isRenamed(symbol) ? minifier->nameOf(symbol) : minifier->methodName(method);
+			if(!name.empty())
+			{
+				out->write(name);
+				return;
+			}
+		}
+
+		out->write(info.prefix);
+		if(method == info.constructor)
+			out->write("create");
+		else if(method == info.destructor)
+			out->write("destroy");
+		else
+		{
+			//s__A__get_x, s__A__setindex, ...
+			out->write(node.flags & NodeFlag::Setter ? "_set" : "_get");
+			if(ast->token(method).type == Token::Type::Operator_LBPar)
+				out->write("index");
+			else if(ast->token(method).type == Token::Type::Id)
+			{
+				out->put('_');
+				out->write(ast->text(method));
+			}
+			else
+				_unsupported(method, "method operator other than [] and member");
+		}
+	}
+
+	void JassGenerator::_writeMethod(NodeIndex method)
+	{
+		const auto& node = (*ast)[method];
+		const auto& info = *currentStruct;
+		bool constructs = method == info.constructor;
+		bool destructs = method == info.destructor;
+		currentMethod = method;
+
+		out->write("function ");
+		_writeMethodName(info, method);
+
+		auto block = ast->child(method, 2);
+		size_t leading = 0;
+		if(constructs)
+		{
+			//locals are set after the allocation, their values may use the members
+			_writeParameters(ast->child(method, 0), false);
+			out->write(" returns integer\n");
+			_writeLine(1, { "local integer this" });
+			_hoistLocals(block, 0);
+			_writeAllocation(info, 1);
+		}
+		else
+		{
+			_writeSignature(ast->child(method, 0), ast->child(method, 1), !(node.flags & NodeFlag::Static));
+			out->put('\n');
+			leading = _writeLocals(block);
+		}
+
+		auto statements = ast->children(block);
+		for(size_t i = leading; i < statements.size(); ++i)
+			_writeStatement(statements[i], 1);
+
+		if(constructs)
+			_writeLine(1, { "return this" });
+		else if(destructs)
+			_writeDeallocation(info, 1);
+
+		out->write("endfunction\n");
+		currentMethod = noNode;
+	}
+
+	bool JassGenerator::_writeCalledName(NodeIndex member, const MemberAccess& access)
+	{
+		const auto& info = *access.owner;
+		if(access.declaration != noNode)
+		{
+			const auto& node = (*ast)[access.declaration];
+			if(node.kind != NodeKind::Method || (node.flags & NodeFlag::Operator))
+				return false;
+
+			_writeMethodName(info, access.declaration);
+			return true;
+		}
+
+		//create and destroy without constructor and destructor are just the allocator
+		auto name = ast->text(member);
+		bool allocates = info.allocator != AllocatorKind::None;
+
+		NodeIndex method = noNode;
+		StructName function;
+		if(name == "create" && allocates)
+		{
+			method = info.constructor;
+			function = StructName::Allocate;
+		}
+		else if(name == "destroy" && (allocates || info.destructor != noNode))
+		{
+			method = info.destructor;
+			function = StructName::Deallocate;
+		}
+		else if(name == "allocate" && allocates)
+			function = StructName::Allocate;
+		else if(name == "deallocate" && allocates)
+			function = StructName::Deallocate;
+		else
+			return false;
+
+		if(method != noNode)
+			_writeMethodName(info, method);
+		else
+			out->write(_structName(info, function));
+
+		return true;
+	}
+
+	void JassGenerator::_hoistLocals(NodeIndex block, size_t skip)
+	{
+		auto statements = ast->children(block);
+		for(size_t i = skip; i < statements.size(); ++i)
+		{
+			auto statement = statements[i];
+			const auto& node = (*ast)[statement];
+			if((node.flags & NodeFlag::Debug) && !debugMode)
+				continue;
+
+			switch(node.kind)
+			{
+				case NodeKind::Local:
+					_indent(1);
+					out->write("local ");
+					_writeVariable(statement, false);
+					out->put('\n');
+					break;
+				case NodeKind::If:
+					_hoistLocals(ast->child(statement, 1), 0);
+					for(auto branch = ast->child(statement, 2); branch != noNode;)
+					{
+						if((*ast)[branch].kind == NodeKind::Block)
+						{
+							_hoistLocals(branch, 0);
+							break;
+						}
+
+						_hoistLocals(ast->child(branch, 1), 0);
+						branch = ast->child(branch, 2);
+					}
+
+					break;
+				case NodeKind::Loop:
+					_hoistLocals(ast->child(statement, 0), 0);
+					break;
+				case NodeKind::While:
+					_hoistLocals(ast->child(statement, 1), 0);
+					break;
+				case NodeKind::For:
+				{
+					auto init = ast->child(statement, 0);
+					if(init != noNode && (*ast)[init].kind == NodeKind::Local)
+					{
+						_indent(1);
+						out->write("local ");
+						_writeVariable(init, false);
+						out->put('\n');
+					}
+
+					_hoistLocals(ast->child(statement, 3), 0);
+					break;
+				}
+				default:
+					break;
+			}
+		}
+	}
+
+	void JassGenerator::_writeStatements(NodeIndex block, size_t depth)
+	{
+		for(auto statement : ast->children(block))
+			_writeStatement(statement, depth);
+	}
+
+	void JassGenerator::_writeStatement(NodeIndex statement, size_t depth)
+	{
+		const auto& node = (*ast)[statement];
+		if((node.flags & NodeFlag::Debug) && !debugMode)
+			return;
+
+		switch(node.kind)
+		{
+			case NodeKind::Local:
+			{
+				//declared at the top already, see _hoistLocals
+				auto value = ast->child(statement, 1);
+				if(value == noNode)
+					break;
+
+				_indent(depth);
+				out->write("set ");
+				_writeText(statement);
+				out->write(assignment);
+				_writeExpression(value);
+				out->put('\n');
+				break;
+			}
+			case NodeKind::Set:
+				_writeSet(statement, depth);
+				break;
+			case NodeKind::CallStatement:
+				if(optimizer && optimizer->isInlined(ast->child(statement, 0)))
+				{
+					_writeInlined(ast->child(statement, 0), true, depth);
+					break;
+				}
+
+				_indent(depth);
+				out->write("call ");
+				_writeExpression(ast->child(statement, 0));
+				out->put('\n');
+				break;
+			case NodeKind::If:
+			{
+				_indent(depth);
+				out->write("if ");
+				_writeExpression(ast->child(statement, 0));
+				out->write(" then\n");
+				_writeStatements(ast->child(statement, 1), depth + 1);
+
+				auto branch = ast->child(statement, 2);
+				while(branch != noNode && (*ast)[branch].kind == NodeKind::If)
+				{
+					_indent(depth);
+					out->write("elseif ");
+					_writeExpression(ast->child(branch, 0));
+					out->write(" then\n");
+					_writeStatements(ast->child(branch, 1), depth + 1);
+					branch = ast->child(branch, 2);
+				}
+
+				if(branch != noNode)
+				{
+					_indent(depth);
+					out->write("else\n");
+					_writeStatements(branch, depth + 1);
+				}
+
+				_indent(depth);
+				out->write("endif\n");
+				break;
+			}
+			case NodeKind::Loop:
+				_indent(depth);
+				out->write("loop\n");
+				_writeStatements(ast->child(statement, 0), depth + 1);
+				_indent(depth);
+				out->write("endloop\n");
+				break;
+			case NodeKind::Exitwhen:
+				_indent(depth);
+				out->write("exitwhen ");
+				_writeExpression(ast->child(statement, 0));
+				out->put('\n');
+				break;
+			case NodeKind::Return:
+				//create returns the instance, destroy frees it on every way out
+				if(currentStruct && currentMethod == currentStruct->destructor)
+					_writeDeallocation(*currentStruct, depth);
+
+				_indent(depth);
+				out->write("return");
+				if(currentStruct && currentMethod == currentStruct->constructor)
+					out->write(" this");
+				else if(ast->child(statement, 0) != noNode)
+				{
+					out->put(' ');
+					_writeExpression(ast->child(statement, 0));
+				}
+
+				out->put('\n');
+				break;
+			case NodeKind::While:
+				_indent(depth);
+				out->write("loop\n");
+				_writeLoopCondition(ast->child(statement, 0), depth + 1);
+				_writeStatements(ast->child(statement, 1), depth + 1);
+				_indent(depth);
+				out->write("endloop\n");
+				break;
+			case NodeKind::For:
+			{
+				if(ast->child(statement, 0) != noNode)
+					_writeStatement(ast->child(statement, 0), depth);
+
+				_indent(depth);
+				out->write("loop\n");
+				if(ast->child(statement, 1) != noNode)
+					_writeLoopCondition(ast->child(statement, 1), depth + 1);
+
+				_writeStatements(ast->child(statement, 3), depth + 1);
+				if(ast->child(statement, 2) != noNode)
+					_writeStatement(ast->child(statement, 2), depth + 1);
+
+				_indent(depth);
+				out->write("endloop\n");
+				break;
+			}
+			case NodeKind::Break:
+				_indent(depth);
+				out->write("exitwhen true\n");
+				break;
+			case NodeKind::RunTextmacro:
+				_unsupported(statement, "runtextmacro");
+				break;
+			default:
+				_unsupported(statement, "statement");
+				break;
+		}
+	}
+
+	void JassGenerator::_writeSet(NodeIndex statement, size_t depth)
+	{
+		_indent(depth);
+		if(!names || !_writeSetter(statement))
+		{
+			out->write("set ");
+			_writeExpression(ast->child(statement, 0));
+			out->write(assignment);
+			_writeAssigned(statement);
+		}
+
+		out->put('\n');
+	}
+
+	bool JassGenerator::_writeSetter(NodeIndex statement)
+	{
+		auto target = ast->child(statement, 0);
+		MemberAccess access;
+		NodeIndex setter = noNode;
+		NodeIndex position = noNode;
+
+		if((*ast)[target].kind == NodeKind::Member)
+		{
+			//members that are variables have no setter
+			if(!layout.resolveMember(target, currentStruct, access) || access.setter == noNode)
+				return false;
+
+			setter = access.setter;
+		}
+		else if((*ast)[target].kind == NodeKind::Name)
+		{
+			if(!_bareOperator(target, currentStruct, access))
+				return false;
+
+			setter = access.setter;
+			if(setter == noNode)
+			{
+				_error(target, std::string(ast->text(currentStruct->node)) + " has no operator " +
+						std::string(ast->text(target)) + "=");
+				return true;
+			}
+
+			if(!((*ast)[setter].flags & NodeFlag::Static) && currentMethod != noNode &&
+			   (*ast)[currentMethod].flags & NodeFlag::Static)
+			{
+				_error(target, std::string(ast->text(target)) + " is not static");
+				return true;
+			}
+		}
+		else if((*ast)[target].kind == NodeKind::Index)
+		{
+			access.owner = _indexedStruct(target, access.throughType);
+			if(!access.owner)
+				return false;
+
+			setter = layout.findOperator(*access.owner, "[", true);
+			if(setter == noNode)
+			{
+				_error(target, std::string(ast->text(access.owner->node)) + " has no operator []=");
+				return true;
+			}
+
+			if(!access.throughType)
+				access.object = ast->child(target, 0);
+
+			position = ast->child(target, 1);
+		}
+		else
+			return false;
+
+		out->write("call ");
+		_writeMethodName(*access.owner, setter);
+		out->put('(');
+		if(!((*ast)[setter].flags & NodeFlag::Static))
+		{
+			_writeObject(access);
+			out->write(separator);
+		}
+
+		if(position != noNode)
+		{
+			_writeExpression(position);
+			out->write(separator);
+		}
+
+		_writeAssigned(statement);
+		out->put(')');
+		return true;
+	}
+
+	void JassGenerator::_writeAssigned(NodeIndex statement)
+	{
+		auto target = ast->child(statement, 0);
+		auto value = ast->child(statement, 1);
+		auto type = ast->token(statement).type;
+
+		if(type == Token::Type::Operator_assign)
+			_writeExpression(value);
+		else if(type == Token::Type::Operator_eqmodulo)
+		{
+			out->write("ModuloInteger(");
+			_writeExpression(target);
+			out->write(separator);
+			_writeExpression(value);
+			out->put(')');
+		}
+		else if(const char* spelled = compoundOperator(type))
+		{
+			_writeExpression(target);
+			if(!minifier)
+				out->put(' ');
+
+			out->write(spelled);
+			if(!minifier)
+				out->put(' ');
+
+			if(value == noNode)
+				out->put('1');
+			else if(isAtom((*ast)[value].kind))
+				_writeExpression(value);
+			else
+			{
+				out->put('(');
+				_writeExpression(value);
+				out->put(')');
+			}
+		}
+		else
+			_unsupported(statement, "shift assignment");
+	}
+
+	void JassGenerator::_writeLoopCondition(NodeIndex condition, size_t depth)
+	{
+		_indent(depth);
+		out->write("exitwhen not ");
+
+		if(isAtom((*ast)[condition].kind))
+			_writeExpression(condition);
+		else
+		{
+			out->put('(');
+			_writeExpression(condition);
+			out->put(')');
+		}
+
+		out->put('\n');
+	}
+
+	void JassGenerator::_writeExpression(NodeIndex expression)
+	{
+		if(optimizer && optimizer->isFolded(expression))
+		{
+			out->write(optimizer->foldedText(expression));
+			return;
+		}
+
+		const auto& node = (*ast)[expression];
+		switch(node.kind)
+		{
+			case NodeKind::Binary:
+			{
+				auto type = ast->token(expression).type;
+				if(type == Token::Type::Operator_modulo)
+				{
+					out->write("ModuloInteger(");
+					_writeExpression(ast->child(expression, 0));
+					out->write(separator);
+					_writeExpression(ast->child(expression, 1));
+					out->put(')');
+					break;
+				}
+
+				if(type == Token::Type::Operator_lshift || type == Token::Type::Operator_rshift)
+					_unsupported(expression, "shift");
+
+				//and, or need the spaces, the symbols do not
+				bool spaced = !minifier || type == Token::Type::Keyword_and || type == Token::Type::Keyword_or;
+
+				_writeExpression(ast->child(expression, 0));
+				if(spaced)
+					out->put(' ');
+
+				out->write(tokenTypeName(type));
+				if(spaced)
+					out->put(' ');
+
+				_writeExpression(ast->child(expression, 1));
+				break;
+			}
+			case NodeKind::Unary:
+				if(ast->token(expression).type == Token::Type::Keyword_not)
+					out->write("not ");
+				else if(ast->token(expression).type == Token::Type::Operator_minus)
+					out->put('-');
+
+				_writeExpression(ast->child(expression, 0));
+				break;
+			case NodeKind::Literal:
+				//strings and rawcodes are stored without their quotes
+				switch(ast->token(expression).type)
+				{
+					case Token::Type::Operator_string:
+						out->put('"');
+						_writeText(expression);
+						out->put('"');
+						break;
+					case Token::Type::Operator_rawcode:
+						out->put('\'');
+						_writeText(expression);
+						out->put('\'');
+						break;
+					default:
+						_writeText(expression);
+						break;
+				}
+
+				break;
+			case NodeKind::Name:
+			{
+				if(ast->token(expression).type == Token::Type::Literal_super ||
+				   ast->token(expression).type == Token::Type::Keyword_thistype)
+					_unsupported(expression, ast->text(expression) == "super" ? "super" : "thistype");
+
+				if(inlining && _writeArgument(expression))
+					break;
+
+				//method operator used by its name inside method is member of this too
+				MemberAccess access;
+				if(_bareOperator(expression, currentStruct, access))
+				{
+					std::string name(ast->text(expression));
+					if(access.declaration == noNode)
+						_error(expression, std::string(ast->text(currentStruct->node)) + " has no operator " + name);
+					else if(!((*ast)[access.declaration].flags & NodeFlag::Static) && currentMethod != noNode &&
+							(*ast)[currentMethod].flags & NodeFlag::Static)
+						_error(expression, name + " is not static");
+					else
+						_writeGetter(access);
+
+					break;
+				}
+
+				_writeText(expression);
+
+				//member used by its name inside method is member of this
+				auto symbol = names ? names->symbolOf(expression) : noSymbol;
+				if(symbol != noSymbol && names->getTable()[symbol].kind == SymbolKind::Member &&
+				   !(names->getTable()[symbol].flags & NodeFlag::Static))
+					out->write("[this]");
+
+				break;
+			}
+			case NodeKind::Call:
+			{
+				if(optimizer && optimizer->isInlined(expression))
+				{
+					_writeInlined(expression, false);
+					break;
+				}
+
+				if(names && _writeStructCall(expression))
+					break;
+
+				auto children = ast->children(expression);
+				_writeExpression(children[0]);
+				out->put('(');
+				for(size_t i = 1; i < children.size(); ++i)
+				{
+					if(i > 1)
+						out->write(separator);
+
+					_writeExpression(children[i]);
+				}
+
+				out->put(')');
+				break;
+			}
+			case NodeKind::Index:
+				if(names && _writeStructIndex(expression))
+					break;
+
+				_writeExpression(ast->child(expression, 0));
+				out->put('[');
+				_writeExpression(ast->child(expression, 1));
+				out->put(']');
+				break;
+			case NodeKind::FunctionRef:
+			{
+				out->write("function ");
+
+				auto target = ast->child(expression, 0);
+				MemberAccess access;
+				if((*ast)[target].kind != NodeKind::Member)
+					_writeExpression(target);
+				else if(!names || !layout.resolveMember(target, currentStruct, access) || !_writeCalledName(target, access))
+					_unsupported(target, "reference to something else than method");
+
+				break;
+			}
+			case NodeKind::Paren:
+				out->put('(');
+				_writeExpression(ast->child(expression, 0));
+				out->put(')');
+				break;
+			case NodeKind::Member:
+				_writeMember(expression);
+				break;
+			default:
+				_unsupported(expression, "expression");
+				break;
+		}
+	}
+
+	void JassGenerator::_writeOperand(NodeIndex expression)
+	{
+		//folded value is literal, only negative number could be taken for operator
+		bool literal = optimizer && optimizer->isFolded(expression) && optimizer->foldedText(expression)[0] != '-';
+		if(literal || isAtom((*ast)[expression].kind))
+			_writeExpression(expression);
+		else
+		{
+			out->put('(');
+			_writeExpression(expression);
+			out->put(')');
+		}
+	}
+
+	void JassGenerator::_writeInlined(NodeIndex call, bool statement, size_t depth)
+	{
+		auto function = names->getTable()[names->symbolOf(ast->child(call, 0))].node;
+		auto body = ast->child(ast->child(function, 2), 0);
+
+		InlineFrame frame{ call, function, inlining };
+		inlining = &frame;
+
+		//return in statement is return of call, see Optimizer
+		if(!statement)
+			_writeOperand(ast->child(body, 0));
+		else if((*ast)[body].kind != NodeKind::Return)
+			_writeStatement(body, depth);
+		else
+		{
+			_indent(depth);
+			out->write("call ");
+			_writeExpression(ast->child(body, 0));
+			out->put('\n');
+		}
+
+		inlining = frame.outer;
+	}
+
+	bool JassGenerator::_writeArgument(NodeIndex name)
+	{
+		auto symbol = names->symbolOf(name);
+		if(symbol == noSymbol || names->getTable()[symbol].kind != SymbolKind::Parameter)
+			return false;
+
+		auto parameters = ast->children(ast->child(inlining->function, 0));
+		for(size_t i = 0; i < parameters.size(); ++i)
+		{
+			if(parameters[i] != names->getTable()[symbol].node)
+				continue;
+
+			//the argument belongs to the caller, which may be inlined itself
+			const auto* frame = inlining;
+			inlining = frame->outer;
+			_writeOperand(ast->child(frame->call, i + 1));
+			inlining = frame;
+			return true;
+		}
+
+		return false;
+	}
+
+	void JassGenerator::_writeObject(const MemberAccess& access)
+	{
+		if(access.object == noNode)
+			out->write("this");
+		else
+			_writeExpression(access.object);
+	}
+
+	void JassGenerator::_writeArguments(NodeIndex call, bool comma)
+	{
+		auto children = ast->children(call);
+		for(size_t i = 1; i < children.size(); ++i)
+		{
+			if(comma || i > 1)
+				out->write(separator);
+
+			_writeExpression(children[i]);
+		}
+	}
+
+	void JassGenerator::_writeMember(NodeIndex member)
+	{
+		MemberAccess access;
+		if(!names || !layout.resolveMember(member, currentStruct, access))
+		{
+			_unsupported(member, "member of something else than struct");
+			_writeText(member);
+			return;
+		}
+
+		std::string name(ast->text(member));
+		auto declaration = access.declaration;
+		if(declaration == noNode)
+		{
+			_error(member, std::string(ast->text(access.owner->node)) + " has no member " + name);
+			return;
+		}
+
+		const auto& node = (*ast)[declaration];
+		bool isStatic = node.flags & NodeFlag::Static;
+		if(!isStatic && access.throughType)
+			_error(member, name + " is not static");
+
+		if(node.kind == NodeKind::Variable)
+		{
+			_writeText(declaration);
+			if(!isStatic)
+			{
+				out->put('[');
+				_writeObject(access);
+				out->put(']');
+			}
+		}
+		else if(node.flags & NodeFlag::Operator)
+			_writeGetter(access);
+		else
+			_error(member, "method " + name + " has to be called");
+	}
+
+	void JassGenerator::_writeGetter(const MemberAccess& access)
+	{
+		_writeMethodName(*access.owner, access.declaration);
+		out->put('(');
+		if(!((*ast)[access.declaration].flags & NodeFlag::Static))
+			_writeObject(access);
+
+		out->put(')');
+	}
+
+	bool JassGenerator::_bareOperator(NodeIndex name, const StructInfo* owner, MemberAccess& access) const
+	{
+		access = MemberAccess{};
+		if(!names || !owner || names->symbolOf(name) != noSymbol)
+			return false;
+
+		auto text = ast->text(name);
+		access.owner = owner;
+		access.declaration = layout.findOperator(*owner, text, false);
+		access.setter = layout.findOperator(*owner, text, true);
+		return access.declaration != noNode || access.setter != noNode;
+	}
+
+	bool JassGenerator::_writeStructCall(NodeIndex call)
+	{
+		const auto& table = names->getTable();
+		auto callee = ast->child(call, 0);
+
+		MemberAccess access;
+		if((*ast)[callee].kind == NodeKind::Name)
+		{
+			//typecast, A(i) is just i
+			if(layout.typeOf(callee))
+			{
+				if(ast->children(call).size() != 2)
+					_error(call, "typecast takes single value");
+				else
+					_writeOperand(ast->child(call, 1));
+
+				return true;
+			}
+
+			//method called by its name inside the struct
+			auto symbol = names->symbolOf(callee);
+			if(symbol == noSymbol || table[symbol].kind != SymbolKind::Method)
+				return false;
+
+			access.owner = layout.find(table.getScope(table[symbol].scope).owner);
+			access.declaration = table[symbol].node;
+		}
+		else if((*ast)[callee].kind != NodeKind::Member || !layout.resolveMember(callee, currentStruct, access))
+			return false;
+
+		auto name = ast->text(callee);
+		bool isStatic = access.declaration == noNode ? name == "create" || name == "allocate" :
+						bool((*ast)[access.declaration].flags & NodeFlag::Static);
+
+		if(!_writeCalledName(callee, access))
+		{
+			_error(callee, std::string(ast->text(access.owner->node)) + " has no method " + std::string(name));
+			return true;
+		}
+
+		out->put('(');
+		if(!isStatic)
+		{
+			if(access.throughType)
+				_error(callee, std::string(name) + " is not static");
+
+			_writeObject(access);
+		}
+
+		_writeArguments(call, !isStatic);
+		out->put(')');
+		return true;
+	}
+
+	const StructInfo* JassGenerator::_indexedStruct(NodeIndex index, bool& throughType)
+	{
+		auto array = ast->child(index, 0);
+		throughType = false;
+
+		if(const auto* type = layout.typeOf(array))
+		{
+			throughType = true;
+			return type;
+		}
+
+		//arrays of structs are indexed as they are
+		NodeIndex declaration = noNode;
+		MemberAccess access;
+		if((*ast)[array].kind == NodeKind::Name && names->symbolOf(array) != noSymbol)
+			declaration = names->getTable()[names->symbolOf(array)].node;
+		else if((*ast)[array].kind == NodeKind::Member && layout.resolveMember(array, currentStruct, access))
+			declaration = access.declaration;
+
+		if(declaration != noNode && ((*ast)[declaration].flags & NodeFlag::Array))
+			return nullptr;
+
+		return layout.structOf(array, currentStruct);
+	}
+
+	bool JassGenerator::_writeStructIndex(NodeIndex index)
+	{
+		const auto& table = names->getTable();
+		auto array = ast->child(index, 0);
+		auto position = ast->child(index, 1);
+
+		//array member of struct
+		MemberAccess access;
+		NodeIndex declaration = noNode;
+		if((*ast)[array].kind == NodeKind::Name)
+		{
+			auto symbol = names->symbolOf(array);
+			if(symbol != noSymbol && table[symbol].kind == SymbolKind::Member)
+				declaration = table[symbol].node;
+		}
+		else if((*ast)[array].kind == NodeKind::Member && layout.resolveMember(array, currentStruct, access))
+			declaration = access.declaration;
+
+		if(declaration != noNode && (*ast)[declaration].kind == NodeKind::Variable &&
+		   ((*ast)[declaration].flags & NodeFlag::Array))
+		{
+			_writeText(declaration);
+			out->put('[');
+
+			//instances share one array, each has size entries of it
+			if(!((*ast)[declaration].flags & NodeFlag::Static))
+			{
+				auto size = ast->child(declaration, 2);
+				if(size == noNode)
+					_error(declaration, "array member " + std::string(ast->text(declaration)) + " has to have size");
+				else if(access.throughType)
+					_error(array, std::string(ast->text(declaration)) + " is not static");
+				else
+				{
+					if(access.object == noNode)
+						out->write("this");
+					else
+						_writeOperand(access.object);
+
+					out->write(" * ");
+					_writeOperand(size);
+					out->write(" + ");
+				}
+			}
+
+			_writeExpression(position);
+			out->put(']');
+			return true;
+		}
+
+		//operator [] of the struct
+		bool throughType;
+		const auto* owner = _indexedStruct(index, throughType);
+		if(!owner)
+			return false;
+
+		auto getter = layout.findOperator(*owner, "[", false);
+		if(getter == noNode)
+		{
+			_error(index, std::string(ast->text(owner->node)) + " has no operator []");
+			return true;
+		}
+
+		bool isStatic = (*ast)[getter].flags & NodeFlag::Static;
+		if(!isStatic && throughType)
+			_error(index, "operator [] of " + std::string(ast->text(owner->node)) + " is not static");
+
+		_writeMethodName(*owner, getter);
+		out->put('(');
+		if(!isStatic)
+		{
+			_writeExpression(array);
+			out->write(separator);
+		}
+
+		_writeExpression(position);
+		out->put(')');
+		return true;
+	}
+
+	bool JassGenerator::generate(const Ast& tree, OutputBuffer& output, std::string_view name)
+	{
+		ast = &tree;
+		out = &output;
+		fileName = name;
+		errorCount = 0;
+		copiedCount = 0;
+
+		types.clear();
+		globals.clear();
+		natives.clear();
+		functions.clear();
+		libraryInitializers.clear();
+		scopeInitializers.clear();
+		currentStruct = nullptr;
+		currentMethod = noNode;
+		inlining = nullptr;
+
+		if(names)
+			layout.reset(tree, *names);
+
+		if(tree.getRoot() == noNode)
+			return true;
+
+		_collectLibraries(tree.getRoot());
+		_collect(tree.getRoot());
+
+		for(auto type : types)
+		{
+			out->write("type ");
+			_writeText(type);
+			out->write(" extends ");
+			_writeText(ast->child(type, 0));
+			out->put('\n');
+		}
+
+		if(globals.size())
+		{
+			out->write("globals\n");
+			for(auto variable : globals)
+			{
+				if((*ast)[variable].kind == NodeKind::Struct)
+				{
+					_writeStructGlobals(*layout.find(names->symbolOf(variable)));
+					continue;
+				}
+
+				if(optimizer && optimizer->isRemoved(variable))
+					continue;
+
+				_indent(1);
+				_writeVariable(variable, true);
+				out->put('\n');
+			}
+
+			out->write("endglobals\n");
+		}
+
+		for(auto native : natives)
+		{
+			if((*ast)[native].flags & NodeFlag::Constant)
+				out->write("constant ");
+
+			out->write("native ");
+			_writeText(native);
+			_writeSignature(ast->child(native, 0), ast->child(native, 1));
+			out->put('\n');
+		}
+
+		//methods follow the struct they belong to
+		for(auto function : functions)
+		{
+			switch((*ast)[function].kind)
+			{
+				case NodeKind::Struct:
+					currentStruct = layout.find(names->symbolOf(function));
+					_writeAllocator(*currentStruct);
+					break;
+				case NodeKind::Method:
+					_writeMethod(function);
+					break;
+				default:
+					currentStruct = nullptr;
+					if(!optimizer || !optimizer->isRemoved(function))
+						_writeFunction(function);
+
+					break;
+			}
+		}
+
+		currentStruct = nullptr;
+
+		return errorCount == 0;
+	}
+
+	size_t JassGenerator::getErrorCount() const
+	{
+		return errorCount;
+	}
+
+	size_t JassGenerator::getCopiedCount() const
+	{
+		return copiedCount;
+	}
+}
@@ -0,0 +1,270 @@
+#ifndef _JH_HEADER_JASSGENERATOR_
+#define _JH_HEADER_JASSGENERATOR_
+
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Core/OutputBuffer.hpp"
+#include "../Optimizer/Minifier.hpp"
+#include "../Optimizer/Optimizer.hpp"
+#include "../Parser/Ast.hpp"
+#include "../Preprocessor/TextmacroExpander.hpp"
+#include "../Semantic/NameResolver.hpp"
+#include "StructLayout.hpp"
+
+namespace jh{
+	/*
+		Writes Ast as plain Jass
+
+		Libraries and scopes are flattened, every globals block is merged into one at
+		the top, types and natives are written before it and functions after it.
+		Libraries come first, each after the libraries it requires, as vJass places
+		them, the rest keeps the order of the tree. Initializers of libraries and scopes
+		are started from main, in the same order.
+
+		Structs are lowered into parallel global arrays, s__A_x[this] for member x of A,
+		and methods into functions taking the instance first, see StructLayout. Every
+		struct gets allocate and deallocate by the allocator chosen(setAllocator), unless
+		it extends array or has allocator block of its own. create and destroy are only
+		written for structs with constructor or destructor, the allocation is then inlined
+		into them, otherwise A.create() is just call of the allocate function.
+
+		Most functions of a map are already plain Jass, those are not rebuilt from the
+		tree, but copied from the source as one slice, from function to endfunction.
+		Only functions using something Jass does not have(while, for, +=, locals in the
+		middle of the body, names that are mangled, ...) are written node by node.
+
+		With optimizer set, folded expressions are written as their value, inlined
+		calls as the body of the function, with arguments in place of the parameters,
+		and removed functions and globals are left out. Functions changed by that are
+		written node by node as well.
+
+		With minifier set, names are written as the minifier renamed them, every
+		function is written node by node, without indentation and with no spaces
+		that Jass does not need.
+	*/
+	class JassGenerator{
+		const Ast* ast = nullptr;
+		OutputBuffer* out = nullptr;
+
+		std::string fileName;
+		bool debugMode = false;
+
+		//token ranges that came from textmacros, their text is not in the source
+		const std::vector<TokenRange>* splices = nullptr;
+
+		//names of private and public members are written mangled when set
+		const NameResolver* names = nullptr;
+		size_t errorCount = 0;
+
+		StructLayout layout;
+		AllocatorKind allocator = AllocatorKind::Bump;
+
+		//struct whose method is being written, and the method, nullptr and noNode in
+		//functions
+		const StructInfo* currentStruct = nullptr;
+		NodeIndex currentMethod = noNode;
+		size_t copiedCount = 0;
+
+		const Optimizer* optimizer = nullptr;
+
+		//calls being inlined, innermost first, parameters of function are written as
+		//arguments of call
+		struct InlineFrame{
+			NodeIndex call;
+			NodeIndex function;
+			const InlineFrame* outer;
+		};
+
+		const InlineFrame* inlining = nullptr;
+
+		const Minifier* minifier = nullptr;
+
+		//between arguments and parameters, and of set and initial values
+		std::string_view separator = ", ";
+		std::string_view assignment = " = ";
+
+		//counters of the allocators
+		std::string_view increment = " + 1";
+		std::string_view decrement = " - 1";
+		std::string_view isZero = " == 0 then";
+
+		//names of the allocator of struct being written without minifier, one per part,
+		//so that single line can hold all of them
+		std::string structNames[structNameCount];
+
+		//declarations of the whole tree in output order, see _collect
+		std::vector<NodeIndex> types;
+		std::vector<NodeIndex> globals;
+		std::vector<NodeIndex> natives;
+		std::vector<NodeIndex> functions;
+
+		//Name nodes of initializers, libraries first
+		std::vector<NodeIndex> libraryInitializers;
+		std::vector<NodeIndex> scopeInitializers;
+
+		//libraries of the file, in the order they are written
+		std::vector<NodeIndex> libraries;
+
+		//sorts declarations of given block into the lists above, apart from libraries
+		void _collect(NodeIndex block);
+
+		//collects libraries of the file before the rest of it, each after the libraries
+		//it requires
+		void _collectLibraries(NodeIndex file);
+		void _collectStruct(NodeIndex declaration);
+
+		//collects methods of struct, each after the methods of the struct it uses,
+		//reports methods that use each other
+		void _collectMethods(const StructInfo& info);
+
+		void _error(NodeIndex node, const std::string& message);
+
+		//reports construct that has no Jass counterpart
+		void _unsupported(NodeIndex node, const char* what);
+
+		//returns source text of the function, from function to endfunction, if it can
+		//be copied as is, empty otherwise
+		std::string_view _plainJass(NodeIndex function) const;
+
+		void _indent(size_t depth);
+		void _writeText(NodeIndex node);
+
+		//structs are written as integer
+		void _writeType(NodeIndex typeRef);
+		void _writeVariable(NodeIndex variable, bool withValue);
+
+		//writes takes part of signature, methods take this before the parameters
+		void _writeParameters(NodeIndex parameters, bool takesThis);
+		void _writeSignature(NodeIndex parameters, NodeIndex returns, bool takesThis = false);
+
+		//writes line of generated code made of given parts
+		void _writeLine(size_t depth, std::initializer_list<std::string_view> parts);
+
+		//declares locals of function body, the leading ones with their values and the
+		//rest hoisted, returns number of the leading ones
+		size_t _writeLocals(NodeIndex block);
+
+		void _writeFunction(NodeIndex function);
+
+		//globals of members and of the allocator
+		void _writeStructGlobals(const StructInfo& info);
+
+		//allocate and deallocate of the built in allocators
+		void _writeAllocator(const StructInfo& info);
+
+		//returns name of global or function of the allocator, short one if minifying
+		std::string_view _structName(const StructInfo& info, StructName part);
+
+		//sets this to new instance and members to their initial values, or frees this
+		void _writeAllocation(const StructInfo& info, size_t depth);
+		void _writeDeallocation(const StructInfo& info, size_t depth);
+
+		void _writeMethod(NodeIndex method);
+
+		//writes name of function the method is written as
+		void _writeMethodName(const StructInfo& info, NodeIndex method);
+
+		//writes function called for member, of method the struct declares or of allocate,
+		//create, ... it does not, returns false if there is no such method
+		bool _writeCalledName(NodeIndex member, const MemberAccess& access);
+
+		//declares locals of the block, apart from the first skip statements, and of
+		//every block inside it without value, Jass has locals only at the top
+		void _hoistLocals(NodeIndex block, size_t skip);
+
+		void _writeStatements(NodeIndex block, size_t depth);
+		void _writeStatement(NodeIndex statement, size_t depth);
+
+		//set, with compound assignments spelled out
+		void _writeSet(NodeIndex statement, size_t depth);
+
+		//value assigned by set, target op value for compound assignments
+		void _writeAssigned(NodeIndex statement);
+
+		//writes set of member backed by method operator as call of the setter
+		//returns false if the target is not such member
+		bool _writeSetter(NodeIndex statement);
+
+		//exitwhen not condition
+		void _writeLoopCondition(NodeIndex condition, size_t depth);
+
+		void _writeExpression(NodeIndex expression);
+
+		//writes expression in parentheses if it is not atom
+		void _writeOperand(NodeIndex expression);
+
+		//writes call the optimizer inlined, as expression, or as statement at given depth
+		void _writeInlined(NodeIndex call, bool statement, size_t depth = 0);
+
+		//writes argument passed to parameter of function being inlined, returns false if
+		//the name is not such parameter
+		bool _writeArgument(NodeIndex name);
+
+		//writes instance of member access, this if there is no object
+		void _writeObject(const MemberAccess& access);
+
+		//writes arguments of call from the first one, after given prefix
+		void _writeArguments(NodeIndex call, bool comma);
+
+		//member of struct as value, array or static global, or call of getter
+		void _writeMember(NodeIndex member);
+
+		//writes call of the getter of method operator access refers to
+		void _writeGetter(const MemberAccess& access);
+
+		//binds name the resolver left unbound to method operator of owner, len inside
+		//method of Vec is this.len, returns false if owner has no such operator
+		bool _bareOperator(NodeIndex name, const StructInfo* owner, MemberAccess& access) const;
+
+		//writes call or index using struct, returns false if it does not use any
+		bool _writeStructCall(NodeIndex call);
+		bool _writeStructIndex(NodeIndex index);
+
+		//returns struct whose operator [] index goes through, nullptr if it indexes
+		//array, throughType is set for static operator of type
+		const StructInfo* _indexedStruct(NodeIndex index, bool& throughType);
+	public:
+		JassGenerator() = default;
+
+		JassGenerator(const JassGenerator&) = delete;
+		JassGenerator& operator=(const JassGenerator&) = delete;
+
+		//keeps debug statements, they are left out otherwise
+		void setDebug(bool enabled);
+
+		//sets ranges of tokens spliced in by TextmacroExpander, functions with them are
+		//not copied from the source, nullptr if nothing was expanded
+		void setSplices(const std::vector<TokenRange>* ranges);
+
+		//sets names resolved for the tree, declarations and uses of private and public
+		//members are then written by their mangled names, nullptr writes every name as is
+		void setNames(const NameResolver* resolver);
+
+		//sets allocator of structs that have none of their own, Bump by default
+		void setAllocator(AllocatorKind kind);
+
+		//sets optimizer run on the tree and the same names, nullptr writes the tree as
+		//it is
+		void setOptimizer(const Optimizer* tree);
+
+		//sets names the minifier gave to symbols of the tree, nullptr writes the output
+		//names, the minifier has to be run on the names given to setNames
+		void setMinifier(const Minifier* shortNames);
+
+		//writes tree into output, fileName is only used in error messages
+		//returns false if the tree uses something that can not be written as Jass,
+		//the output is complete apart from those parts
+		bool generate(const Ast& tree, OutputBuffer& output, std::string_view name = "");
+
+		//returns number of errors reported by the last generate
+		size_t getErrorCount() const;
+
+		//returns number of functions the last generate copied from the source
+		size_t getCopiedCount() const;
+	};
+}
+
+#endif	//_JH_HEADER_JASSGENERATOR_
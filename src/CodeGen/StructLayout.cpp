@@ -0,0 +1,257 @@
+#include "StructLayout.hpp"
+
+namespace jh{
+	namespace{
+		constexpr std::uint32_t noStruct = 0xFFFFFFFF;
+	}
+
+	void StructLayout::reset(const Ast& tree, const NameResolver& resolver)
+	{
+		//only the entries of the previous structs are set
+		for(const auto& info : structs)
+			structIndex[info.symbol] = noStruct;
+
+		ast = &tree;
+		names = &resolver;
+		structs.clear();
+	}
+
+	void StructLayout::_addBlock(StructInfo& info, NodeIndex block)
+	{
+		for(auto declaration : ast->children(block))
+		{
+			if(declaration == noNode)
+				continue;
+
+			const auto& node = (*ast)[declaration];
+			switch(node.kind)
+			{
+				case NodeKind::Variable:
+					(node.flags & NodeFlag::Static ? info.statics : info.members).push_back(declaration);
+					break;
+				case NodeKind::Method:
+				{
+					info.methods.push_back(declaration);
+
+					auto name = ast->text(declaration);
+					bool isStatic = node.flags & NodeFlag::Static;
+					if(node.flags & NodeFlag::Constructor)
+						info.constructor = declaration;
+					else if(node.flags & NodeFlag::Destructor)
+						info.destructor = declaration;
+					else if(node.flags & NodeFlag::Operator)
+						break;
+					else if(name == "create" && isStatic)
+						info.create = declaration;
+					else if(name == "destroy" && !isStatic)
+						info.destroy = declaration;
+					else if(name == "onDestroy" && !isStatic && info.destructor == noNode)
+						info.destructor = declaration;
+
+					break;
+				}
+				case NodeKind::Allocator:
+					info.allocatorBlock = declaration;
+					_addBlock(info, ast->child(declaration, 0));
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	const StructInfo& StructLayout::add(NodeIndex node, AllocatorKind allocator)
+	{
+		const auto& table = names->getTable();
+
+		StructInfo info;
+		info.node = node;
+		info.symbol = names->symbolOf(node);
+		info.prefix = table.name(table.getScope(table[info.symbol].body).publicPrefix);
+		_addBlock(info, ast->child(node, 1));
+
+		auto parent = ast->child(node, 0);
+		if(parent != noNode && ast->token(parent).type == Token::Type::Keyword_array)
+			info.allocator = AllocatorKind::None;
+		else if(info.allocatorBlock != noNode)
+			info.allocator = AllocatorKind::User;
+		else
+			info.allocator = allocator;
+
+		if(structIndex.size() < table.size())
+			structIndex.resize(table.size(), noStruct);
+
+		structIndex[info.symbol] = static_cast<std::uint32_t>(structs.size());
+		structs.push_back(std::move(info));
+		return structs.back();
+	}
+
+	const StructInfo* StructLayout::find(SymbolIndex symbol) const
+	{
+		if(symbol >= structIndex.size() || structIndex[symbol] == noStruct)
+			return nullptr;
+
+		return &structs[structIndex[symbol]];
+	}
+
+	const StructInfo* StructLayout::_typeOfDeclaration(NodeIndex declaration) const
+	{
+		if(declaration == noNode)
+			return nullptr;
+
+		switch((*ast)[declaration].kind)
+		{
+			case NodeKind::Variable:
+			case NodeKind::Local:
+			case NodeKind::Parameter:
+				return find(names->symbolOf(ast->child(declaration, 0)));
+			case NodeKind::Function:
+			case NodeKind::Native:
+			case NodeKind::Method:
+			{
+				auto returns = ast->child(declaration, 1);
+				return returns == noNode ? nullptr : find(names->symbolOf(returns));
+			}
+			default:
+				return nullptr;
+		}
+	}
+
+	const StructInfo* StructLayout::typeOf(NodeIndex expression) const
+	{
+		if((*ast)[expression].kind != NodeKind::Name || ast->token(expression).type == Token::Type::Literal_this)
+			return nullptr;
+
+		auto symbol = names->symbolOf(expression);
+		if(symbol == noSymbol || names->getTable()[symbol].kind != SymbolKind::Struct)
+			return nullptr;
+
+		return find(symbol);
+	}
+
+	const StructInfo* StructLayout::structOf(NodeIndex expression, const StructInfo* current) const
+	{
+		const auto& table = names->getTable();
+		switch((*ast)[expression].kind)
+		{
+			case NodeKind::Paren:
+				return structOf(ast->child(expression, 0), current);
+			case NodeKind::Name:
+			{
+				if(ast->token(expression).type == Token::Type::Literal_this)
+					return current;
+
+				auto symbol = names->symbolOf(expression);
+				return symbol == noSymbol ? nullptr : _typeOfDeclaration(table[symbol].node);
+			}
+			case NodeKind::Member:
+			{
+				MemberAccess access;
+				if(!resolveMember(expression, current, access))
+					return nullptr;
+
+				return _typeOfDeclaration(access.declaration);
+			}
+			case NodeKind::Call:
+			{
+				auto callee = ast->child(expression, 0);
+
+				//typecast, A(i) or thistype(i)
+				if(const auto* type = typeOf(callee))
+					return type;
+
+				if((*ast)[callee].kind == NodeKind::Name)
+				{
+					auto symbol = names->symbolOf(callee);
+					return symbol == noSymbol ? nullptr : _typeOfDeclaration(table[symbol].node);
+				}
+
+				MemberAccess access;
+				if((*ast)[callee].kind != NodeKind::Member || !resolveMember(callee, current, access))
+					return nullptr;
+
+				//allocate and create the struct does not declare return the struct
+				if(access.declaration == noNode)
+				{
+					auto name = ast->text(callee);
+					return name == "create" || name == "allocate" ? access.owner : nullptr;
+				}
+
+				return _typeOfDeclaration(access.declaration);
+			}
+			case NodeKind::Index:
+			{
+				auto array = ast->child(expression, 0);
+
+				//element of array of structs, or of array member
+				NodeIndex declaration = noNode;
+				if((*ast)[array].kind == NodeKind::Name && names->symbolOf(array) != noSymbol)
+					declaration = table[names->symbolOf(array)].node;
+				else if((*ast)[array].kind == NodeKind::Member)
+				{
+					MemberAccess access;
+					if(resolveMember(array, current, access))
+						declaration = access.declaration;
+				}
+
+				if(declaration != noNode && ((*ast)[declaration].flags & NodeFlag::Array))
+					return _typeOfDeclaration(declaration);
+
+				//operator [] of the struct, or static one of the type
+				const auto* owner = typeOf(array);
+				if(!owner)
+					owner = structOf(array, current);
+
+				return owner ? _typeOfDeclaration(findOperator(*owner, "[", false)) : nullptr;
+			}
+			default:
+				return nullptr;
+		}
+	}
+
+	bool StructLayout::resolveMember(NodeIndex member, const StructInfo* current, MemberAccess& access) const
+	{
+		access = MemberAccess{};
+
+		auto object = ast->child(member, 0);
+		if(object == noNode)
+			access.owner = current;
+		else if((access.owner = typeOf(object)))
+			access.throughType = true;
+		else
+		{
+			access.owner = structOf(object, current);
+			access.object = object;
+		}
+
+		if(!access.owner)
+			return false;
+
+		const auto& table = names->getTable();
+		auto text = ast->text(member);
+		auto name = names->nameOf(member);
+		auto symbol = name == Interner::invalidSymbol ? noSymbol : table.find(table[access.owner->symbol].body, name);
+
+		if(symbol != noSymbol)
+			access.declaration = table[symbol].node;
+		else
+		{
+			access.declaration = findOperator(*access.owner, text, false);
+			access.setter = findOperator(*access.owner, text, true);
+		}
+
+		return true;
+	}
+
+	NodeIndex StructLayout::findOperator(const StructInfo& owner, std::string_view name, bool setter) const
+	{
+		for(auto method : owner.methods)
+		{
+			auto flags = (*ast)[method].flags;
+			if((flags & NodeFlag::Operator) && bool(flags & NodeFlag::Setter) == setter && ast->text(method) == name)
+				return method;
+		}
+
+		return noNode;
+	}
+}
@@ -0,0 +1,122 @@
+#ifndef _JH_HEADER_STRUCTLAYOUT_
+#define _JH_HEADER_STRUCTLAYOUT_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "../Parser/Ast.hpp"
+#include "../Semantic/NameResolver.hpp"
+
+namespace jh{
+	//how instances of struct get their index
+	enum class AllocatorKind : std::uint8_t{
+		Bump,		//counts up, freed instances are kept on stack and taken first
+		FreeList,	//freed instances are linked through one array, as vJass does
+		User,		//allocator block of the struct
+		None,		//extends array, the code indexes instances itself
+	};
+
+	//struct written into Jass as globals, one array per instance member
+	struct StructInfo{
+		NodeIndex node;
+		SymbolIndex symbol;
+		AllocatorKind allocator;
+
+		//s__Name_, every global and function of the struct starts by it
+		std::string_view prefix;
+
+		//constructor, destructor(or method onDestroy), noNode if there is none
+		NodeIndex constructor = noNode;
+		NodeIndex destructor = noNode;
+
+		//static method create and method destroy declared by the struct itself
+		NodeIndex create = noNode;
+		NodeIndex destroy = noNode;
+
+		//allocator block, noNode if there is none
+		NodeIndex allocatorBlock = noNode;
+
+		//Variable nodes of instance and static members, methods of every kind, in
+		//declaration order
+		std::vector<NodeIndex> members;
+		std::vector<NodeIndex> statics;
+		std::vector<NodeIndex> methods;
+	};
+
+	//member expression bound to struct it belongs to
+	struct MemberAccess{
+		const StructInfo* owner = nullptr;
+
+		//Variable or Method node the name stands for, the getter for operators, noNode
+		//for allocate, create, ... that the struct does not declare itself
+		NodeIndex declaration = noNode;
+		NodeIndex setter = noNode;
+
+		//expression of the instance, noNode for this
+		NodeIndex object = noNode;
+
+		//Name.member or thistype.member, there is no instance
+		bool throughType = false;
+	};
+
+	/*
+		Structs of single tree, and types of the expressions using them
+
+		Jass has no structs, every instance member becomes global array indexed by the
+		instance, and every method function taking the instance as integer. To write
+		a.x as s__A_x[a], the generator has to know the struct of a, which is found
+		through the declaration the resolver bound the name to, its TypeRef, and the
+		struct that one refers to. Members are then looked up in the scope of the
+		struct, so no other tables are built.
+	*/
+	class StructLayout{
+		const Ast* ast = nullptr;
+		const NameResolver* names = nullptr;
+
+		std::vector<StructInfo> structs;
+
+		//index into structs for every struct symbol, sized only once a struct is added
+		std::vector<std::uint32_t> structIndex;
+
+		//returns struct the declaration node has as its type, nullptr if it has none
+		const StructInfo* _typeOfDeclaration(NodeIndex declaration) const;
+
+		//adds members and methods of block into info
+		void _addBlock(StructInfo& info, NodeIndex block);
+	public:
+		StructLayout() = default;
+
+		StructLayout(const StructLayout&) = delete;
+		StructLayout& operator=(const StructLayout&) = delete;
+
+		//removes every struct, and binds the layout to tree resolved by resolver
+		void reset(const Ast& tree, const NameResolver& resolver);
+
+		//adds struct declared by node, extends array always has no allocator, and
+		//allocator block overrides the given one
+		//references to the added structs are valid until the next add
+		const StructInfo& add(NodeIndex node, AllocatorKind allocator);
+
+		//returns struct declared as symbol, nullptr if it is not struct
+		const StructInfo* find(SymbolIndex symbol) const;
+
+		//returns struct the name of type refers to, Name of struct or thistype, nullptr
+		//if the expression is not type
+		const StructInfo* typeOf(NodeIndex expression) const;
+
+		//returns struct the value of expression is an instance of, this is instance
+		//of current, nullptr if the value is not struct
+		const StructInfo* structOf(NodeIndex expression, const StructInfo* current) const;
+
+		//binds member expression to its struct, .x belongs to current
+		//returns false if the struct of the object is not known
+		bool resolveMember(NodeIndex member, const StructInfo* current, MemberAccess& access) const;
+
+		//returns method operator of given name(text of the token after operator), noNode
+		//if the struct has none
+		NodeIndex findOperator(const StructInfo& owner, std::string_view name, bool setter) const;
+	};
+}
+
+#endif	//_JH_HEADER_STRUCTLAYOUT_
@@ -0,0 +1,83 @@
+#include "Arena.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace jh{
+	Arena::Arena(size_t defaultBlockSize) : blockSize(defaultBlockSize)
+	{
+	}
+
+	void Arena::_nextBlock(size_t size, size_t alignment)
+	{
+		//blocks kept from before reset are reused in order
+		size_t needed = size + alignment - 1;
+		size_t next = blocks.empty() ? 0 : current + 1;
+		for(; next < blocks.size(); ++next)
+		{
+			if(blocks[next].size >= needed)
+			{
+				current = next;
+				used = 0;
+				return;
+			}
+		}
+
+		size_t newSize = std::max(blockSize, needed);
+		blocks.push_back({ std::unique_ptr<char[]>(new char[newSize]), newSize });
+		current = blocks.size() - 1;
+		used = 0;
+	}
+
+	std::string_view Arena::copy(std::string_view text)
+	{
+		if(text.empty())
+			return std::string_view();
+
+		auto memory = static_cast<char*>(allocate(text.size(), 1));
+		std::memcpy(memory, text.data(), text.size());
+		return std::string_view(memory, text.size());
+	}
+
+	void Arena::reset()
+	{
+		current = 0;
+		used = 0;
+		allocated = 0;
+	}
+
+	void Arena::release()
+	{
+		blocks.clear();
+		blocks.shrink_to_fit();
+		reset();
+	}
+
+	void Arena::reserve(size_t size)
+	{
+		if(!blocks.empty() && blocks[current].size - used >= size)
+			return;
+
+		for(size_t i = blocks.empty() ? 0 : current + 1; i < blocks.size(); ++i)
+		{
+			if(blocks[i].size >= size)
+				return;
+		}
+
+		size_t newSize = std::max(blockSize, size);
+		blocks.push_back({ std::unique_ptr<char[]>(new char[newSize]), newSize });
+	}
+
+	size_t Arena::getUsed() const
+	{
+		return allocated;
+	}
+
+	size_t Arena::getReserved() const
+	{
+		size_t total = 0;
+		for(const auto& block : blocks)
+			total += block.size;
+
+		return total;
+	}
+}
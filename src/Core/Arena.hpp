@@ -0,0 +1,103 @@
+#ifndef _JH_HEADER_ARENA_
+#define _JH_HEADER_ARENA_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jh{
+	/*
+		Bump allocator for data that lives as long as one compilation
+
+		Memory is taken from big blocks by moving a pointer, and is never freed one by one.
+		reset() makes all of it available again while keeping the blocks, so a long lived
+		Arena reused for every file stops allocating once it has grown to the biggest file.
+
+		Only trivially destructible objects can be created in it, since no destructor
+		is ever called.
+	*/
+	class Arena{
+		struct Block{
+			std::unique_ptr<char[]> memory;
+			size_t size;
+		};
+
+		std::vector<Block> blocks;
+
+		//block allocations currently come from, and bytes used in it
+		size_t current = 0;
+		size_t used = 0;
+
+		size_t blockSize;
+
+		//bytes handed out since last reset
+		size_t allocated = 0;
+
+		//moves to block that can hold size bytes at given alignment, adding one if needed
+		void _nextBlock(size_t size, size_t alignment);
+	public:
+		explicit Arena(size_t defaultBlockSize = 64 * 1024);
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+		Arena(Arena&&) = default;
+		Arena& operator=(Arena&&) = default;
+
+		//returns uninitialized memory of given size and alignment
+		void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+		{
+			if(!blocks.empty())
+			{
+				size_t start = (used + alignment - 1) & ~(alignment - 1);
+				if(start + size <= blocks[current].size)
+				{
+					used = start + size;
+					allocated += size;
+					return blocks[current].memory.get() + start;
+				}
+			}
+
+			_nextBlock(size, alignment);
+			return allocate(size, alignment);
+		}
+
+		//returns uninitialized array of count objects
+		template<class T>
+		T* allocateArray(size_t count)
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "Arena never calls destructors");
+			return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		template<class T, class... Args>
+		T* create(Args&&... args)
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "Arena never calls destructors");
+			return new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+
+		//copies text into the arena, the result stays valid until reset
+		std::string_view copy(std::string_view text);
+
+		//makes all memory available again, keeping the blocks
+		void reset();
+
+		//frees all blocks
+		void release();
+
+		//makes sure at least size bytes can be allocated without adding a block
+		void reserve(size_t size);
+
+		//returns bytes handed out since last reset
+		size_t getUsed() const;
+
+		//returns bytes held in blocks
+		size_t getReserved() const;
+	};
+}
+
+#endif	//_JH_HEADER_ARENA_
@@ -0,0 +1,110 @@
+#include "Hash.hpp"
+#include <cstring>
+
+namespace jh{
+	namespace{
+		constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+		constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+		constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+		constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+		constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+		inline std::uint64_t rotateLeft(std::uint64_t value, int bits)
+		{
+			return (value << bits) | (value >> (64 - bits));
+		}
+
+		//reads little endian values regardless of alignment and byte order of the machine
+		inline std::uint64_t read64(const unsigned char* at)
+		{
+			std::uint64_t value = 0;
+			for(int i = 7; i >= 0; --i)
+				value = (value << 8) | at[i];
+
+			return value;
+		}
+
+		inline std::uint32_t read32(const unsigned char* at)
+		{
+			return std::uint32_t(at[0]) | (std::uint32_t(at[1]) << 8) |
+				   (std::uint32_t(at[2]) << 16) | (std::uint32_t(at[3]) << 24);
+		}
+
+		inline std::uint64_t round(std::uint64_t accumulator, std::uint64_t input)
+		{
+			accumulator += input * prime2;
+			accumulator = rotateLeft(accumulator, 31);
+			return accumulator * prime1;
+		}
+
+		inline std::uint64_t mergeRound(std::uint64_t accumulator, std::uint64_t value)
+		{
+			accumulator ^= round(0, value);
+			return accumulator * prime1 + prime4;
+		}
+	}
+
+	std::uint64_t hash64(const void* data, size_t size, std::uint64_t seed)
+	{
+		auto at = static_cast<const unsigned char*>(data);
+		auto end = at + size;
+		std::uint64_t result;
+
+		if(size >= 32)
+		{
+			//4 independent lanes over 32 byte stripes
+			std::uint64_t v1 = seed + prime1 + prime2;
+			std::uint64_t v2 = seed + prime2;
+			std::uint64_t v3 = seed;
+			std::uint64_t v4 = seed - prime1;
+
+			auto limit = end - 32;
+			do
+			{
+				v1 = round(v1, read64(at));
+				v2 = round(v2, read64(at + 8));
+				v3 = round(v3, read64(at + 16));
+				v4 = round(v4, read64(at + 24));
+				at += 32;
+			} while(at <= limit);
+
+			result = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+			result = mergeRound(result, v1);
+			result = mergeRound(result, v2);
+			result = mergeRound(result, v3);
+			result = mergeRound(result, v4);
+		}
+		else
+			result = seed + prime5;
+
+		result += static_cast<std::uint64_t>(size);
+
+		//the rest that does not fill whole stripe
+		for(; at + 8 <= end; at += 8)
+		{
+			result ^= round(0, read64(at));
+			result = rotateLeft(result, 27) * prime1 + prime4;
+		}
+
+		if(at + 4 <= end)
+		{
+			result ^= std::uint64_t(read32(at)) * prime1;
+			result = rotateLeft(result, 23) * prime2 + prime3;
+			at += 4;
+		}
+
+		for(; at < end; ++at)
+		{
+			result ^= (*at) * prime5;
+			result = rotateLeft(result, 11) * prime1;
+		}
+
+		result ^= result >> 33;
+		result *= prime2;
+		result ^= result >> 29;
+		result *= prime3;
+		result ^= result >> 32;
+
+		return result;
+	}
+}
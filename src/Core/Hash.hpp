@@ -0,0 +1,19 @@
+#ifndef _JH_HEADER_HASH_
+#define _JH_HEADER_HASH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace jh{
+	//64 bit XXH64 hash of size bytes at data
+	//the result is the same on every platform, so it can be stored on disk
+	std::uint64_t hash64(const void* data, size_t size, std::uint64_t seed = 0);
+
+	inline std::uint64_t hash64(std::string_view data, std::uint64_t seed = 0)
+	{
+		return hash64(data.data(), data.size(), seed);
+	}
+}
+
+#endif	//_JH_HEADER_HASH_
@@ -0,0 +1,81 @@
+#include "Interner.hpp"
+#include <algorithm>
+
+namespace jh{
+	Interner::Interner(size_t expectedSymbols)
+	{
+		size_t capacity = 16;
+		while(capacity < expectedSymbols * 2)
+			capacity *= 2;
+
+		slots.assign(capacity, { 0, invalidSymbol });
+		names.reserve(expectedSymbols);
+	}
+
+	Interner::Symbol Interner::intern(std::string_view name)
+	{
+		auto hash = _hash(name);
+		size_t mask = slots.size() - 1;
+
+		for(size_t index = hash & mask;; index = (index + 1) & mask)
+		{
+			auto& slot = slots[index];
+			if(slot.symbol == invalidSymbol)
+			{
+				auto symbol = static_cast<Symbol>(names.size());
+				names.push_back(storage.copy(name));
+				slot = { hash, symbol };
+
+				if(names.size() * 2 > slots.size())
+					_grow();
+
+				return symbol;
+			}
+
+			if(slot.hash == hash && names[slot.symbol] == name)
+				return slot.symbol;
+		}
+	}
+
+	Interner::Symbol Interner::find(std::string_view name) const
+	{
+		auto hash = _hash(name);
+		size_t mask = slots.size() - 1;
+
+		for(size_t index = hash & mask;; index = (index + 1) & mask)
+		{
+			const auto& slot = slots[index];
+			if(slot.symbol == invalidSymbol)
+				return invalidSymbol;
+
+			if(slot.hash == hash && names[slot.symbol] == name)
+				return slot.symbol;
+		}
+	}
+
+	void Interner::_grow()
+	{
+		std::vector<Slot> old(slots.size() * 2, { 0, invalidSymbol });
+		old.swap(slots);
+
+		size_t mask = slots.size() - 1;
+		for(const auto& slot : old)
+		{
+			if(slot.symbol == invalidSymbol)
+				continue;
+
+			size_t index = slot.hash & mask;
+			while(slots[index].symbol != invalidSymbol)
+				index = (index + 1) & mask;
+
+			slots[index] = slot;
+		}
+	}
+
+	void Interner::clear()
+	{
+		std::fill(slots.begin(), slots.end(), Slot{ 0, invalidSymbol });
+		names.clear();
+		storage.reset();
+	}
+}
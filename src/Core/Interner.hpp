@@ -0,0 +1,73 @@
+#ifndef _JH_HEADER_INTERNER_
+#define _JH_HEADER_INTERNER_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "Arena.hpp"
+
+namespace jh{
+	/*
+		Table of unique identifier names, each mapped to small integer symbol
+
+		Interning the same text twice gives the same symbol, so later stages compare and
+		look up names as integers instead of hashing text again. Symbols are dense, first
+		interned name is 0, and stay valid until clear().
+
+		The table is open addressing with linear probing, every slot keeps the hash of
+		its name, so probes only compare text when the hashes match. Names are copied
+		into an Arena, so the source they came from does not have to stay alive.
+	*/
+	class Interner{
+	public:
+		using Symbol = std::uint32_t;
+
+		static constexpr Symbol invalidSymbol = 0xFFFFFFFF;
+	private:
+		struct Slot{
+			std::uint32_t hash;
+			Symbol symbol;
+		};
+
+		//power of two in size, kept at most half full
+		std::vector<Slot> slots;
+
+		std::vector<std::string_view> names;
+		Arena storage;
+
+		//doubles the table and places every symbol again
+		void _grow();
+
+		static std::uint32_t _hash(std::string_view name)
+		{
+			//FNV-1a, identifiers are short enough that it beats the bulk hashes
+			std::uint32_t hash = 2166136261u;
+			for(char c : name)
+				hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+
+			return hash;
+		}
+	public:
+		explicit Interner(size_t expectedSymbols = 1024);
+
+		Interner(const Interner&) = delete;
+		Interner& operator=(const Interner&) = delete;
+
+		//returns symbol of given name, adding it if it is not in the table yet
+		Symbol intern(std::string_view name);
+
+		//returns symbol of given name, or invalidSymbol if it was never interned
+		Symbol find(std::string_view name) const;
+
+		//returns name of given symbol
+		std::string_view name(Symbol symbol) const { return names[symbol]; }
+
+		size_t size() const { return names.size(); }
+
+		//removes all symbols, keeping the allocated memory
+		void clear();
+	};
+}
+
+#endif	//_JH_HEADER_INTERNER_
@@ -0,0 +1,185 @@
+#include "OutputBuffer.hpp"
+#include "Error.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define JH_OUTPUT_WRITEV
+	#include <cerrno>
+	#include <fcntl.h>
+	#include <sys/uio.h>
+	#include <unistd.h>
+#endif
+
+namespace jh{
+	OutputBuffer::OutputBuffer(size_t bufferSize) : data(new char[bufferSize]), capacity(bufferSize)
+	{
+	}
+
+	OutputBuffer::~OutputBuffer()
+	{
+		close();
+	}
+
+	bool OutputBuffer::open(const std::string& filePath)
+	{
+		close();
+		path = filePath;
+		flushed = 0;
+		failed = false;
+
+#ifdef JH_OUTPUT_WRITEV
+		descriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if(descriptor < 0)
+		{
+			error() << "Cannot create file '" << path << "'\n";
+			return false;
+		}
+#else
+		file = std::fopen(path.c_str(), "wb");
+		if(!file)
+		{
+			error() << "Cannot create file '" << path << "'\n";
+			return false;
+		}
+#endif
+
+		return true;
+	}
+
+	void OutputBuffer::openMemory(std::string& target)
+	{
+		close();
+		path.clear();
+		flushed = 0;
+		failed = false;
+		memory = &target;
+	}
+
+	bool OutputBuffer::close()
+	{
+		flush();
+
+#ifdef JH_OUTPUT_WRITEV
+		if(descriptor >= 0 && ::close(descriptor) != 0)
+			failed = true;
+#endif
+
+		if(file && std::fclose(file) != 0)
+			failed = true;
+
+		descriptor = -1;
+		file = nullptr;
+		memory = nullptr;
+
+		if(failed && !path.empty())
+		{
+			error() << "Cannot write file '" << path << "'\n";
+			path.clear();
+		}
+
+		return !failed;
+	}
+
+	void OutputBuffer::flush()
+	{
+		if(used)
+			_flushWith(std::string_view());
+	}
+
+	void OutputBuffer::_flushWith(std::string_view extra)
+	{
+		//small slice is cheaper to copy than to write separately
+		if(extra.size() < capacity / 2)
+		{
+			_writeOut(std::string_view(data.get(), used), std::string_view());
+
+			if(!extra.empty())
+				std::memcpy(data.get(), extra.data(), extra.size());
+
+			used = extra.size();
+			return;
+		}
+
+		_writeOut(std::string_view(data.get(), used), extra);
+		used = 0;
+	}
+
+	void OutputBuffer::_writeOut(std::string_view first, std::string_view second)
+	{
+		flushed += first.size() + second.size();
+
+		if(memory)
+		{
+			memory->append(first);
+			memory->append(second);
+			return;
+		}
+
+		if(failed)
+			return;
+
+#ifdef JH_OUTPUT_WRITEV
+		if(descriptor < 0)
+			return;
+
+		iovec parts[2] = {
+			{ const_cast<char*>(first.data()), first.size() },
+			{ const_cast<char*>(second.data()), second.size() },
+		};
+
+		int index = 0;
+		while(index < 2)
+		{
+			if(!parts[index].iov_len)
+			{
+				++index;
+				continue;
+			}
+
+			auto done = ::writev(descriptor, parts + index, 2 - index);
+			if(done < 0)
+			{
+				if(errno == EINTR)
+					continue;
+
+				failed = true;
+				return;
+			}
+
+			//partial write, skip what went out already
+			auto left = static_cast<size_t>(done);
+			for(; index < 2 && left >= parts[index].iov_len; ++index)
+				left -= parts[index].iov_len;
+
+			if(index < 2)
+			{
+				parts[index].iov_base = static_cast<char*>(parts[index].iov_base) + left;
+				parts[index].iov_len -= left;
+			}
+		}
+#else
+		if(!file)
+			return;
+
+		if(std::fwrite(first.data(), 1, first.size(), file) != first.size() ||
+		   std::fwrite(second.data(), 1, second.size(), file) != second.size())
+			failed = true;
+#endif
+	}
+
+	void OutputBuffer::writeInteger(long long value)
+	{
+		char digits[24];
+		int length = std::snprintf(digits, sizeof(digits), "%lld", value);
+		write(std::string_view(digits, static_cast<size_t>(length)));
+	}
+
+	size_t OutputBuffer::getWritten() const
+	{
+		return flushed + used;
+	}
+
+	bool OutputBuffer::hasFailed() const
+	{
+		return failed;
+	}
+}
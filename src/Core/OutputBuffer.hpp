@@ -0,0 +1,98 @@
+#ifndef _JH_HEADER_OUTPUTBUFFER_
+#define _JH_HEADER_OUTPUTBUFFER_
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace jh{
+	/*
+		Buffered writer for generated output
+
+		Text is gathered in one big buffer, and goes to the file in a single write
+		every time the buffer fills up. Slices bigger than half of the buffer(long
+		functions copied straight from the source) are not copied into it at all, they
+		go out together with the buffered text in one writev.
+
+		The buffer is kept between files, so one OutputBuffer per thread does not
+		allocate after the first file.
+	*/
+	class OutputBuffer{
+		std::unique_ptr<char[]> data;
+		size_t capacity;
+		size_t used = 0;
+
+		//output goes into exactly one of these
+		int descriptor = -1;
+		std::FILE* file = nullptr;
+		std::string* memory = nullptr;
+
+		std::string path;
+
+		//bytes handed to the file or memory so far
+		size_t flushed = 0;
+
+		bool failed = false;
+
+		//writes buffered text followed by extra, empties the buffer
+		void _flushWith(std::string_view extra);
+
+		//writes both slices to the output, in order
+		void _writeOut(std::string_view first, std::string_view second);
+	public:
+		static constexpr size_t defaultCapacity = 256 * 1024;
+
+		explicit OutputBuffer(size_t bufferSize = defaultCapacity);
+
+		//closes the output, see close
+		~OutputBuffer();
+
+		OutputBuffer(const OutputBuffer&) = delete;
+		OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+		//creates or truncates given file and writes into it
+		//returns false and reports into error() if the file can not be created
+		bool open(const std::string& filePath);
+
+		//writes into given string, appending to it
+		void openMemory(std::string& target);
+
+		//writes out what is buffered and closes the output
+		//returns false if any write failed
+		bool close();
+
+		void write(std::string_view text)
+		{
+			if(text.size() <= capacity - used)
+			{
+				std::memcpy(data.get() + used, text.data(), text.size());
+				used += text.size();
+			}
+			else
+				_flushWith(text);
+		}
+
+		void put(char c)
+		{
+			if(used == capacity)
+				_flushWith(std::string_view());
+
+			data[used++] = c;
+		}
+
+		void writeInteger(long long value);
+
+		//writes out what is buffered
+		void flush();
+
+		//returns bytes written since open, buffered ones included
+		size_t getWritten() const;
+
+		bool hasFailed() const;
+	};
+}
+
+#endif	//_JH_HEADER_OUTPUTBUFFER_
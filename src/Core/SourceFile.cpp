@@ -0,0 +1,173 @@
+#include "SourceFile.hpp"
+#include "Error.hpp"
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#define JH_SOURCE_MMAP
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace jh{
+	SourceFile::SourceFile(const std::string& filePath)
+	{
+		open(filePath);
+	}
+
+	SourceFile::~SourceFile()
+	{
+		close();
+	}
+
+	SourceFile::SourceFile(SourceFile&& other) noexcept
+		: path(std::move(other.path)), mapping(other.mapping), mappingSize(other.mappingSize),
+		  buffer(std::move(other.buffer)), opened(other.opened)
+	{
+		other.mapping = nullptr;
+		other.mappingSize = 0;
+		other.opened = false;
+	}
+
+	SourceFile& SourceFile::operator=(SourceFile&& other) noexcept
+	{
+		if(this != &other)
+		{
+			close();
+
+			path = std::move(other.path);
+			mapping = other.mapping;
+			mappingSize = other.mappingSize;
+			buffer = std::move(other.buffer);
+			opened = other.opened;
+
+			other.mapping = nullptr;
+			other.mappingSize = 0;
+			other.opened = false;
+		}
+
+		return *this;
+	}
+
+	bool SourceFile::_readIntoBuffer()
+	{
+		std::ifstream file(path, std::ios::binary);
+		if(!file)
+		{
+			error() << "Cannot open file '" << path << "'\n";
+			return false;
+		}
+
+		//read in chunks, size of pipes and special files is not known up front
+		char chunk[64 * 1024];
+		while(file.read(chunk, sizeof(chunk)) || file.gcount())
+			buffer.append(chunk, static_cast<size_t>(file.gcount()));
+
+		if(file.bad())
+		{
+			error() << "Cannot read file '" << path << "'\n";
+			buffer.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SourceFile::open(const std::string& filePath)
+	{
+		close();
+		path = filePath;
+
+#ifdef JH_SOURCE_MMAP
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if(fd < 0)
+		{
+			error() << "Cannot open file '" << path << "'\n";
+			return false;
+		}
+
+		struct stat info;
+		if(fstat(fd, &info) != 0)
+		{
+			error() << "Cannot stat file '" << path << "'\n";
+			::close(fd);
+			return false;
+		}
+
+		//empty files can not be mapped, but there is nothing to map anyway
+		//same for pipes and other special files, those are read into buffer
+		if(info.st_size > 0 && S_ISREG(info.st_mode))
+		{
+			auto size = static_cast<size_t>(info.st_size);
+			void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(address != MAP_FAILED)
+			{
+				//lexer walks the file front to back once
+				madvise(address, size, MADV_SEQUENTIAL);
+
+				mapping = address;
+				mappingSize = size;
+				::close(fd);
+
+				opened = true;
+				return true;
+			}
+		}
+
+		::close(fd);
+
+		if(info.st_size == 0 && S_ISREG(info.st_mode))
+		{
+			opened = true;
+			return true;
+		}
+#endif
+
+		opened = _readIntoBuffer();
+		return opened;
+	}
+
+	void SourceFile::close()
+	{
+#ifdef JH_SOURCE_MMAP
+		if(mapping)
+			munmap(mapping, mappingSize);
+#endif
+
+		mapping = nullptr;
+		mappingSize = 0;
+		buffer.clear();
+		buffer.shrink_to_fit();
+		opened = false;
+	}
+
+	bool SourceFile::isOpen() const
+	{
+		return opened;
+	}
+
+	bool SourceFile::isMapped() const
+	{
+		return mapping != nullptr;
+	}
+
+	std::string_view SourceFile::getView() const
+	{
+		if(mapping)
+			return std::string_view(static_cast<const char*>(mapping), mappingSize);
+
+		return buffer;
+	}
+
+	size_t SourceFile::getSize() const
+	{
+		return mapping ? mappingSize : buffer.size();
+	}
+
+	const std::string& SourceFile::getPath() const
+	{
+		return path;
+	}
+}
@@ -0,0 +1,68 @@
+#ifndef _JH_HEADER_SOURCEFILE_
+#define _JH_HEADER_SOURCEFILE_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace jh{
+	/*
+		Read-only contents of a source file
+
+		On systems with mmap the file is mapped into memory, so lexing it does not
+		copy it anywhere and tokens can refer straight into the mapping. Anywhere else
+		the file is read into an internal buffer.
+
+		The view returned by getView() stays valid until the file is closed, reopened
+		or destroyed.
+	*/
+	class SourceFile{
+		std::string path;
+
+		//mapped memory, nullptr if the file is not mapped
+		void* mapping = nullptr;
+		size_t mappingSize = 0;
+
+		//used when mapping is not available or failed
+		std::string buffer;
+
+		bool opened = false;
+
+		//reads whole file into buffer, used when mapping is not possible
+		bool _readIntoBuffer();
+	public:
+		SourceFile() = default;
+
+		//opens given file right away, check isOpen() afterwards
+		explicit SourceFile(const std::string& filePath);
+
+		~SourceFile();
+
+		//SourceFile owns the mapping, so it can not be copied, only moved
+		SourceFile(const SourceFile&) = delete;
+		SourceFile& operator=(const SourceFile&) = delete;
+		SourceFile(SourceFile&& other) noexcept;
+		SourceFile& operator=(SourceFile&& other) noexcept;
+
+		//opens given file, closing the currently opened one
+		//returns false and reports into error() if the file can not be read
+		bool open(const std::string& filePath);
+
+		//releases the mapping or buffer
+		void close();
+
+		bool isOpen() const;
+
+		//returns whether the contents are memory mapped rather than copied
+		bool isMapped() const;
+
+		//returns contents of the file
+		std::string_view getView() const;
+
+		size_t getSize() const;
+
+		const std::string& getPath() const;
+	};
+}
+
+#endif	//_JH_HEADER_SOURCEFILE_
@@ -0,0 +1,168 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace jh{
+	namespace{
+		//pool and queue of the worker running on this thread, so that tasks
+		//submitted from inside a task stay on the same worker
+		thread_local const ThreadPool* currentPool = nullptr;
+		thread_local size_t currentQueue = 0;
+	}
+
+	ThreadPool::ThreadPool(size_t threads)
+	{
+		if(!threads)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+
+		queues.reserve(threads);
+		for(size_t i = 0; i < threads; ++i)
+			queues.push_back(std::make_unique<Queue>());
+
+		workers.reserve(threads);
+		for(size_t i = 0; i < threads; ++i)
+			workers.emplace_back(&ThreadPool::_workerLoop, this, i);
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		try
+		{
+			wait();
+		}
+		catch(...)
+		{
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stopping = true;
+		}
+
+		wakeUp.notify_all();
+		for(auto& worker : workers)
+			worker.join();
+	}
+
+	void ThreadPool::submit(Task task)
+	{
+		size_t index = currentPool == this ? currentQueue : nextQueue++ % queues.size();
+		++unfinished;
+
+		{
+			std::lock_guard<std::mutex> lock(queues[index]->mutex);
+			queues[index]->tasks.push_back(std::move(task));
+		}
+
+		//counted under sleepMutex, so that worker going to sleep can not miss it
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			++queued;
+		}
+
+		wakeUp.notify_one();
+	}
+
+	bool ThreadPool::_takeTask(size_t index, Task& task)
+	{
+		//own queue from the back, the task is likely still warm in cache
+		{
+			auto& own = *queues[index];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if(!own.tasks.empty())
+			{
+				task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+				--queued;
+				return true;
+			}
+		}
+
+		//others from the front, those are the tasks waiting the longest
+		for(size_t i = 1; i < queues.size(); ++i)
+		{
+			auto& other = *queues[(index + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(other.mutex);
+			if(!other.tasks.empty())
+			{
+				task = std::move(other.tasks.front());
+				other.tasks.pop_front();
+				--queued;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void ThreadPool::_runTask(Task& task)
+	{
+		try
+		{
+			task();
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> lock(failureMutex);
+			if(!failure)
+				failure = std::current_exception();
+		}
+
+		task = nullptr;
+
+		if(--unfinished == 0)
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			allDone.notify_all();
+		}
+	}
+
+	void ThreadPool::_workerLoop(size_t index)
+	{
+		currentPool = this;
+		currentQueue = index;
+
+		Task task;
+		while(true)
+		{
+			if(_takeTask(index, task))
+			{
+				_runTask(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			wakeUp.wait(lock, [this]{ return stopping || queued > 0; });
+
+			if(stopping && queued == 0)
+				return;
+		}
+	}
+
+	void ThreadPool::wait()
+	{
+		//help with the work instead of just sleeping
+		Task task;
+		size_t index = currentPool == this ? currentQueue : 0;
+		while(_takeTask(index, task))
+			_runTask(task);
+
+		{
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			allDone.wait(lock, [this]{ return unfinished == 0; });
+		}
+
+		std::lock_guard<std::mutex> lock(failureMutex);
+		if(failure)
+		{
+			auto rethrown = failure;
+			failure = nullptr;
+			std::rethrow_exception(rethrown);
+		}
+	}
+
+	size_t ThreadPool::size() const
+	{
+		return workers.size();
+	}
+}
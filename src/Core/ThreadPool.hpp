@@ -0,0 +1,81 @@
+#ifndef _JH_HEADER_THREADPOOL_
+#define _JH_HEADER_THREADPOOL_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jh{
+	/*
+		Fixed set of worker threads running submitted tasks
+
+		Every worker owns a queue. Tasks submitted from outside are spread over the
+		queues round robin, tasks submitted from inside a task go to the queue of the
+		worker running it. Worker takes the newest task of its own queue, and when it
+		runs out it steals the oldest task from another queue, so a few long tasks
+		(big maps) do not leave the other workers waiting behind them.
+	*/
+	class ThreadPool{
+	public:
+		using Task = std::function<void()>;
+	private:
+		struct Queue{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		std::vector<std::unique_ptr<Queue>> queues;
+		std::vector<std::thread> workers;
+
+		//guards sleeping of workers and waiters
+		std::mutex sleepMutex;
+		std::condition_variable wakeUp;
+		std::condition_variable allDone;
+
+		//tasks sitting in queues, and tasks submitted but not finished yet
+		std::atomic<size_t> queued{0};
+		std::atomic<size_t> unfinished{0};
+
+		std::atomic<size_t> nextQueue{0};
+		bool stopping = false;
+
+		//first exception thrown by a task, rethrown from wait()
+		std::mutex failureMutex;
+		std::exception_ptr failure;
+
+		void _workerLoop(size_t index);
+
+		//takes task from queue index, or steals from the others
+		bool _takeTask(size_t index, Task& task);
+
+		void _runTask(Task& task);
+	public:
+		//threads of 0 uses as many threads as the machine has cores
+		explicit ThreadPool(size_t threads = 0);
+
+		//waits for the submitted tasks to finish and stops the workers
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		void submit(Task task);
+
+		//runs tasks on the calling thread too until every submitted task is finished
+		//rethrows the first exception thrown by a task, if any
+		//must not be called from inside a task, since that task is not finished
+		void wait();
+
+		//returns number of worker threads
+		size_t size() const;
+	};
+}
+
+#endif	//_JH_HEADER_THREADPOOL_
@@ -0,0 +1,592 @@
+#include "Driver.hpp"
+#include "../Cache/TokenCache.hpp"
+#include "../Cache/TokenImage.hpp"
+#include "../CodeGen/JassGenerator.hpp"
+#include "../Core/Error.hpp"
+#include "../Core/OutputBuffer.hpp"
+#include "../Core/SourceFile.hpp"
+#include "../Core/ThreadPool.hpp"
+#include "../Lexer/Lexer.hpp"
+#include "../Optimizer/Minifier.hpp"
+#include "../Optimizer/Optimizer.hpp"
+#include "../Parser/LibraryGraph.hpp"
+#include "../Parser/ParallelParser.hpp"
+#include "../Parser/Parser.hpp"
+#include "../Preprocessor/TextmacroExpander.hpp"
+#include "../Semantic/NameResolver.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <string_view>
+#include <unordered_map>
+
+namespace jh{
+	namespace{
+		using Clock = std::chrono::steady_clock;
+
+		double millisecondsSince(Clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+
+		//each worker lexes all its files with one Lexer, which keeps its memory
+		//between files, so steady state compiles do not allocate for tokens
+		Lexer& workerLexer()
+		{
+			thread_local Lexer lexer;
+			lexer.reset();
+			return lexer;
+		}
+
+		TextmacroExpander& workerExpander()
+		{
+			thread_local TextmacroExpander expander;
+			return expander;
+		}
+
+		//same for the parser and the tree it builds
+		struct ParseState{
+			Parser parser;
+			Ast ast;
+		};
+
+		ParseState& workerParseState()
+		{
+			thread_local ParseState state;
+			return state;
+		}
+
+		//libraries of the file, when it is not parsed by ParallelParser, which has its own
+		LibraryGraph& workerGraph()
+		{
+			thread_local LibraryGraph graph;
+			return graph;
+		}
+
+		NameResolver& workerResolver()
+		{
+			thread_local NameResolver resolver;
+			return resolver;
+		}
+
+		//symbols of tokens after textmacros are expanded
+		std::vector<Interner::Symbol>& workerTokenNames()
+		{
+			thread_local std::vector<Interner::Symbol> names;
+			return names;
+		}
+
+		//gives tokens of the file in expanded the symbols they were lexed with, tokens
+		//spliced in by textmacros are left to the resolver, tokens of the file keep
+		//their order and position, so both lists are walked once
+		void mapTokenNames(const Lexer::TokenList& lexed, const std::vector<Interner::Symbol>& lexedNames,
+						   const Lexer::TokenList& expanded, const std::vector<TokenRange>& splices,
+						   std::vector<Interner::Symbol>& names)
+		{
+			names.assign(expanded.size(), Interner::invalidSymbol);
+
+			size_t from = 0;
+			auto splice = splices.begin();
+			for(size_t i = 0; i < expanded.size(); ++i)
+			{
+				while(splice != splices.end() && splice->last <= i)
+					++splice;
+
+				if(splice != splices.end() && splice->first <= i)
+					continue;
+
+				while(from < lexed.size() && lexed[from].position < expanded[i].position)
+					++from;
+
+				if(from < lexed.size() && lexed[from].position == expanded[i].position && lexed[from].type == expanded[i].type)
+					names[i] = lexedNames[from];
+			}
+		}
+
+		//and for the output, the buffer is the only big allocation of the writer
+		struct GenerateState{
+			JassGenerator generator;
+			Optimizer optimizer;
+			Minifier minifier;
+			OutputBuffer output;
+			OutputBuffer mapping;
+		};
+
+		GenerateState& workerGenerateState()
+		{
+			thread_local GenerateState state;
+			return state;
+		}
+
+		//token image of the file being compiled, kept between files as well
+		struct ImageState{
+			std::string bytes;
+			OutputBuffer output;
+		};
+
+		ImageState& workerImageState()
+		{
+			thread_local ImageState state;
+			return state;
+		}
+
+		bool isSourceFile(const std::filesystem::path& path)
+		{
+			auto extension = path.extension();
+			return extension == ".j" || extension == ".ej";
+		}
+
+		std::string outputNameOf(std::filesystem::path path)
+		{
+			path.replace_extension(".j");
+			return path.generic_string();
+		}
+	}
+
+	Driver::Driver() = default;
+
+	Driver::~Driver() = default;
+
+	bool Driver::addPath(const std::string& path)
+	{
+		namespace fs = std::filesystem;
+
+		std::error_code code;
+		if(fs::is_directory(path, code))
+		{
+			//sorted, so that reports of two runs can be compared line by line
+			std::vector<std::string> found;
+			for(fs::recursive_directory_iterator it(path, code), end; !code && it != end; it.increment(code))
+			{
+				if(it->is_regular_file(code) && isSourceFile(it->path()))
+					found.push_back(it->path().string());
+			}
+
+			std::sort(found.begin(), found.end());
+			for(auto& file : found)
+			{
+				CompileResult result;
+				result.path = std::move(file);
+				result.outputName = outputNameOf(fs::path(result.path).lexically_relative(path));
+				results.push_back(std::move(result));
+			}
+
+			return true;
+		}
+
+		if(!fs::exists(path, code))
+		{
+			error() << "No such file or directory '" << path << "'\n";
+			return false;
+		}
+
+		CompileResult result;
+		result.path = path;
+		result.outputName = outputNameOf(fs::path(path).filename());
+		results.push_back(std::move(result));
+		return true;
+	}
+
+	void Driver::setThreadCount(size_t threads)
+	{
+		threadCount = threads;
+	}
+
+	void Driver::setParallelLibraries(bool enabled)
+	{
+		parallelLibraries = enabled;
+	}
+
+	void Driver::setOutputDirectory(const std::string& directory)
+	{
+		outputDirectory = directory;
+	}
+
+	void Driver::setTokenImageDirectory(const std::string& directory)
+	{
+		imageDirectory = directory;
+	}
+
+	void Driver::setDebug(bool enabled)
+	{
+		debugMode = enabled;
+	}
+
+	void Driver::setAllocator(AllocatorKind kind)
+	{
+		allocator = kind;
+	}
+
+	void Driver::setOptimize(bool enabled)
+	{
+		optimize = enabled;
+	}
+
+	void Driver::setMinify(bool enabled)
+	{
+		minify = enabled;
+	}
+
+	bool Driver::addNatives(const std::string& path)
+	{
+		SourceFile file;
+		if(!file.open(path))
+			return false;
+
+		//every identifier, parameters too, skipping more names than needed costs nothing
+		auto input = file.getView();
+		Lexer lexer;
+		for(const auto& token : lexer.tokenize(input))
+		{
+			if(token.type == Token::Type::Id)
+				natives.intern(input.substr(token.position, token.length));
+		}
+
+		return true;
+	}
+
+	void Driver::define(const std::string& name, const std::string& value)
+	{
+		defines.define(name, value);
+	}
+
+	void Driver::setCacheDirectory(const std::string& directory)
+	{
+		cache = std::make_unique<TokenCache>(directory);
+		cache->setDefines(&defines);
+	}
+
+	void Driver::_compileFile(CompileResult& result) const
+	{
+		auto start = Clock::now();
+
+		SourceFile file;
+		if(!file.open(result.path))
+			return;
+
+		auto input = file.getView();
+		result.bytes = input.size();
+		result.readTime = millisecondsSince(start);
+
+		auto lexStart = Clock::now();
+		Lexer::TokenList cachedTokens;
+		const Lexer::TokenList* tokens = &cachedTokens;
+		bool conditionsValid = true;
+
+		//identifiers are interned while lexing, cached tokens are interned by the resolver
+		auto& resolver = workerResolver();
+		const std::vector<Interner::Symbol>* tokenNames = nullptr;
+		if(cache && cache->load(input, cachedTokens))
+			result.cached = true;
+		else
+		{
+			auto& lexer = workerLexer();
+			lexer.setDefines(&defines);
+			lexer.setInterner(&resolver.prepareNames());
+			tokens = &lexer.tokenize(input);
+			tokenNames = &lexer.getTokenData();
+
+			for(const auto& directive : lexer.getDirectiveErrors())
+				error() << result.path << ":" << directive.line << ": " << directive.message << "\n";
+
+			//entries with errors are not stored, so that they are reported on every run
+			conditionsValid = lexer.getDirectiveErrors().empty();
+			if(cache && conditionsValid)
+				cache->store(input, *tokens);
+		}
+
+		//images hold the tokens of the source, before textmacros
+		bool imaged = true;
+		if(!imageDirectory.empty() && conditionsValid)
+		{
+			auto& image = workerImageState();
+			auto path = std::filesystem::path(imageDirectory) / result.outputName;
+			path.replace_extension(".jti");
+
+			image.bytes.clear();
+			TokenImage::encode(*tokens, input.size(), TokenImage::keyOf(input, &defines), image.bytes);
+			imaged = image.output.open(path.string());
+			if(imaged)
+			{
+				image.output.write(image.bytes);
+				imaged = image.output.close();
+			}
+		}
+
+		//textmacros are spliced into the tokens, files without them are used as they are
+		auto& expander = workerExpander();
+		bool expanded = expander.expand(*tokens, input, result.path);
+		if(expander.hasExpanded())
+		{
+			if(tokenNames)
+			{
+				auto& expandedNames = workerTokenNames();
+				mapTokenNames(*tokens, *tokenNames, expander.getTokens(), expander.getSplices(), expandedNames);
+				tokenNames = &expandedNames;
+			}
+
+			tokens = &expander.getTokens();
+			input = expander.getText();
+		}
+
+		result.tokens = tokens->size();
+		result.lexTime = millisecondsSince(lexStart);
+
+		auto parseStart = Clock::now();
+		bool parsed;
+		const Ast* tree;
+		if(libraryParser)
+		{
+			parsed = libraryParser->parse(*tokens, input, result.path);
+			tree = &libraryParser->getTree();
+		}
+		else
+		{
+			//requirements are checked the same as ParallelParser does, so that both
+			//accept the same files, the generator then orders the libraries by them
+			auto& state = workerParseState();
+			parsed = workerGraph().build(*tokens, input, result.path);
+			parsed = state.parser.parse(*tokens, input, state.ast, result.path) && parsed;
+			tree = &state.ast;
+		}
+
+		result.nodes = tree->size();
+		result.parseTime = millisecondsSince(parseStart);
+
+		auto resolveStart = Clock::now();
+		bool resolved = parsed && resolver.resolve(*tree, tokenNames, result.path);
+		result.resolveTime = millisecondsSince(resolveStart);
+
+		//files with errors in directives or textmacros are parsed for their errors only
+		bool generated = true;
+		if(conditionsValid && expanded && resolved && !outputDirectory.empty())
+		{
+			auto generateStart = Clock::now();
+			auto& state = workerGenerateState();
+			auto path = std::filesystem::path(outputDirectory) / result.outputName;
+
+			generated = state.output.open(path.string());
+			if(generated)
+			{
+				state.generator.setDebug(debugMode);
+				state.generator.setAllocator(allocator);
+				state.generator.setSplices(expander.hasExpanded() ? &expander.getSplices() : nullptr);
+				state.generator.setNames(&resolver);
+				state.generator.setOptimizer(optimize ? &state.optimizer : nullptr);
+				state.generator.setMinifier(minify ? &state.minifier : nullptr);
+				state.minifier.setNatives(&natives);
+				if(optimize)
+					state.optimizer.optimize(*tree, resolver);
+
+				if(minify)
+					state.minifier.minify(*tree, resolver);
+
+				generated = state.generator.generate(*tree, state.output, result.path);
+				generated = state.output.close() && generated;
+				result.outputBytes = state.output.getWritten();
+
+				//original names, to read the minified output by
+				if(minify)
+				{
+					path.replace_extension(".names");
+					bool mapped = state.mapping.open(path.string());
+					if(mapped)
+					{
+						state.minifier.writeMapping(state.mapping);
+						mapped = state.mapping.close();
+					}
+
+					generated = mapped && generated;
+				}
+			}
+
+			//no partial output is left behind
+			if(!generated)
+			{
+				std::error_code code;
+				path.replace_extension(".j");
+				std::filesystem::remove(path, code);
+				if(minify)
+				{
+					path.replace_extension(".names");
+					std::filesystem::remove(path, code);
+				}
+			}
+
+			result.generateTime = millisecondsSince(generateStart);
+		}
+
+		result.succeeded = conditionsValid && imaged && expanded && resolved && generated;
+		result.totalTime = millisecondsSince(start);
+	}
+
+	std::vector<CompileResult*> Driver::_claimOutputs()
+	{
+		std::vector<CompileResult*> claimed;
+		claimed.reserve(results.size());
+		if(outputDirectory.empty() && imageDirectory.empty())
+		{
+			for(auto& result : results)
+				claimed.push_back(&result);
+
+			return claimed;
+		}
+
+		//the first file keeps the output, so that no two workers write the same file,
+		//directories are created before any worker starts for the same reason
+		std::unordered_map<std::string_view, const CompileResult*> owners;
+		for(auto& result : results)
+		{
+			auto owner = owners.emplace(result.outputName, &result);
+			if(!owner.second)
+			{
+				error() << result.path << ": output " << result.outputName << " is already written for "
+						<< owner.first->second->path << "\n";
+				continue;
+			}
+
+			for(const auto* directory : { &outputDirectory, &imageDirectory })
+			{
+				if(directory->empty())
+					continue;
+
+				std::error_code code;
+				auto path = std::filesystem::path(*directory) / result.outputName;
+				std::filesystem::create_directories(path.parent_path(), code);
+			}
+
+			claimed.push_back(&result);
+		}
+
+		return claimed;
+	}
+
+	size_t Driver::run()
+	{
+		auto start = Clock::now();
+
+		auto order = _claimOutputs();
+		if(parallelLibraries)
+		{
+			//the threads are used inside every file instead
+			libraryParser = std::make_unique<ParallelParser>(threadCount);
+			for(auto* result : order)
+				_compileFile(*result);
+
+			libraryParser.reset();
+		}
+		else
+		{
+			ThreadPool pool(threadCount);
+
+			//biggest files first, so that no long file is left for the very end
+			for(auto* result : order)
+			{
+				std::error_code code;
+				auto size = std::filesystem::file_size(result->path, code);
+				result->bytes = code ? 0 : static_cast<size_t>(size);
+			}
+
+			std::stable_sort(order.begin(), order.end(), [](const CompileResult* a, const CompileResult* b){
+				return a->bytes > b->bytes;
+			});
+
+			for(auto* result : order)
+				pool.submit([this, result]{ _compileFile(*result); });
+
+			pool.wait();
+		}
+
+		wallTime = millisecondsSince(start);
+
+		return std::count_if(results.begin(), results.end(), [](const CompileResult& result){
+			return !result.succeeded;
+		});
+	}
+
+	void Driver::printReport(std::ostream& out, bool perFile) const
+	{
+		size_t bytes = 0;
+		size_t tokens = 0;
+		size_t nodes = 0;
+		size_t failed = 0;
+		size_t cached = 0;
+		double readTime = 0.0;
+		double lexTime = 0.0;
+		double parseTime = 0.0;
+		double resolveTime = 0.0;
+		double generateTime = 0.0;
+		size_t outputBytes = 0;
+		double cpuTime = 0.0;
+
+		auto flags = out.flags();
+		out << std::fixed << std::setprecision(2);
+
+		for(const auto& result : results)
+		{
+			if(perFile)
+			{
+				out << result.path << ": ";
+				if(result.succeeded)
+				{
+					out << result.bytes << " bytes, " << result.tokens << " tokens, " << result.nodes
+						<< " nodes, read " << result.readTime << " ms, " << (result.cached ? "cached " : "lex ")
+						<< result.lexTime << " ms, parse " << result.parseTime << " ms, resolve " << result.resolveTime << " ms, ";
+
+					if(!outputDirectory.empty())
+						out << "generate " << result.generateTime << " ms(" << result.outputBytes << " bytes), ";
+
+					out << "total " << result.totalTime << " ms\n";
+				}
+				else
+					out << "failed\n";
+			}
+
+			if(!result.succeeded)
+			{
+				++failed;
+				continue;
+			}
+
+			cached += result.cached;
+			bytes += result.bytes;
+			tokens += result.tokens;
+			nodes += result.nodes;
+			readTime += result.readTime;
+			lexTime += result.lexTime;
+			parseTime += result.parseTime;
+			resolveTime += result.resolveTime;
+			generateTime += result.generateTime;
+			outputBytes += result.outputBytes;
+			cpuTime += result.totalTime;
+		}
+
+		out << results.size() << " files, " << failed << " failed, " << bytes << " bytes, "
+			<< tokens << " tokens, " << nodes << " nodes";
+
+		if(cache)
+			out << ", " << cached << " from cache";
+
+		out << "\n";
+		out << "read " << readTime << " ms, lex " << lexTime << " ms, parse " << parseTime << " ms, resolve "
+			<< resolveTime << " ms, ";
+
+		if(!outputDirectory.empty())
+			out << "generate " << generateTime << " ms(" << outputBytes << " bytes), ";
+
+		out << "summed " << cpuTime
+			<< " ms, wall " << wallTime << " ms";
+
+		if(wallTime > 0.0)
+			out << ", " << (bytes / (1024.0 * 1024.0)) / (wallTime / 1000.0) << " MiB/s";
+
+		out << "\n";
+		out.flags(flags);
+	}
+
+	const std::vector<CompileResult>& Driver::getResults() const
+	{
+		return results;
+	}
+}
@@ -0,0 +1,158 @@
+#ifndef _JH_HEADER_DRIVER_
+#define _JH_HEADER_DRIVER_
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../CodeGen/StructLayout.hpp"
+#include "../Core/Interner.hpp"
+#include "../Preprocessor/Defines.hpp"
+
+namespace jh{
+	class ParallelParser;
+	class TokenCache;
+
+	//outcome of compiling single file
+	struct CompileResult{
+		std::string path;
+		bool succeeded = false;
+
+		//path of the output inside the output directory, the path of the file relative
+		//to the directory it was added with, or just its name, with .j extension
+		std::string outputName;
+
+		//tokens were loaded from TokenCache instead of lexing
+		bool cached = false;
+
+		size_t bytes = 0;
+		size_t tokens = 0;
+		size_t nodes = 0;
+
+		//bytes of Jass written, 0 without output directory
+		size_t outputBytes = 0;
+
+		//time spent in each stage of the pipeline, in milliseconds
+		//lexTime includes expanding textmacros, generateTime optimizing and minifying
+		double readTime = 0.0;
+		double lexTime = 0.0;
+		double parseTime = 0.0;
+		double resolveTime = 0.0;
+		double generateTime = 0.0;
+		double totalTime = 0.0;
+	};
+
+	/*
+		Compiles batch of files, each file's pipeline running as one task on ThreadPool
+
+		Files are independent of each other, so the only thing shared between tasks is
+		the result slot each of them writes into.
+	*/
+	class Driver{
+		std::vector<CompileResult> results;
+		size_t threadCount = 0;
+
+		//files are compiled one after another, each parsing its libraries concurrently
+		//with libraryParser, which keeps its memory between files
+		bool parallelLibraries = false;
+		std::unique_ptr<ParallelParser> libraryParser;
+
+		//Jass is written into this directory when it is not empty
+		std::string outputDirectory;
+
+		//TokenImage of every file is written into this directory when it is not empty
+		std::string imageDirectory;
+		bool debugMode = false;
+
+		//allocator of structs that do not have their own
+		AllocatorKind allocator = AllocatorKind::Bump;
+
+		//output is optimized, see Optimizer
+		bool optimize = false;
+
+		//output is minified, see Minifier, with the names listed in .names file next
+		//to every output file
+		bool minify = false;
+
+		//conditions of #if directives are evaluated against these
+		Defines defines;
+
+		//names of the files given to addNatives, minified names skip them
+		Interner natives;
+
+		//nullptr when files are always lexed
+		std::unique_ptr<TokenCache> cache;
+
+		//wall clock time of the last run, in milliseconds
+		double wallTime = 0.0;
+
+		//runs the whole pipeline for result.path and fills the rest of result
+		void _compileFile(CompileResult& result) const;
+
+		//returns files to compile, files whose output another file already writes are
+		//reported into error() and left out, creates directories of the outputs and
+		//of the token images
+		std::vector<CompileResult*> _claimOutputs();
+	public:
+		Driver();
+		~Driver();
+
+		Driver(const Driver&) = delete;
+		Driver& operator=(const Driver&) = delete;
+
+		//adds file, or every .j and .ej file inside directory and its subdirectories
+		//returns false and reports into error() if the path does not exist
+		bool addPath(const std::string& path);
+
+		//threads of 0 uses as many threads as the machine has cores
+		void setThreadCount(size_t threads);
+
+		//compiles files one by one, parsing libraries of every file concurrently(see
+		//ParallelParser), instead of compiling whole files concurrently
+		//this pays off for few big files with many libraries
+		void setParallelLibraries(bool enabled);
+
+		//keeps lexed tokens in given directory, so that unchanged files are not lexed again
+		void setCacheDirectory(const std::string& directory);
+
+		//writes Jass of every file into given directory, under the file's path relative
+		//to the directory it was found in, or under its name if it was added on its own,
+		//with .j extension, the files are only checked without it
+		//files that would overwrite output of another file fail
+		void setOutputDirectory(const std::string& directory);
+
+		//writes TokenImage of the tokens of every file into given directory, under the
+		//same path as the output, with .jti extension, for tools that map lexed files
+		void setTokenImageDirectory(const std::string& directory);
+
+		//keeps debug statements in the output
+		void setDebug(bool enabled);
+
+		//sets allocator of structs that do not have their own, see JassGenerator
+		void setAllocator(AllocatorKind kind);
+
+		//optimizes the output, see Optimizer
+		void setOptimize(bool enabled);
+
+		//minifies the output and writes the original names into .names files, see Minifier
+		void setMinify(bool enabled);
+
+		//adds every name in file such as common.j or blizzard.j to the names minified
+		//output does not use, returns false and reports into error() if it can not be read
+		bool addNatives(const std::string& path);
+
+		//defines name for #if conditions of every file, see Defines
+		void define(const std::string& name, const std::string& value = "true");
+
+		//compiles every added file, returns number of files that failed
+		size_t run();
+
+		//prints timing of every file, if perFile is set, and the totals
+		void printReport(std::ostream& out, bool perFile = true) const;
+
+		const std::vector<CompileResult>& getResults() const;
+	};
+}
+
+#endif	//_JH_HEADER_DRIVER_
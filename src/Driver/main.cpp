@@ -0,0 +1,160 @@
+#include "Driver.hpp"
+#include "../Core/Error.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace{
+	void printUsage(const char* program)
+	{
+		std::cout << "Usage: " << program << " [options] <file|directory>...\n"
+				  << "Compiles every given file, and every .j and .ej file inside given directories\n\n"
+				  << "Options:\n"
+				  << "  -j <threads>  number of worker threads, 0 for one per core(default)\n"
+				  << "  --cache <dir> keep lexed tokens in dir, unchanged files are not lexed again\n"
+				  << "  -o <dir>      write Jass of every file into dir\n"
+				  << "  --tokens <dir>\n"
+				  << "                write lexed tokens of every file into dir, as .jti token images\n"
+				  << "  --debug       keep debug statements in the output\n"
+				  << "  -O            fold constants, inline small functions, and leave out code main\n"
+				  << "                does not reach\n"
+				  << "  --minify      write the shortest names, without comments and indentation,\n"
+				  << "                and the original names into .names file next to the output\n"
+				  << "  --natives <file>\n"
+				  << "                names declared in file(common.j, blizzard.j) are not given out\n"
+				  << "                by --minify, can be given more times\n"
+				  << "  --allocator <bump|freelist>\n"
+				  << "                how instances of structs without allocator are recycled\n"
+				  << "                bump(default) reuses them from stack, freelist links them\n"
+				  << "  -D <name>[=<value>]\n"
+				  << "                define name for #if conditions, value is true if not given\n"
+				  << "  --libraries   compile files one by one, parsing libraries of each file in parallel\n"
+				  << "  -q            print only the totals, not every file\n"
+				  << "  -h, --help    print this message\n";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	jh::Driver driver;
+	bool perFile = true;
+	bool anyPath = false;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+
+		if(arg == "-h" || arg == "--help")
+		{
+			printUsage(argv[0]);
+			return 0;
+		}
+		else if(arg == "-q")
+			perFile = false;
+		else if(arg == "--debug")
+			driver.setDebug(true);
+		else if(arg == "-O")
+			driver.setOptimize(true);
+		else if(arg == "--minify")
+			driver.setMinify(true);
+		else if(arg == "--allocator")
+		{
+			std::string kind = i + 1 < argc ? argv[++i] : "";
+			if(kind == "bump")
+				driver.setAllocator(jh::AllocatorKind::Bump);
+			else if(kind == "freelist")
+				driver.setAllocator(jh::AllocatorKind::FreeList);
+			else
+			{
+				jh::error() << "Allocator has to be bump or freelist\n";
+				return 1;
+			}
+		}
+		else if(arg == "-D")
+		{
+			if(i + 1 >= argc)
+			{
+				jh::error() << "Missing name after -D\n";
+				return 1;
+			}
+
+			std::string definition = argv[++i];
+			auto equals = definition.find('=');
+			if(equals == std::string::npos)
+				driver.define(definition);
+			else
+				driver.define(definition.substr(0, equals), definition.substr(equals + 1));
+		}
+		else if(arg == "-o")
+		{
+			if(i + 1 >= argc)
+			{
+				jh::error() << "Missing directory after -o\n";
+				return 1;
+			}
+
+			driver.setOutputDirectory(argv[++i]);
+		}
+		else if(arg == "--tokens")
+		{
+			if(i + 1 >= argc)
+			{
+				jh::error() << "Missing directory after --tokens\n";
+				return 1;
+			}
+
+			driver.setTokenImageDirectory(argv[++i]);
+		}
+		else if(arg == "--natives")
+		{
+			if(i + 1 >= argc)
+			{
+				jh::error() << "Missing file after --natives\n";
+				return 1;
+			}
+
+			if(!driver.addNatives(argv[++i]))
+				return 1;
+		}
+		else if(arg == "--libraries")
+			driver.setParallelLibraries(true);
+		else if(arg == "-j")
+		{
+			if(i + 1 >= argc)
+			{
+				jh::error() << "Missing thread count after -j\n";
+				return 1;
+			}
+
+			driver.setThreadCount(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if(arg == "--cache")
+		{
+			if(i + 1 >= argc)
+			{
+				jh::error() << "Missing directory after --cache\n";
+				return 1;
+			}
+
+			driver.setCacheDirectory(argv[++i]);
+		}
+		else
+		{
+			if(!driver.addPath(arg))
+				return 1;
+
+			anyPath = true;
+		}
+	}
+
+	if(!anyPath)
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	size_t failed = driver.run();
+	driver.printReport(std::cout, perFile);
+
+	return failed ? 1 : 0;
+}
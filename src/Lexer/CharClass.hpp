@@ -0,0 +1,137 @@
+#ifndef _JH_HEADER_CHARCLASS_
+#define _JH_HEADER_CHARCLASS_
+
+#include <array>
+#include <cstdint>
+#include "../Core/Token.hpp"
+
+namespace jh{
+	//character classes, one char can be in multiple classes at once
+	namespace CharClass{
+		enum : std::uint8_t{
+			Ident		= 1 << 0,	//[0-9a-zA-Z_], continues identifier
+			Alpha		= 1 << 1,	//[a-zA-Z]
+			Digit		= 1 << 2,	//[0-9]
+			HexDigit	= 1 << 3,	//[0-9a-fA-F]
+			OctDigit	= 1 << 4,	//[0-7]
+			Newline		= 1 << 5,	//\n, \r
+			Blank		= 1 << 6,	//space, \t, \v, \f
+			Operator	= 1 << 7,	//any character that can start operator token
+		};
+	}
+
+	//what should the lexer do when it runs into given character at the start of a token
+	enum class CharAction : std::uint8_t{
+		Unknown,	//not valid in any token, lexed as invalid Id and left for parser
+		Word,		//keyword or identifier
+		Number,		//integer or real literal
+		Newline,
+		Blank,
+		Operator,
+	};
+
+	namespace detail{
+		constexpr std::array<std::uint8_t, 256> buildCharClassTable()
+		{
+			std::array<std::uint8_t, 256> table{};
+
+			for(int c = 'a'; c <= 'z'; ++c)
+				table[c] |= CharClass::Ident | CharClass::Alpha;
+			for(int c = 'A'; c <= 'Z'; ++c)
+				table[c] |= CharClass::Ident | CharClass::Alpha;
+			for(int c = '0'; c <= '9'; ++c)
+				table[c] |= CharClass::Ident | CharClass::Digit | CharClass::HexDigit;
+			for(int c = '0'; c <= '7'; ++c)
+				table[c] |= CharClass::OctDigit;
+			for(int c = 'a'; c <= 'f'; ++c)
+				table[c] |= CharClass::HexDigit;
+			for(int c = 'A'; c <= 'F'; ++c)
+				table[c] |= CharClass::HexDigit;
+
+			table['_'] |= CharClass::Ident;
+			table['\n'] |= CharClass::Newline;
+			table['\r'] |= CharClass::Newline;
+			table[' '] |= CharClass::Blank;
+			table['\t'] |= CharClass::Blank;
+			table['\v'] |= CharClass::Blank;
+			table['\f'] |= CharClass::Blank;
+
+			for(unsigned char c : "+-*/<>=!%()[]{},.;'\"#$")
+			{
+				if(c)
+					table[c] |= CharClass::Operator;
+			}
+
+			return table;
+		}
+
+		constexpr std::array<CharAction, 256> buildCharActionTable()
+		{
+			auto classes = buildCharClassTable();
+			std::array<CharAction, 256> table{};
+
+			for(int c = 0; c < 256; ++c)
+			{
+				auto cls = classes[c];
+				if(cls & CharClass::Digit)
+					table[c] = CharAction::Number;
+				//_ can start identifier too
+				else if(cls & CharClass::Ident)
+					table[c] = CharAction::Word;
+				else if(cls & CharClass::Newline)
+					table[c] = CharAction::Newline;
+				else if(cls & CharClass::Blank)
+					table[c] = CharAction::Blank;
+				else if(cls & CharClass::Operator)
+					table[c] = CharAction::Operator;
+				else
+					table[c] = CharAction::Unknown;
+			}
+
+			return table;
+		}
+
+		//operators that are always exactly one character long, Token::Type::Id for
+		//the rest, which need to look further ahead
+		constexpr std::array<Token::Type, 256> buildSingleCharTokenTable()
+		{
+			std::array<Token::Type, 256> table{};
+			for(auto& t : table)
+				t = Token::Type::Id;
+
+			table['('] = Token::Type::Operator_LPar;
+			table[')'] = Token::Type::Operator_RPar;
+			table['['] = Token::Type::Operator_LBPar;
+			table[']'] = Token::Type::Operator_RBPar;
+			table['{'] = Token::Type::Operator_LCPar;
+			table['}'] = Token::Type::Operator_RCPar;
+			table[','] = Token::Type::Operator_comma;
+			table['.'] = Token::Type::Operator_dot;
+			table[';'] = Token::Type::Operator_semi;
+
+			return table;
+		}
+	}
+
+	constexpr std::array<std::uint8_t, 256> charClassTable = detail::buildCharClassTable();
+	constexpr std::array<CharAction, 256> charActionTable = detail::buildCharActionTable();
+	constexpr std::array<Token::Type, 256> singleCharTokenTable = detail::buildSingleCharTokenTable();
+
+	//returns whether c belongs into any of the classes in cls
+	constexpr bool hasCharClass(char c, std::uint8_t cls)
+	{
+		return (charClassTable[static_cast<unsigned char>(c)] & cls) != 0;
+	}
+
+	constexpr CharAction charAction(char c)
+	{
+		return charActionTable[static_cast<unsigned char>(c)];
+	}
+
+	constexpr Token::Type singleCharToken(char c)
+	{
+		return singleCharTokenTable[static_cast<unsigned char>(c)];
+	}
+}
+
+#endif	//_JH_HEADER_CHARCLASS_
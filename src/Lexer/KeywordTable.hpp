@@ -0,0 +1,236 @@
+#ifndef _JH_HEADER_KEYWORDTABLE_
+#define _JH_HEADER_KEYWORDTABLE_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "../Core/Token.hpp"
+
+namespace jh{
+	struct KeywordEntry{
+		std::string_view spelling;
+		Token::Type type;
+	};
+
+	//every keyword and literal keyword the lexer recognizes when it runs into an identifier
+	//#if, #else, #elseif and #endif are not here, since they do not start with a letter
+	//and are handled separately by the lexer
+	constexpr KeywordEntry keywordTable[] = {
+		{ "null",				Token::Type::Literal_null },
+		{ "true",				Token::Type::Literal_bool_true },
+		{ "false",				Token::Type::Literal_bool_false },
+		{ "super",				Token::Type::Literal_super },
+		{ "this",				Token::Type::Literal_this },
+		{ "function",			Token::Type::Keyword_function },
+		{ "endfunction",		Token::Type::Keyword_endfunction },
+		{ "globals",			Token::Type::Keyword_globals },
+		{ "endglobals",			Token::Type::Keyword_endglobals },
+		{ "array",				Token::Type::Keyword_array },
+		{ "takes",				Token::Type::Keyword_takes },
+		{ "returns",			Token::Type::Keyword_returns },
+		{ "local",				Token::Type::Keyword_local },
+		{ "set",				Token::Type::Keyword_set },
+		{ "call",				Token::Type::Keyword_call },
+		{ "if",					Token::Type::Keyword_if },
+		{ "then",				Token::Type::Keyword_then },
+		{ "else",				Token::Type::Keyword_else },
+		{ "elseif",				Token::Type::Keyword_elseif },
+		{ "endif",				Token::Type::Keyword_endif },
+		{ "loop",				Token::Type::Keyword_loop },
+		{ "exitwhen",			Token::Type::Keyword_exitwhen },
+		{ "endloop",			Token::Type::Keyword_endloop },
+		{ "constant",			Token::Type::Keyword_constant },
+		{ "return",				Token::Type::Keyword_return },
+		{ "or",					Token::Type::Keyword_or },
+		{ "and",				Token::Type::Keyword_and },
+		{ "not",				Token::Type::Keyword_not },
+		{ "extends",			Token::Type::Keyword_extends },
+		{ "native",				Token::Type::Keyword_native },
+		{ "type",				Token::Type::Keyword_type },
+		{ "debug",				Token::Type::Keyword_debug },
+		{ "library",			Token::Type::Keyword_library },
+		{ "endlibrary",			Token::Type::Keyword_endlibrary },
+		{ "uses",				Token::Type::Keyword_uses },
+		{ "requires",			Token::Type::Keyword_requires },
+		{ "needs",				Token::Type::Keyword_needs },
+		{ "initializer",		Token::Type::Keyword_initializer },
+		{ "optional",			Token::Type::Keyword_optional },
+		{ "scope",				Token::Type::Keyword_scope },
+		{ "endscope",			Token::Type::Keyword_endscope },
+		{ "struct",				Token::Type::Keyword_struct },
+		{ "class",				Token::Type::Keyword_class },
+		{ "endstruct",			Token::Type::Keyword_endstruct },
+		{ "endclass",			Token::Type::Keyword_endclass },
+		{ "method",				Token::Type::Keyword_method },
+		{ "endmethod",			Token::Type::Keyword_endmethod },
+		{ "operator",			Token::Type::Keyword_operator },
+		{ "static",				Token::Type::Keyword_static },
+		{ "private",			Token::Type::Keyword_private },
+		{ "public",				Token::Type::Keyword_public },
+		{ "readonly",			Token::Type::Keyword_readonly },
+		{ "temporary",			Token::Type::Keyword_temporary },
+		{ "template",			Token::Type::Keyword_template },
+		{ "alias",				Token::Type::Keyword_alias },
+		{ "inline",				Token::Type::Keyword_inline },
+		{ "deprecated",			Token::Type::Keyword_deprecated },
+		{ "textmacro",			Token::Type::Keyword_textmacro },
+		{ "runtextmacro",		Token::Type::Keyword_runtextmacro },
+		{ "endtextmacro",		Token::Type::Keyword_endtextmacro },
+		{ "module",				Token::Type::Keyword_module },
+		{ "endmodule",			Token::Type::Keyword_endmodule },
+		{ "external",			Token::Type::Keyword_external },
+		{ "endexternal",		Token::Type::Keyword_endexternal },
+		{ "externalblock",		Token::Type::Keyword_externalblock },
+		{ "endexternalblock",	Token::Type::Keyword_endexternalblock },
+		{ "interface",			Token::Type::Keyword_interface },
+		{ "endinterface",		Token::Type::Keyword_endinterface },
+		{ "defaults",			Token::Type::Keyword_defaults },
+		{ "stub",				Token::Type::Keyword_stub },
+		{ "sizeof",				Token::Type::Keyword_sizeof },
+		{ "static_assert",		Token::Type::Keyword_static_assert },
+		{ "compiletime",		Token::Type::Keyword_compiletime },
+		{ "while",				Token::Type::Keyword_while },
+		{ "endwhile",			Token::Type::Keyword_endwhile },
+		{ "break",				Token::Type::Keyword_break },
+		{ "for",				Token::Type::Keyword_for },
+		{ "endfor",				Token::Type::Keyword_endfor },
+		{ "implement",			Token::Type::Keyword_implement },
+		{ "catch",				Token::Type::Keyword_catch },
+		{ "thistype",			Token::Type::Keyword_thistype },
+		{ "final",				Token::Type::Keyword_final },
+		{ "auto",				Token::Type::Keyword_auto },
+		{ "override",			Token::Type::Keyword_override },
+		{ "mutable",			Token::Type::Keyword_mutable },
+		{ "endblock",			Token::Type::Keyword_endblock },
+		{ "allocator",			Token::Type::Keyword_allocator },
+		{ "endallocator",		Token::Type::Keyword_endallocator },
+		{ "using",				Token::Type::Keyword_using },
+		{ "hook",				Token::Type::Keyword_hook },
+		{ "before",				Token::Type::Keyword_before },
+		{ "after",				Token::Type::Keyword_after },
+		{ "constructor",		Token::Type::Keyword_constructor },
+		{ "endconstructor",		Token::Type::Keyword_endconstructor },
+		{ "construct",			Token::Type::Keyword_construct },
+		{ "destructor",			Token::Type::Keyword_destructor },
+		{ "enddestructor",		Token::Type::Keyword_enddestructor },
+		{ "import",				Token::Type::Keyword_import },
+		{ "encrypted",			Token::Type::Keyword_encrypted },
+		{ "priority",			Token::Type::Keyword_priority },
+		{ "extendor",			Token::Type::Keyword_extendor },
+		{ "endextendor",		Token::Type::Keyword_endextendor },
+		{ "concept",			Token::Type::Keyword_concept },
+		{ "endconcept",			Token::Type::Keyword_endconcept },
+	};
+
+	constexpr std::size_t keywordCount = sizeof(keywordTable) / sizeof(keywordTable[0]);
+
+	//bump this whenever keywordTable or the way the lexer splits tokens changes, so
+	//anything that caches lexer output knows it has to throw its old data away
+	constexpr std::uint32_t keywordTableVersion = 2;
+
+	namespace detail{
+		//has to be power of two, the hash is masked into this range
+		//2048 slots for ~100 keywords makes collision-free seed easy to find at compile time
+		//and the whole slot table still fits into 2KB
+		constexpr std::size_t keywordSlotCount = 2048;
+
+		constexpr std::size_t keywordMinLength()
+		{
+			std::size_t result = keywordTable[0].spelling.size();
+			for(const auto& k : keywordTable)
+				result = k.spelling.size() < result ? k.spelling.size() : result;
+			return result;
+		}
+
+		constexpr std::size_t keywordMaxLength()
+		{
+			std::size_t result = 0;
+			for(const auto& k : keywordTable)
+				result = k.spelling.size() > result ? k.spelling.size() : result;
+			return result;
+		}
+
+		//FNV-1a with seed mixed in, finished with a shift so that the
+		//low bits(which we mask) depend on the whole word
+		constexpr std::uint32_t hashKeyword(const char* str, std::size_t length, std::uint32_t seed)
+		{
+			std::uint32_t h = 2166136261u ^ seed ^ static_cast<std::uint32_t>(length);
+			for(std::size_t i = 0; i < length; ++i)
+				h = (h ^ static_cast<unsigned char>(str[i])) * 16777619u;
+			return h ^ (h >> 13);
+		}
+
+		//slot table, stores index + 1 into keywordTable, 0 means empty slot
+		using KeywordSlots = std::array<std::uint8_t, keywordSlotCount>;
+
+		//returns true if every keyword landed into its own slot with given seed
+		constexpr bool tryKeywordSeed(std::uint32_t seed, KeywordSlots& slots)
+		{
+			for(auto& s : slots)
+				s = 0;
+
+			for(std::size_t i = 0; i < keywordCount; ++i)
+			{
+				const auto& k = keywordTable[i];
+				auto slot = hashKeyword(k.spelling.data(), k.spelling.size(), seed) & (keywordSlotCount - 1);
+				if(slots[slot])
+					return false;
+
+				slots[slot] = static_cast<std::uint8_t>(i + 1);
+			}
+
+			return true;
+		}
+
+		//walks seeds until the hash becomes perfect for keywordTable
+		//returns 0 if no seed was found, which is caught by static_assert below
+		constexpr std::uint32_t findKeywordSeed()
+		{
+			KeywordSlots slots{};
+			for(std::uint32_t seed = 1; seed < 4096; ++seed)
+			{
+				if(tryKeywordSeed(seed, slots))
+					return seed;
+			}
+
+			return 0;
+		}
+
+		constexpr KeywordSlots buildKeywordSlots(std::uint32_t seed)
+		{
+			KeywordSlots slots{};
+			tryKeywordSeed(seed, slots);
+			return slots;
+		}
+
+		constexpr std::size_t keywordShortest = keywordMinLength();
+		constexpr std::size_t keywordLongest = keywordMaxLength();
+		constexpr std::uint32_t keywordSeed = findKeywordSeed();
+		static_assert(keywordSeed != 0, "no perfect hash seed found for keywordTable");
+		static_assert(keywordCount < 255, "keyword slots store index + 1 in a byte");
+
+		constexpr KeywordSlots keywordSlots = buildKeywordSlots(keywordSeed);
+	}
+
+	//returns the keyword type of [str, str + length), or Token::Type::Id if it is not a keyword
+	//this is single hash, single probe and one comparison, no matter how many keywords there are
+	constexpr Token::Type findKeyword(const char* str, std::size_t length)
+	{
+		if(length < detail::keywordShortest || length > detail::keywordLongest)
+			return Token::Type::Id;
+
+		auto hash = detail::hashKeyword(str, length, detail::keywordSeed);
+		auto slot = detail::keywordSlots[hash & (detail::keywordSlotCount - 1)];
+		if(!slot)
+			return Token::Type::Id;
+
+		const auto& k = keywordTable[slot - 1];
+		if(k.spelling != std::string_view(str, length))
+			return Token::Type::Id;
+
+		return k.type;
+	}
+}
+
+#endif	//_JH_HEADER_KEYWORDTABLE_
@@ -1,8 +1,29 @@
 #include "Lexer.hpp"
+#include "KeywordTable.hpp"
+#include "CharClass.hpp"
+#include "Scanner.hpp"
+#include "../Preprocessor/Defines.hpp"
 #include <algorithm>
 
 namespace jh{
-	bool compareString(const std::string& input, size_t start, size_t end, const std::string& withWhat)
+	namespace{
+		//replaces list[from, to) by fresh, overwriting in place as far as possible
+		//so that the tail after it moves only once
+		template<class T>
+		void splice(std::vector<T>& list, size_t from, size_t to, const std::vector<T>& fresh)
+		{
+			size_t replaced = to - from;
+			size_t common = std::min(replaced, fresh.size());
+			std::copy(fresh.begin(), fresh.begin() + common, list.begin() + from);
+
+			if(replaced > common)
+				list.erase(list.begin() + from + common, list.begin() + to);
+			else
+				list.insert(list.begin() + from + common, fresh.begin() + common, fresh.end());
+		}
+	}
+
+	bool compareString(std::string_view input, size_t start, size_t end, std::string_view withWhat)
 	{
 		//if we are checking past end of input
 		//or the range we want to check is not exactly as long as argument provided
@@ -21,7 +42,7 @@ namespace jh{
 		return true;
 	}
 
-	size_t Lexer::getAfterNewline(const std::string& input, size_t startAt)
+	size_t Lexer::getAfterNewline(std::string_view input, size_t startAt)
 	{
 		//assert for out of range
 		if(startAt < 0 || startAt >= input.size())
@@ -46,34 +67,56 @@ namespace jh{
 
 	bool Lexer::_isNewline(char c)
 	{
-		return c == '\n' || c == '\r';
+		return hasCharClass(c, CharClass::Newline);
 	}
 
 	//returns position of first character after startAt inside input that returns
 	//true for isTokenStarting
-	size_t Lexer::getNextStartingPos(const std::string& input, size_t startAt)
+	size_t Lexer::getNextStartingPos(std::string_view input, size_t startAt)
 	{
 		size_t end = startAt;
 
-		while(end < input.size())
-		{
-			if(isTokenStarting(input[end]))
-				break;
-
+		while(end < input.size() && hasCharClass(input[end], CharClass::Ident))
 			++end;
-		}
 
 		return end;
 	}
 		
+	void Lexer::_addToken(Token::Type type, size_t position, size_t line, size_t length)
+	{
+#ifdef JH_LEXER_PROFILE
+		profile.countToken(type);
+#endif
+
+		if(stream)
+			stream->push(type, position, length);
+		else
+		{
+			tokens.emplace_back(type, position, line, length);
+
+			if(_keepsTokenData())
+				tokenData.push_back(_makeTokenData(type, position, length));
+		}
+	}
+
+	void Lexer::_addLines(size_t count, size_t resumeAt)
+	{
+		if(!count)
+			return;
+
+		currentLine += count;
+		if(stream)
+			stream->markLine(resumeAt, currentLine);
+	}
+
 	//add Id token with contents starting at startAt all the way to another valid token-starting
 	//character
-	int Lexer::addIdToken(const std::string& input, size_t startAt)
+	int Lexer::addIdToken(std::string_view input, size_t startAt)
 	{
 		auto end = getNextStartingPos(input, startAt);
 		auto distance = end - startAt;
 
-		tokens.emplace_back(Token::Type::Id, startAt, currentLine, distance);
+		_addToken(Token::Type::Id, startAt, currentLine, distance);
 
 		return end;
 	}
@@ -82,12 +125,12 @@ namespace jh{
 	bool Lexer::isTokenStarting(char c) const
 	{
 		//if it is not [0-9a-zA-Z_] it is potentially token starting
-		return !(isalnum(c) || c == '_');
+		return !hasCharClass(c, CharClass::Ident);
 	}
 
 	//returns the length of integer literal
 	//if it is not real literal, returns 0
-	int Lexer::_isIntegerLiteral(const std::string& input, size_t start, size_t end)
+	int Lexer::_isIntegerLiteral(std::string_view input, size_t start, size_t end)
 	{
 		//NOTE!
 		//rawcode literals are stored as separate tokens
@@ -103,14 +146,14 @@ namespace jh{
 		if(start >= input.size() || start >= end)
 			return 0;
 		else if(start == input.size() - 1)
-			return input[start] >= '0' && input[start] <= '9';
+			return hasCharClass(input[start], CharClass::Digit);
 
-		//get the real end, because 'end' can be std::string::npos
+		//get the real end, because 'end' can be std::string_view::npos
 		auto realEnd = std::min(input.size(), end);
-		bool isHex = tolower(input[start + 1]) == 'x';
+		bool isHex = input[start] == '0' && (input[start + 1] == 'x' || input[start + 1] == 'X');
 		bool isOct = input[start] == '0' && !isHex;
 
-		if(end == std::string::npos)
+		if(end == std::string_view::npos)
 		{
 			//relaxed check
 			//check if char is whitespace on every iteration
@@ -121,29 +164,24 @@ namespace jh{
 				//input[start] = 0, input[start + 1] = x/X, input[start + 2] = first char to check
 				for(int i = start + 2; i < realEnd; ++i)
 				{
-					char c = tolower(input[i]);
-					//if it is smaller than 0, or bigger than 9 but at the same time smaller than a, or
-					//bigger than f, it is not hexadecimal, so it is not integer literal
+					char c = input[i];
+					//if it is not [0-9a-fA-F], it is not hexadecimal, so it is not integer literal
 					if(isTokenStarting(c))
 						return i - start;
-					else if(c < '0' || (c > '9' && (c < 'a' || c > 'f')))
+					else if(!hasCharClass(c, CharClass::HexDigit))
 						return 0;
 				}
 			}
 			//it is potentially octal or decimal, check for that
 			else
 			{
-				int barrier = isOct ? 7 : 9;
+				auto digitClass = isOct ? CharClass::OctDigit : CharClass::Digit;
 				for(int i = start; i < realEnd; ++i)
 				{
-					//check the distance from input[start] to 0
-					int distance = input[i] - '0';
-					//if it is bigger than barrier or it is negative, it is not literal
-					//negative = lower ascii than '0'
-					//positive above barrier = either 8/9 inside octal, or invalid character inside decimal
+					//either 8/9 inside octal, or invalid character inside decimal
 					if(isTokenStarting(input[i]))
 						return i - start;
-					else if(distance > barrier || distance < 0)
+					else if(!hasCharClass(input[i], digitClass))
 						return 0;
 				}
 			}
@@ -159,25 +197,19 @@ namespace jh{
 				//input[start] = 0, input[start + 1] = x/X, input[start + 2] = first char to check
 				for(int i = start + 2; i < realEnd; ++i)
 				{
-					char c = tolower(input[i]);
-					//if it is smaller than 0, or bigger than 9 but at the same time smaller than a, or
-					//bigger than f, it is not hexadecimal, so it is not integer literal
-					if(c < '0' || (c > '9' && (c < 'a' || c > 'f')))
+					//if it is not [0-9a-fA-F], it is not hexadecimal, so it is not integer literal
+					if(!hasCharClass(input[i], CharClass::HexDigit))
 						return 0;
 				}
 			}
 			//it is potentially octal or decimal, check for that
 			else
 			{
-				int barrier = isOct ? 7 : 9;
+				auto digitClass = isOct ? CharClass::OctDigit : CharClass::Digit;
 				for(int i = start; i < realEnd; ++i)
 				{
-					//check the distance from input[start] to 0
-					int distance = input[i] - '0';
-					//if it is bigger than barrier or it is negative, it is not literal
-					//negative = lower ascii than '0'
-					//positive above barrier = either 8/9 inside octal, or invalid character inside decimal
-					if(distance > barrier || distance < 0)
+					//either 8/9 inside octal, or invalid character inside decimal
+					if(!hasCharClass(input[i], digitClass))
 						return 0;
 				}
 			}
@@ -189,7 +221,7 @@ namespace jh{
 
 	//returns the length of real literal
 	//if it is not real literal, returns 0
-	int Lexer::_isRealLiteral(const std::string& input, size_t start, size_t end)
+	int Lexer::_isRealLiteral(std::string_view input, size_t start, size_t end)
 	{
 		//valid real literals:	Double numbered(0.0), regex:	/[0-9]+\.[0-9]+/
 		//						before-numbered(0.),  regex:	/[0-9]+\./
@@ -202,14 +234,14 @@ namespace jh{
 		if(start >= input.size() || start >= end)
 			return 0;
 		else if(start == input.size() - 1)
-			return input[start] >= '0' && input[start] <= '9';
+			return hasCharClass(input[start], CharClass::Digit);
 
 		bool wasBefore = false;
 		bool wasAfter = false;
 		auto realEnd = std::min(input.size(), end);
-		decltype(realEnd) dotAt = std::string::npos;
+		decltype(realEnd) dotAt = std::string_view::npos;
 
-		if(end == std::string::npos)
+		if(end == std::string_view::npos)
 		{
 			//relaxed check, go to realEnd or next white space
 
@@ -231,7 +263,7 @@ namespace jh{
 				if(isTokenStarting(c))
 					return i - start;
 				//if it is not in range of [0, 9] it is not valid real literal number
-				else if(c < '0' || c > '9')
+				else if(!hasCharClass(c, CharClass::Digit))
 					return 0;
 			}
 
@@ -243,7 +275,7 @@ namespace jh{
 				//check before the for loop, to save some
 				//cpu work for the evaluation or branch prediction
 				//if we are right after dot, and there is something that is not number
-				if(input[i] < '0' || input[i] > '9')
+				if(i >= realEnd || !hasCharClass(input[i], CharClass::Digit))
 				{
 					//if there was something before
 					//it for sure is real literal
@@ -271,7 +303,7 @@ namespace jh{
 							return i - start;
 					}
 					//if it is not in range of [0, 9] it is not valid real literal
-					else if(c < '0' || c > '9')
+					else if(!hasCharClass(c, CharClass::Digit))
 						return 0;
 
 					//if we reach this point, there is at least one number after dot
@@ -298,7 +330,7 @@ namespace jh{
 					break;
 				}
 				//if it is not in range of [0, 9] it is not valid real literal number
-				else if(c < '0' || c > '9')
+				else if(!hasCharClass(c, CharClass::Digit))
 					return 0;
 			}
 
@@ -311,7 +343,7 @@ namespace jh{
 					char c = input[i];
 
 					//if it is not in range of [0, 9] it is not valid real literal
-					if(c < '0' || c > '9')
+					if(!hasCharClass(c, CharClass::Digit))
 						return 0;
 
 					//if we reach this point, there is at least one number after dot
@@ -326,138 +358,509 @@ namespace jh{
 			return 0;
 	}
 
-	std::pair<size_t, size_t> _narrowRange(const std::pair<size_t, size_t>& in,
-											const std::string& str, size_t startPos,
-											const std::vector<std::string>& keywords, size_t offset)
+	//returns position of * of the */ that closes block comment, scanning from startAt
+	//with matchCount blocks currently open, nested /* */ blocks are skipped over
+	size_t Lexer::_findCommentEnd(std::string_view input, size_t startAt, size_t& matchCount) const
+	{
+		//every candidate needs one more character after itself
+		const char* data = input.data();
+		const char* last = data + input.size() - 1;
+		const char* at = data + startAt;
+
+		while(at < last)
+		{
+			//nothing but * and / can change the nesting, so jump right to them
+			at = scan::findEither(at, last, '*', '/');
+			if(at == last)
+				break;
+
+			//if it is */, lower the number of nested comment blocks
+			if(at[0] == '*' && at[1] == '/')
+				--matchCount;
+			//if it is /*, increase the number of nested comment blocks
+			else if(at[0] == '/' && at[1] == '*')
+				++matchCount;
+
+			//if we found our end
+			if(!matchCount)
+				return at - data;
+
+			++at;
+		}
+
+		return std::string_view::npos;
+	}
+
+	//returns position where block comment, whose contents start at startAt, ends
+	//if the input ran out before the closing */
+	size_t Lexer::_unterminatedCommentEnd(std::string_view input, size_t startAt) const
+	{
+		//stop at the last character, unless it is the \n of \r\n, which is
+		//swallowed together with its \r
+		size_t end = input.size() - 1;
+		if(end > startAt && input[end - 1] == '\r' && input[end] == '\n')
+			end = input.size();
+
+		return std::max(end, startAt);
+	}
+
+	//returns position of " that closes string whose contents start at or before startAt
+	//or input.size() if there is none
+	size_t Lexer::_findStringEnd(std::string_view input, size_t startAt) const
 	{
-		std::pair<size_t, size_t> tRet{ -1, in.second };
+		size_t curPos = startAt;
 
-		for(auto i = in.first; i < in.second; ++i)
+		while(true)
 		{
-			//<=, because we will try to subscript array with offset
-			//not offset-1, so it needs to be at least size+1 long
-			//because of 0 based indexing
-			if(keywords[i].size() <= offset)
+			//jump straight to the next ", nothing else can end the string
+			curPos = scan::findChar(input.data() + curPos, input.data() + input.size(), '\"') - input.data();
+			if(curPos >= input.size())
+				return input.size();
+
+			//potentially end, but not if we find \", but end if we found \\"
+			//there is always the opening " before curPos, so curPos is at least 1
+			if(input[curPos - 1] != '\\' || (curPos > 2 && input[curPos - 2] == '\\'))
+				return curPos;
+
+			++curPos;
+		}
+	}
+
+	//single probe into compile-time perfect hash, see KeywordTable.hpp
+	Token::Type Lexer::_findKeyword(std::string_view what, size_t startingPos, size_t endPos) const
+	{
+#ifdef JH_LEXER_PROFILE
+		auto type = findKeyword(what.data() + startingPos, endPos - startingPos);
+
+		size_t length = endPos - startingPos;
+		++profile.keywordLookups;
+		profile.keywordProbes += length >= detail::keywordShortest && length <= detail::keywordLongest;
+		profile.keywordHits += type != Token::Type::Id;
+
+		return type;
+#else
+		return findKeyword(what.data() + startingPos, endPos - startingPos);
+#endif
+	}
+
+	Lexer::TokenList& Lexer::tokenize(std::string_view input)
+	{
+#ifdef JH_LEXER_PROFILE
+		LexerProfile::PhaseTimer timer(profile, LexerProfile::Phase::Tokenize);
+#endif
+
+		//first input into empty buffer, size it up front instead of growing it
+		if(tokens.empty())
+			reserveFor(input.size());
+
+		_tokenize(input);
+		return tokens;
+	}
+
+	TokenStream& Lexer::tokenize(std::string_view input, TokenStream& output)
+	{
+#ifdef JH_LEXER_PROFILE
+		LexerProfile::PhaseTimer timer(profile, LexerProfile::Phase::Tokenize);
+#endif
+
+		output.clear();
+		output.reserve(estimateTokenCount(input.size()));
+		output.markLine(0, currentLine);
+
+		stream = &output;
+		_tokenize(input);
+		stream = nullptr;
+
+		return output;
+	}
+
+	Lexer::TokenList& Lexer::retokenize(std::string_view newInput, size_t editStart, size_t removedLength, size_t insertedLength)
+	{
+#ifdef JH_LEXER_PROFILE
+		LexerProfile::PhaseTimer timer(profile, LexerProfile::Phase::Retokenize);
+#endif
+
+		size_t insertedEnd = editStart + insertedLength;
+		size_t oldEndLine = currentLine;
+
+		//edit that does not fit into the input, there is nothing to reuse
+		//neither is there with defines, the edit can change which branches are lexed
+		if(defines || insertedEnd > newInput.size() || newInput.size() - insertedLength + removedLength < editStart)
+		{
+			tokens.clear();
+			tokenData.clear();
+			literals.clear();
+			currentLine = 1;
+			_tokenize(newInput);
+			return tokens;
+		}
+
+		//restart after the last newline before the edit, the lexer is in fresh state there
+		//newline made of lone \r is only safe if the edit does not start right after it,
+		//since edit that inserts \n there would make it \r\n
+		size_t restartIndex = std::lower_bound(tokens.begin(), tokens.end(), editStart, [](const Token& token, size_t position){
+			return static_cast<size_t>(token.position) < position;
+		}) - tokens.begin();
+
+		size_t restartAt = 0;
+		currentLine = 1;
+		for(; restartIndex > 0; --restartIndex)
+		{
+			const auto& token = tokens[restartIndex - 1];
+			if(token.type != Token::Type::Operator_newline)
 				continue;
 
-			if(str[startPos] < keywords[i][offset])
+			size_t after = getAfterNewline(newInput, token.position);
+			if(after < editStart || (after == editStart && newInput[after - 1] == '\n'))
 			{
-				return { -1, -1 };
+				restartAt = after;
+				currentLine = token.line + 1;
+				break;
 			}
-			else if(str[startPos] == keywords[i][offset])
+		}
+
+		TokenList old = std::move(tokens);
+		tokens.clear();
+
+		std::vector<std::uint32_t> oldData = std::move(tokenData);
+		tokenData.clear();
+		source = newInput;
+
+		//lex until newline that lies past the edit lines up with newline of old tokens
+		std::ptrdiff_t shift = static_cast<std::ptrdiff_t>(insertedLength) - static_cast<std::ptrdiff_t>(removedLength);
+		size_t oldIndex = restartIndex;
+		size_t resyncIndex = old.size();
+		size_t curPos = restartAt;
+
+		while(curPos < newInput.size())
+		{
+			curPos = _lexStep(newInput, curPos);
+
+			if(tokens.empty() || tokens.back().type != Token::Type::Operator_newline)
+				continue;
+
+			size_t position = tokens.back().position;
+			if(position < insertedEnd)
+				continue;
+
+			size_t oldPosition = position - shift;
+			while(oldIndex < old.size() && static_cast<size_t>(old[oldIndex].position) < oldPosition)
+				++oldIndex;
+
+			if(oldIndex < old.size() && static_cast<size_t>(old[oldIndex].position) == oldPosition &&
+			   old[oldIndex].type == Token::Type::Operator_newline)
 			{
-				tRet.first = i;
+				resyncIndex = oldIndex;
 				break;
 			}
 		}
 
-		for(auto i = tRet.first + 1; i < in.second; ++i)
+		//splice relexed tokens in place of the old ones, and shift the rest
+		if(resyncIndex < old.size())
 		{
-			if(keywords[i].size() < offset || (keywords[i].size() >= offset &&
-												keywords[i][offset] != str[startPos]))
+			int lineShift = tokens.back().line - old[resyncIndex].line;
+
+			for(size_t i = resyncIndex + 1; i < old.size(); ++i)
 			{
-				tRet.second = i;
-				break;
+				old[i].position += static_cast<int>(shift);
+				old[i].line += lineShift;
 			}
+
+			splice(old, restartIndex, resyncIndex + 1, tokens);
+			if(_keepsTokenData())
+				splice(oldData, restartIndex, resyncIndex + 1, tokenData);
+
+			currentLine = oldEndLine + lineShift;
 		}
+		else
+		{
+			splice(old, restartIndex, old.size(), tokens);
+			if(_keepsTokenData())
+				splice(oldData, restartIndex, oldData.size(), tokenData);
+		}
+
+		tokens = std::move(old);
+		tokenData = std::move(oldData);
+		return tokens;
+	}
+
+	void Lexer::_tokenize(std::string_view input)
+	{
+		conditionals.clear();
+		directiveErrors.clear();
+
+		_tokenizeRange(input, 0, input.size());
+
+		//every #if still open ran into the end of input
+		for(const auto& conditional : conditionals)
+			directiveErrors.push_back(DirectiveError{ conditional.line, "#if without #endif" });
 
-		return tRet;
+		conditionals.clear();
 	}
 
-	//Im going to call this, Narrow search
-	//Returns the position of what inside keywords
-	//if a string starting at inWho is not inside keyword list, returns -1
-	size_t Lexer::_findKeyword(const std::string& inWho, size_t startingPos,
-								const Lexer::KeywordList& keywords)
+	size_t Lexer::_lexDirective(std::string_view input, Token::Type type, size_t wordEnd)
 	{
-		auto endPos = getNextStartingPos(inWho, startingPos);
-		std::pair<size_t, size_t> keywordsRange{ 0, keywords.size() };
+		size_t line = currentLine;
+		size_t lineEnd = scan::findEither(input.data() + wordEnd, input.data() + input.size(), '\n', '\r') - input.data();
 
-		auto realStart = startingPos;
+		//condition is the rest of the line, apart from comment
+		auto condition = input.substr(wordEnd, lineEnd - wordEnd);
+		condition = condition.substr(0, condition.find("//"));
+
+		auto evaluate = [&]{
+			bool value;
+			if(!defines->evaluate(condition, value))
+				directiveErrors.push_back(DirectiveError{ line, "invalid condition" });
+
+			return value;
+		};
+
+		bool skip = false;
+		bool toBranch = false;
+
+		if(type == Token::Type::Keyword_hashif)
+		{
+			bool value = evaluate();
+			conditionals.push_back(Conditional{ line, value, false });
 
-		auto iters = 0;
-		for(int i = 0; startingPos < endPos; ++startingPos, ++i)
+			skip = !value;
+			toBranch = true;
+		}
+		else if(conditionals.empty())
+		{
+			//stray directive is reported and the code after it is lexed
+			if(type == Token::Type::Keyword_hashelseif)
+				directiveErrors.push_back(DirectiveError{ line, "#elseif without #if" });
+			else if(type == Token::Type::Keyword_hashelse)
+				directiveErrors.push_back(DirectiveError{ line, "#else without #if" });
+			else
+				directiveErrors.push_back(DirectiveError{ line, "#endif without #if" });
+		}
+		else if(type == Token::Type::Keyword_hashendif)
+			conditionals.pop_back();
+		else
 		{
-			keywordsRange = _narrowRange(keywordsRange, inWho, startingPos, keywords, i);
-				
-			if(keywordsRange.first == -1)
-				return -1;
-			else if(std::abs(static_cast<int>(keywordsRange.first - keywordsRange.second)) == 1)
+			auto& conditional = conditionals.back();
+			if(conditional.sawElse)
 			{
-				//at this point, there is only one candidate, but it is not
-				//guaranteed to be it
-				//consider: contents of keywords: [a bb c], searching for: b
-				//would say it is equal to bb, because the distance is == 1
-				//so we need to additionally check for equality
-				if(compareString(inWho, realStart, endPos, keywords[keywordsRange.first]))
-					//if it is equal
-					return keywordsRange.first;
-				else
-					//if not so much
-					return -1;
+				directiveErrors.push_back(DirectiveError{ line, type == Token::Type::Keyword_hashelse ?
+					"#else after #else" : "#elseif after #else" });
+				skip = true;
 			}
+			else if(conditional.taken)
+			{
+				//branch before this one was lexed, so are none of the following
+				skip = true;
+			}
+			else if(type == Token::Type::Keyword_hashelseif)
+			{
+				conditional.taken = evaluate();
 
-			++iters;
+				skip = !conditional.taken;
+				toBranch = true;
+			}
+			else
+			{
+				conditional.taken = true;
+				conditional.sawElse = true;
+			}
 		}
 
-		//if we iterated over every char
-		if(iters == endPos - realStart &&
-			compareString(inWho, realStart, endPos, keywords[keywordsRange.first]))
+		//the newline ending directive is lexed as usual
+		if(!skip || lineEnd >= input.size())
+			return lineEnd;
+
+		_addToken(Token::Type::Operator_newline, lineEnd, currentLine);
+		return _skipDisabled(input, lineEnd, toBranch);
+	}
+
+	size_t Lexer::_skipDisabled(std::string_view input, size_t curPos, bool toBranch)
+	{
+		const char* data = input.data();
+		const char* end = data + input.size();
+
+		size_t depth = 0;
+		size_t lines = 0;
+
+		while(curPos < input.size())
 		{
-			//checking for one should be enough
-			//since if the first considerable is not completly equal, the rest
-			//wont be just as much
-			return keywordsRange.first;
-				
-			/*
-			//we go and check the whole remaining list
-			for(; keywordsRange.first < keywordsRange.second; ++keywordsRange.first)
+			curPos = getAfterNewline(input, curPos);
+			++lines;
+
+			size_t start = scan::skipBlanks(data + curPos, end) - data;
+			if(start < input.size() && input[start] == '#')
 			{
-				//if we find exact match, return it
-				if(compareString(inWho, realStart, endPos, keywords[keywordsRange.first]))
+				size_t wordEnd = getNextStartingPos(input, start + 1);
+
+				bool ends = compareString(input, start, wordEnd, "#endif");
+				bool branches = compareString(input, start, wordEnd, "#elseif") || compareString(input, start, wordEnd, "#else");
+
+				if(!depth && (ends || (toBranch && branches)))
 				{
-					return keywordsRange.first;
+					_addLines(lines, start);
+					return start;
 				}
-			}*/
+
+				if(compareString(input, start, wordEnd, "#if"))
+					++depth;
+				else if(ends)
+					--depth;
+
+				start = wordEnd;
+			}
+
+			curPos = scan::findEither(data + start, end, '\n', '\r') - data;
 		}
 
-		//fallback
-		return -1;
+		_addLines(lines, input.size());
+		return input.size();
 	}
 
-	//Keywords needs to be sorted for Narrow search to work properly
-	//otherwise, good bye code
-	Lexer::TokenList& Lexer::tokenize(const std::string& input,
-			const Lexer::KeywordList& keywords, const Lexer::TokenType& exampleTokens)
+	size_t Lexer::_tokenizeRange(std::string_view input, size_t from, size_t to)
 	{
-		size_t curPos = 0;
+		source = input;
+		size_t curPos = from;
 
-		while(curPos < input.size())
+		while(curPos < to)
+			curPos = _lexStep(input, curPos);
+
+		return curPos;
+	}
+
+	size_t Lexer::_lexStep(std::string_view input, size_t curPos)
+	{
+#ifdef JH_LEXER_PROFILE
+		auto branch = LexerProfile::classify(input, curPos);
+		size_t next = _lexToken(input, curPos);
+
+		//unterminated tokens step one past the end
+		profile.countStep(branch, std::min(next, input.size()) - curPos);
+		return next;
+#else
+		return _lexToken(input, curPos);
+#endif
+	}
+
+	size_t Lexer::_lexToken(std::string_view input, size_t curPos)
+	{
+		auto& c = input[curPos];
+
+		//classify the character through charActionTable instead of asking
+		//locale-dependent isalpha & co. for every byte
+		switch(charAction(c))
 		{
-			auto& c = input[curPos];
+			case CharAction::Word:
+			{
+				//find the end of the word only once, and use it for both keyword lookup
+				//and the Id token
+				auto end = getNextStartingPos(input, curPos);
+				auto type = _findKeyword(input, curPos, end);
+
+				if(type == Token::Type::Id)
+					_addToken(Token::Type::Id, curPos, currentLine, end - curPos);
+				else
+					_addToken(type, curPos, currentLine);
+
+				curPos = end;
+				break;
+			}
+
+			//if it is tab or space, do nothing with it, skip the whole run at once
+			case CharAction::Blank:
+			{
+				++curPos;
 
-			//if it is alphabetic, we can take this path, and optimize it a bit
-			if(isalpha(c))
+				//most blanks are single space between words, only use the bulk
+				//kernel when the run is longer(indentation, aligned columns)
+				if(curPos < input.size() && hasCharClass(input[curPos], CharClass::Blank))
+					curPos = scan::skipBlanks(input.data() + curPos, input.data() + input.size()) - input.data();
+
+				break;
+			}
+
+			case CharAction::Newline:
 			{
-				auto v = _findKeyword(input, curPos, keywords);
+				//push it, and calculate the offset
+				_addToken(Token::Type::Operator_newline, curPos, currentLine);
+				curPos = getAfterNewline(input, curPos);
 
-				if(v == -1)
+				_addLines(1, curPos);
+				break;
+			}
+
+			case CharAction::Number:
+			{
+				//either integer or real literal, or just Id
+				size_t length = _isIntegerLiteral(input, curPos);
+
+				if(length)
 				{
-					curPos = addIdToken(input, curPos);
+					size_t realLength = 0;
+					if(curPos + length < input.size() && input[curPos + length] == '.')
+						realLength = _isRealLiteral(input, curPos);
+
+					if(realLength)
+					{
+						//is real
+						length = realLength;
+						_addToken(Token::Type::Literal_real, curPos, currentLine, length);
+					}
+					else
+					{
+						//it is integer, or something like 0x1F. or 1.5a, in which case
+						//take just the integer part and let parser deal with the rest
+						_addToken(Token::Type::Literal_int, curPos, currentLine, length);
+					}
+
+					curPos += length;
 				}
 				else
 				{
-					tokens.emplace_back(exampleTokens[v], curPos, currentLine);
-					curPos = getNextStartingPos(input, curPos);
+					//it is Id, invalid, but let parser catch this
+					curPos = addIdToken(input, curPos);
 				}
+
+				break;
 			}
-			//otherwise, it is special token, do some
-			//less optimized(or more, depends on angle of view) checkings here
-			else
+
+			case CharAction::Unknown:
 			{
-				//possible token-characters
-				//< > = ! % ( ) [ ] { } + - * / , . ; : [numbers] [line-ending] ' " #
-				//basically everything that is not starting with letter
+				//character that can neither start nor continue any token, pack the whole
+				//run into single Id, invalid, but let parser catch this
+				auto end = curPos + 1;
+				while(end < input.size() && charAction(input[end]) == CharAction::Unknown)
+					++end;
+
+				_addToken(Token::Type::Id, curPos, currentLine, end - curPos);
+				curPos = end;
+				break;
+			}
+
+			case CharAction::Operator:
+			{
+				//real literal without digits before the dot, .5
+				if(c == '.' && curPos + 1 < input.size() && hasCharClass(input[curPos + 1], CharClass::Digit))
+				{
+					size_t length = _isRealLiteral(input, curPos);
+					if(length)
+					{
+						_addToken(Token::Type::Literal_real, curPos, currentLine, length);
+						curPos += length;
+						break;
+					}
+				}
+
+				//( ) [ ] { } , . ; are always single character, take them from table
+				auto single = singleCharToken(c);
+				if(single != Token::Type::Id)
+				{
+					_addToken(single, curPos, currentLine);
+					++curPos;
+					break;
+				}
+
+				//the rest can be multi-character tokens
+				//+ - * / < > = ! % ' " # $
 
 				//switch has potential to generate a jump table instead of
 				//what general chained if would generate
@@ -471,49 +874,32 @@ namespace jh{
 							if(input[curPos + 1] == '+')
 							{
 								//++
-								tokens.emplace_back(Token::Type::Operator_increment, curPos, currentLine);
+								_addToken(Token::Type::Operator_increment, curPos, currentLine);
 								curPos += 2;
 							}
 							else if(input[curPos + 1] == '=')
 							{
 								//+=
-								tokens.emplace_back(Token::Type::Operator_eqplus, curPos, currentLine);
+								_addToken(Token::Type::Operator_eqplus, curPos, currentLine);
 								curPos += 2;
 							}
 							else
 							{
 								//+
-								tokens.emplace_back(Token::Type::Operator_plus, curPos, currentLine);
+								_addToken(Token::Type::Operator_plus, curPos, currentLine);
 								++curPos;
 							}
 						}
 						else
 						{
 							//since this is last character of the input, it can only be +
-							tokens.emplace_back(Token::Type::Operator_plus, curPos, currentLine);
+							_addToken(Token::Type::Operator_plus, curPos, currentLine);
 							++curPos;
 						}
 
 						break;
 					}
 
-					case '\r':
-					case '\n':
-					{
-						//push it, and calculate the offset
-						tokens.emplace_back(Token::Type::Operator_newline, curPos, currentLine);
-						curPos = getAfterNewline(input, curPos);
-
-						++currentLine;
-						break;
-					}
-
-					//if it is tab or space, do nothing with it
-					case '\t':
-					case ' ':
-						++curPos;
-						break;
-
 					case '-':
 					{
 						//can be -, -- or -=
@@ -522,26 +908,26 @@ namespace jh{
 							if(input[curPos + 1] == '-')
 							{
 								//--
-								tokens.emplace_back(Token::Type::Operator_decrement, curPos, currentLine);
+								_addToken(Token::Type::Operator_decrement, curPos, currentLine);
 								curPos += 2;
 							}
 							else if(input[curPos + 1] == '=')
 							{
 								//-=
-								tokens.emplace_back(Token::Type::Operator_eqminus, curPos, currentLine);
+								_addToken(Token::Type::Operator_eqminus, curPos, currentLine);
 								curPos += 2;
 							}
 							else
 							{
 								//-
-								tokens.emplace_back(Token::Type::Operator_minus, curPos, currentLine);
+								_addToken(Token::Type::Operator_minus, curPos, currentLine);
 								++curPos;
 							}
 						}
 						else
 						{
 							//since this is last char of the input, it is for sure single -
-							tokens.emplace_back(Token::Type::Operator_minus, curPos, currentLine);
+							_addToken(Token::Type::Operator_minus, curPos, currentLine);
 							++curPos;
 						}
 
@@ -553,13 +939,13 @@ namespace jh{
 						if(curPos + 1 < input.size() && input[curPos + 1] == '=')
 						{
 							//*=
-							tokens.emplace_back(Token::Type::Operator_eqmultiply, curPos, currentLine);
+							_addToken(Token::Type::Operator_eqmultiply, curPos, currentLine);
 							curPos += 2;
 						}
 						else
 						{
 							//in here we are guaranteed it is single *
-							tokens.emplace_back(Token::Type::Operator_multiply, curPos, currentLine);
+							_addToken(Token::Type::Operator_multiply, curPos, currentLine);
 							++curPos;
 						}
 
@@ -575,37 +961,19 @@ namespace jh{
 							{
 								//to evade the current /*
 								curPos += 2;
-								size_t length = 0;
 								size_t starting = curPos;
 								size_t startingLine = currentLine;
 
 								size_t matchCount = 1;
+								curPos = _findCommentEnd(input, curPos, matchCount);
+								if(curPos == std::string_view::npos)
+									curPos = _unterminatedCommentEnd(input, starting);
 
-								//find matching */
-								while(curPos + 1 < input.size())
-								{
-									//if it is */, lower the number of nested comment blocks
-									if(input[curPos] == '*' && input[curPos + 1] == '/')
-										--matchCount;
-									//if it is /*, increase the number of nested comment blocks
-									else if(input[curPos] == '/' && input[curPos + 1] == '*')
-										++matchCount;
-
-									//if we found our end
-									if(!matchCount)
-										break;
-
-									if(_isNewline(input[curPos]))
-									{
-										++currentLine;
-										curPos = getAfterNewline(input, curPos);
-									}
-									else
-										++curPos;
-
-									//even if there is \r\n, consider it single line
-									++length;
-								}
+								//count the lines inside the whole block at once
+								//even if there is \r\n, consider it single line
+								auto breaks = scan::countLineBreaks(input.data() + starting, input.data() + curPos);
+								_addLines(breaks.lines, curPos);
+								size_t length = curPos - starting - breaks.crlf;
 
 								//because even with ++ it would still point to the /
 								//and on next iteration we would get Token::Type::Operator_divide
@@ -613,13 +981,13 @@ namespace jh{
 								curPos += 2;
 
 								//NOTE: Token::Type::Operator_dComment stores all its nested dComments too!
-								tokens.emplace_back(Token::Type::Operator_dComment,
+								_addToken(Token::Type::Operator_dComment,
 									starting, startingLine, length);
 							}
 							// /=
 							else if(input[curPos + 1] == '=')
 							{
-								tokens.emplace_back(Token::Type::Operator_eqdivide, curPos, currentLine);
+								_addToken(Token::Type::Operator_eqdivide, curPos, currentLine);
 								curPos += 2;
 							}
 							// //
@@ -629,39 +997,32 @@ namespace jh{
 								if(curPos + 2 < input.size() && input[curPos + 2] == '!')
 								{
 									curPos += 3;
-									size_t length = 0;
 									size_t starting = curPos;
 
-									while(curPos < input.size() && input[curPos] != '\n')
-									{
-										curPos++;
-										++length;
-									}
+									curPos = scan::findChar(input.data() + curPos, input.data() + input.size(), '\n') - input.data();
+									size_t length = curPos - starting;
 
-									tokens.emplace_back(Token::Type::Operator_preprocessor, starting,
+									_addToken(Token::Type::Operator_preprocessor, starting,
 										currentLine, length);
 								}
 								else
 								{
 									// //
-									while(curPos < input.size() && input[curPos] != '\n')
-									{
-										curPos++;
-									}
+									curPos = scan::findChar(input.data() + curPos, input.data() + input.size(), '\n') - input.data();
 
 									//do nothing here, since we dont have token for comment
 								}
 							}
 							else
 							{
-								tokens.emplace_back(Token::Type::Operator_divide, curPos, currentLine);
+								_addToken(Token::Type::Operator_divide, curPos, currentLine);
 								++curPos;
 							}
 						}
 						//last character in the file, probably invalid, but nevertheless tokenize it
 						else
 						{
-							tokens.emplace_back(Token::Type::Operator_divide, curPos, currentLine);
+							_addToken(Token::Type::Operator_divide, curPos, currentLine);
 							++curPos;
 						}
 
@@ -677,7 +1038,7 @@ namespace jh{
 							if(curPos + 2 < input.size() && input[curPos + 2] == '=')
 							{
 								//<<= for sure
-								tokens.emplace_back(Token::Type::Operator_eqlshift, curPos, currentLine);
+								_addToken(Token::Type::Operator_eqlshift, curPos, currentLine);
 
 								//evade the < and =, point to the next char
 								curPos += 3;
@@ -685,7 +1046,7 @@ namespace jh{
 							else
 							{
 								//<< for sure
-								tokens.emplace_back(Token::Type::Operator_lshift, curPos, currentLine);
+								_addToken(Token::Type::Operator_lshift, curPos, currentLine);
 
 								//evade < and point to next char
 								curPos += 2;
@@ -694,13 +1055,13 @@ namespace jh{
 						//<= for sure
 						else if(curPos + 1 < input.size() && input[curPos + 1] == '=')
 						{
-							tokens.emplace_back(Token::Type::Operator_lessequal, curPos, currentLine);
+							_addToken(Token::Type::Operator_lessequal, curPos, currentLine);
 							curPos += 2;
 						}
 						else
 						{
 							//< for sure
-							tokens.emplace_back(Token::Type::Operator_less, curPos, currentLine);
+							_addToken(Token::Type::Operator_less, curPos, currentLine);
 							++curPos;
 						}
 
@@ -716,7 +1077,7 @@ namespace jh{
 							if(curPos + 2 < input.size() && input[curPos + 2] == '=')
 							{
 								//>>= for sure
-								tokens.emplace_back(Token::Type::Operator_eqrshift, curPos, currentLine);
+								_addToken(Token::Type::Operator_eqrshift, curPos, currentLine);
 
 								//evade the > and =, point to the next char
 								curPos += 3;
@@ -724,7 +1085,7 @@ namespace jh{
 							else
 							{
 								//>> for sure
-								tokens.emplace_back(Token::Type::Operator_rshift, curPos, currentLine);
+								_addToken(Token::Type::Operator_rshift, curPos, currentLine);
 
 								//evade > and point to next char
 								curPos += 2;
@@ -733,13 +1094,13 @@ namespace jh{
 						//>=
 						else if(curPos + 1 < input.size() && input[curPos + 1] == '=')
 						{
-							tokens.emplace_back(Token::Type::Operator_biggerequal, curPos, currentLine);
+							_addToken(Token::Type::Operator_biggerequal, curPos, currentLine);
 							curPos += 2;
 						}
 						else
 						{
 							//> for sure
-							tokens.emplace_back(Token::Type::Operator_bigger, curPos, currentLine);
+							_addToken(Token::Type::Operator_bigger, curPos, currentLine);
 							++curPos;
 						}
 
@@ -752,13 +1113,13 @@ namespace jh{
 						if(curPos + 1 < input.size() && input[curPos + 1] == '=')
 						{
 							//==
-							tokens.emplace_back(Token::Type::Operator_equal, curPos, currentLine);
+							_addToken(Token::Type::Operator_equal, curPos, currentLine);
 							curPos += 2;
 						}
 						else
 						{
 							//=
-							tokens.emplace_back(Token::Type::Operator_assign, curPos, currentLine);
+							_addToken(Token::Type::Operator_assign, curPos, currentLine);
 							++curPos;
 						}
 
@@ -771,13 +1132,13 @@ namespace jh{
 						if(curPos + 1 < input.size() && input[curPos + 1] == '=')
 						{
 							//!=
-							tokens.emplace_back(Token::Type::Operator_notequal, curPos, currentLine);
+							_addToken(Token::Type::Operator_notequal, curPos, currentLine);
 							curPos += 2;
 						}
 						else
 						{
 							//! is exactly equal to not, so we can store that no problem
-							tokens.emplace_back(Token::Type::Keyword_not, curPos, currentLine);
+							_addToken(Token::Type::Keyword_not, curPos, currentLine);
 							++curPos;
 						}
 
@@ -790,125 +1151,34 @@ namespace jh{
 						if(curPos + 1 < input.size() && input[curPos + 1] == '=')
 						{
 							//%=
-							tokens.emplace_back(Token::Type::Operator_eqmodulo, curPos, currentLine);
+							_addToken(Token::Type::Operator_eqmodulo, curPos, currentLine);
 							curPos += 2;
 						}
 						else
 						{
 							//%
-							tokens.emplace_back(Token::Type::Operator_modulo, curPos, currentLine);
+							_addToken(Token::Type::Operator_modulo, curPos, currentLine);
 							++curPos;
 						}
 
 						break;
 					}
 
-					case '(':
-					{
-						//(
-						tokens.emplace_back(Token::Type::Operator_LPar, curPos, currentLine);
-						++curPos;
-
-						break;
-					}
-
-					case ')':
-					{
-						//)
-						tokens.emplace_back(Token::Type::Operator_RPar, curPos, currentLine);
-						++curPos;
-
-						break;
-					}
-
-					case '[':
-					{
-						//[
-						tokens.emplace_back(Token::Type::Operator_LBPar, curPos, currentLine);
-						++curPos;
-
-						break;
-					}
-
-					case ']':
-					{
-						//]
-						tokens.emplace_back(Token::Type::Operator_RBPar, curPos, currentLine);
-						++curPos;
-
-						break;
-					}
-
-					case '{':
-					{
-						//{
-						tokens.emplace_back(Token::Type::Operator_LCPar, curPos, currentLine);
-						++curPos;
-
-						break;
-					}
-
-					case '}':
-					{
-						//}
-						tokens.emplace_back(Token::Type::Operator_RCPar, curPos, currentLine);
-						++curPos;
-
-						break;
-					}
-
-					case ',':
-					{
-						//,
-						tokens.emplace_back(Token::Type::Operator_comma, curPos, currentLine);
-						++curPos;
-
-						break;
-					}
-
-					case '.':
-					{
-						//.
-						tokens.emplace_back(Token::Type::Operator_dot, curPos, currentLine);
-						++curPos;
-
-						break;
-					}
-
-					case ';':
-					{
-						//;
-						tokens.emplace_back(Token::Type::Operator_semi, curPos, currentLine);
-						++curPos;
-
-						break;
-					}
-
 					case '\'':
 					{
 						//'
 						++curPos;
-						size_t length = 0;
 						size_t starting = curPos;
 						size_t startingLine = currentLine;
 
-						while(curPos < input.size() && input[curPos] != '\'')
-						{
-							if(_isNewline(input[curPos]))
-							{
-								++currentLine;
-								curPos = getAfterNewline(input, curPos);
-							}
-							else
-							{
-								++curPos;
-							}
-								
-							//even tho it could be \r\n, still consider it as one char
-							++length;
-						}
+						curPos = scan::findChar(input.data() + curPos, input.data() + input.size(), '\'') - input.data();
 
-						tokens.emplace_back(Token::Type::Operator_rawcode, starting, startingLine, length);
+						//even tho it could be \r\n, still consider it as one char
+						auto breaks = scan::countLineBreaks(input.data() + starting, input.data() + curPos);
+						_addLines(breaks.lines, curPos);
+						size_t length = curPos - starting - breaks.crlf;
+
+						_addToken(Token::Type::Operator_rawcode, starting, startingLine, length);
 						++curPos;
 
 						break;
@@ -918,49 +1188,17 @@ namespace jh{
 					{
 						//"
 						++curPos;
-						size_t length = 0;
 						size_t starting = curPos;
 						size_t startingLine = currentLine;
 
-						while(curPos < input.size())
-						{
-							//potentially end, but not if we find \", but end if we found \\"
-							if(input[curPos] == '\"')
-							{
-								if(curPos > 2)
-								{
-									//if it has both \\, or the one last char is not \, it is
-									//for sure end
-									if(input[curPos - 1] == '\\' && input[curPos - 2] == '\\' ||
-										input[curPos - 1] != '\\')
-										break;
-								}
-								//thanks to ++curPos in the beginning of this branch
-								//we are guaranteed to have curPos at least 1
-								else
-								{
-									//if the preceeding character is not \, we know this
-									//is the end of the string for us
-									if(input[curPos - 1] != '\\')
-										break;
-								}
-							}
-
-							if(_isNewline(input[curPos]))
-							{
-								++currentLine;
-								curPos = getAfterNewline(input, curPos);
-							}
-							else
-							{
-								++curPos;
-							}
+						curPos = _findStringEnd(input, curPos);
 
-							//even tho it could be \r\n, still consider it as one char
-							++length;
-						}
+						//even tho it could be \r\n, still consider it as one char
+						auto breaks = scan::countLineBreaks(input.data() + starting, input.data() + curPos);
+						_addLines(breaks.lines, curPos);
+						size_t length = curPos - starting - breaks.crlf;
 
-						tokens.emplace_back(Token::Type::Operator_string, starting, startingLine, length);
+						_addToken(Token::Type::Operator_string, starting, startingLine, length);
 						++curPos;
 
 						break;
@@ -968,35 +1206,31 @@ namespace jh{
 
 					case '#':
 					{
-						//#
-						if(compareString(input, curPos, curPos + 3, "#if"))
-						{
-							//#if
-							tokens.emplace_back(Token::Type::Keyword_hashif, curPos, currentLine);
-							curPos += 3;
-						}
-						else if(compareString(input, curPos, curPos + 5, "#else"))
-						{
-							//#else
-							tokens.emplace_back(Token::Type::Keyword_hashelse, curPos, currentLine);
-							curPos += 5;
-						}
-						else if(compareString(input, curPos, curPos + 7, "#elseif"))
-						{
-							//#elseif
-							tokens.emplace_back(Token::Type::Keyword_hashelseif, curPos, currentLine);
-							curPos += 7;
-						}
-						else if(compareString(input, curPos, curPos + 6, "#endif"))
+						//the # itself is not identifier character, so the word starts after it
+						auto end = getNextStartingPos(input, curPos + 1);
+						auto type = Token::Type::Id;
+
+						if(compareString(input, curPos, end, "#if"))
+							type = Token::Type::Keyword_hashif;
+						else if(compareString(input, curPos, end, "#elseif"))
+							type = Token::Type::Keyword_hashelseif;
+						else if(compareString(input, curPos, end, "#else"))
+							type = Token::Type::Keyword_hashelse;
+						else if(compareString(input, curPos, end, "#endif"))
+							type = Token::Type::Keyword_hashendif;
+
+						if(type == Token::Type::Id)
 						{
-							//#endif
-							tokens.emplace_back(Token::Type::Keyword_hashendif, curPos, currentLine);
-							curPos += 6;
+							//invalid token, but let parser catch this
+							_addToken(Token::Type::Id, curPos, currentLine, end - curPos);
+							curPos = end;
 						}
+						else if(defines)
+							curPos = _lexDirective(input, type, end);
 						else
 						{
-							//invalid token, but let parser catch this
-							curPos = addIdToken(input, curPos);
+							_addToken(type, curPos, currentLine);
+							curPos = end;
 						}
 
 						break;
@@ -1008,61 +1242,130 @@ namespace jh{
 						curPos++;
 						size_t starting = curPos;
 						size_t startingLine = currentLine;
-						size_t length = 0;
-						while(curPos < input.size() && input[curPos] != '$')
-						{
-							if(_isNewline(input[curPos]))
-							{
-								++currentLine;
-								curPos = getAfterNewline(input, curPos);
-							}
-							else
-							{
-								++curPos;
-							}
 
-							//even tho it could be \r\n, still consider it as one char
-							++length;
-						}
+						curPos = scan::findChar(input.data() + curPos, input.data() + input.size(), '$') - input.data();
+
+						//even tho it could be \r\n, still consider it as one char
+						auto breaks = scan::countLineBreaks(input.data() + starting, input.data() + curPos);
+						_addLines(breaks.lines, curPos);
+						size_t length = curPos - starting - breaks.crlf;
 
 						++curPos;
-						tokens.emplace_back(Token::Type::Operator_textmacroarg,
+						_addToken(Token::Type::Operator_textmacroarg,
 							starting, startingLine, length);
+
+						break;
 					}
+				}
 
-					default:
-					{
-						//either integer or real literal, or just Id
-						size_t length = _isIntegerLiteral(input, curPos);
+				break;
+			}
+		}
 
-						if(length)
-						{
-							if(curPos + length < input.size() && input[curPos + length] == '.')
-							{
-								//is real
-								length = _isRealLiteral(input, curPos);
-								tokens.emplace_back(Token::Type::Literal_real, curPos, currentLine, length);
-							}
-							else
-							{
-								//it is integer
-								tokens.emplace_back(Token::Type::Literal_int, curPos, currentLine, length);
-							}
+		return curPos;
+	}
 
-							curPos += length;
-						}
-						else
-						{
-							//it is Id, invalid, but let parser catch this
-							curPos = addIdToken(input, curPos);
-						}
-					}
-				}
+	void Lexer::reset()
+	{
+		tokens.clear();
+		tokenData.clear();
+		literals.clear();
+		currentLine = 1;
+		conditionals.clear();
+		directiveErrors.clear();
+	}
+
+	void Lexer::reserveFor(size_t inputSize)
+	{
+		tokens.reserve(tokens.size() + estimateTokenCount(inputSize));
+		if(_keepsTokenData())
+			tokenData.reserve(tokens.capacity());
+	}
+
+	void Lexer::setInterner(Interner* identifiers)
+	{
+		interner = identifiers;
+	}
+
+	bool Lexer::_keepsTokenData() const
+	{
+		return interner || decodeLiterals;
+	}
+
+	std::uint32_t Lexer::_makeTokenData(Token::Type type, size_t position, size_t length)
+	{
+		auto text = source.substr(position, length);
+
+		switch(type)
+		{
+			case Token::Type::Id:
+				return interner ? interner->intern(text) : noTokenData;
+
+			case Token::Type::Literal_int:
+			case Token::Type::Literal_real:
+			case Token::Type::Operator_rawcode:
+			{
+				if(!decodeLiterals)
+					return noTokenData;
+
+				if(type == Token::Type::Literal_int)
+					literals.push_back(decodeInteger(text));
+				else if(type == Token::Type::Literal_real)
+					literals.push_back(decodeReal(text));
+				else
+					literals.push_back(decodeRawcode(text));
+
+				return static_cast<std::uint32_t>(literals.size() - 1);
 			}
+
+			default:
+				return noTokenData;
 		}
+	}
 
-		return tokens;
+	void Lexer::setDefines(const Defines* conditionDefines)
+	{
+		defines = conditionDefines;
+	}
+
+	const std::vector<Lexer::DirectiveError>& Lexer::getDirectiveErrors() const
+	{
+		return directiveErrors;
+	}
+
+	void Lexer::setDecodeLiterals(bool decode)
+	{
+		decodeLiterals = decode;
+	}
+
+	const std::vector<LiteralValue>& Lexer::getLiterals() const
+	{
+		return literals;
+	}
+
+	const std::vector<std::uint32_t>& Lexer::getTokenData() const
+	{
+		return tokenData;
+	}
+
+	size_t Lexer::estimateTokenCount(size_t inputSize)
+	{
+		//code averages 5 to 8 bytes per token, comments and strings make it more,
+		//so this rarely needs to grow and does not overshoot much for commented code
+		return inputSize / 8 + 16;
+	}
+
+#ifdef JH_LEXER_PROFILE
+	const LexerProfile& Lexer::getProfile() const
+	{
+		return profile;
+	}
+
+	void Lexer::resetProfile()
+	{
+		profile.reset();
 	}
+#endif
 
 	const Lexer::TokenList& Lexer::getTokens() const
 	{
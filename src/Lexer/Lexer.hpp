@@ -1,26 +1,120 @@
 #ifndef _JH_HEADER_LEXER_
 #define _JH_HEADER_LEXER_
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
+#include "../Core/Interner.hpp"
 #include "../Core/Token.hpp"
+#include "LiteralDecoder.hpp"
+#include "TokenStream.hpp"
+
+#ifdef JH_LEXER_PROFILE
+	#include "LexerProfile.hpp"
+#endif
 
 namespace jh{
+	class Defines;
+
 	//end should always be one higher than the last character we want to check
-	bool compareString(const std::string& input, size_t start, size_t end, const std::string& withWhat);
+	bool compareString(std::string_view input, size_t start, size_t end, std::string_view withWhat);
 
 	class Lexer{
+		//lexes chunked input by driving _lexToken and the scanning helpers directly
+		friend class StreamLexer;
+
+		//lexes ranges of single input on separate Lexers through _tokenizeRange
+		friend class ParallelLexer;
+
+		//measures the private helpers on their own, see bench/LexerBenchmark.cpp
+		friend struct LexerBenchmark;
 	public:
 		using TokenList = std::vector<Token>;
-		using IdPair = std::pair<size_t, size_t>;
-		using KeywordList = std::vector<std::string>;
-		using TokenType = std::vector<Token::Type>;
+
+		//problem with #if, #elseif, #else or #endif found while lexing with defines
+		struct DirectiveError{
+			size_t line;
+			const char* message;
+		};
 	private:
+		//#if whose #endif was not reached yet
+		struct Conditional{
+			size_t line;
+
+			//one of the branches was lexed, the rest is skipped
+			bool taken;
+			bool sawElse;
+		};
+
 		TokenList tokens;
 		size_t currentLine = 1;
 
+		//one entry per token in tokens when _keepsTokenData(), see getTokenData
+		std::vector<std::uint32_t> tokenData;
+
+		//when set, Id tokens are interned into it
+		Interner* interner = nullptr;
+
+		//values of literal tokens, when decodeLiterals is set
+		std::vector<LiteralValue> literals;
+		bool decodeLiterals = false;
+
+		//input being lexed, for the text of Id tokens
+		std::string_view source;
+
+		//when set, tokens go into this compact stream instead of tokens
+		TokenStream* stream = nullptr;
+
+		//when set, conditional directives are evaluated instead of being lexed as tokens
+		const Defines* defines = nullptr;
+		std::vector<Conditional> conditionals;
+		std::vector<DirectiveError> directiveErrors;
+
+#ifdef JH_LEXER_PROFILE
+		//mutable, since const lookups like _findKeyword count too
+		mutable LexerProfile profile;
+#endif
+
+		//returns whether tokenData is filled alongside tokens
+		bool _keepsTokenData() const;
+
+		//returns tokenData entry for token, interning or decoding its text
+		std::uint32_t _makeTokenData(Token::Type type, size_t position, size_t length);
+
+		//appends token into whichever output is active
+		void _addToken(Token::Type type, size_t position, size_t line, size_t length = 0);
+
+		//moves currentLine forward by count lines, resumeAt is the position
+		//where lexing continues on the new line
+		void _addLines(size_t count, size_t resumeAt);
+
+		//the lexing loop shared by both tokenize overloads
+		void _tokenize(std::string_view input);
+
+		//lexes tokens starting at from until a token ends at or past to, positions are
+		//still relative to whole input, so the last token can run past to
+		//returns position where the last token ended
+		size_t _tokenizeRange(std::string_view input, size_t from, size_t to);
+
+		//handles directive of given type, whose word ends at wordEnd, when lexing with
+		//defines, returns position where lexing continues
+		size_t _lexDirective(std::string_view input, Token::Type type, size_t wordEnd);
+
+		//skips disabled code starting at newline at curPos, up to the # of the #endif
+		//closing it, or of #elseif or #else on the same level if toBranch is set
+		//the code is not lexed, only lines starting by a directive are looked at
+		size_t _skipDisabled(std::string_view input, size_t curPos, bool toBranch);
+
+		//lexes single token(or run of blanks, or comment) starting at curPos,
+		//returns position right after it
+		size_t _lexToken(std::string_view input, size_t curPos);
+
+		//_lexToken as called by the lexing loops, counts the step when profiling
+		size_t _lexStep(std::string_view input, size_t curPos);
+
 		//returns the position after evading complete newline(1 and only 1)
-		size_t getAfterNewline(const std::string& input, size_t startAt);
+		size_t getAfterNewline(std::string_view input, size_t startAt);
 
 		//returns whether given char is considered new line or not
 		bool _isNewline(char c);
@@ -30,41 +124,56 @@ namespace jh{
 
 		//returns position of first character after startAt inside input that returns
 		//true for isTokenStarting
-		size_t getNextStartingPos(const std::string& input, size_t startAt);
+		size_t getNextStartingPos(std::string_view input, size_t startAt);
 
 		//add Id token with contents starting at startAt all the way to another valid token-starting
 		//character
-		int addIdToken(const std::string& input, size_t startAt);
+		int addIdToken(std::string_view input, size_t startAt);
 
 		/*
 		Checks whether input at [start, end-1] is integer literal(not rawcode,
 		this is stored separately)(end should be one bigger than last character we want to check)
 
-		If end == std::string::npos, checks until a white space is found, otherwise
+		If end == std::string_view::npos, checks until a white space is found, otherwise
 		checks the range strictly
 
 		Returns the length of given integer literal, so 0 if it is not
 		*/
-		int _isIntegerLiteral(const std::string& input, size_t start, size_t end = std::string::npos);
+		int _isIntegerLiteral(std::string_view input, size_t start, size_t end = std::string_view::npos);
 
 		/*
 		Checks whether input at [start, end-1] is real literal(end should be one bigger than
 		last character we want to check)
 
-		If end == std::string::npos, checks until a white space is found,
+		If end == std::string_view::npos, checks until a white space is found,
 		otherwise checks the range strictly
 
 		Returns the length of given integer literal, so 0 if it is not
 
 		Every integer literal is also real literal
 		*/
-		int _isRealLiteral(const std::string& input, size_t start, size_t end = std::string::npos);
+		int _isRealLiteral(std::string_view input, size_t start, size_t end = std::string_view::npos);
+
+		//returns position of the * in */ that closes block comment, scanning from startAt with
+		//matchCount comments currently open, nested comments are skipped
+		//returns std::string_view::npos if the input ran out first, matchCount is then
+		//the nesting at input.size() - 1, which is the first position not checked yet
+		size_t _findCommentEnd(std::string_view input, size_t startAt, size_t& matchCount) const;
+
+		//returns position where unterminated block comment whose contents start at startAt ends
+		size_t _unterminatedCommentEnd(std::string_view input, size_t startAt) const;
 
-		//finds substring of what starting at startingPos up to next token separating
-		//character inside keywords
-		size_t _findKeyword(const std::string& what, size_t startingPos,
-							const Lexer::KeywordList& keywords);
+		//returns position of " that ends string, scanning from startAt, input.size() if there is none
+		//escapes are checked by looking back up to 2 characters
+		size_t _findStringEnd(std::string_view input, size_t startAt) const;
+
+		//returns the keyword type of identifier stored in what at [startingPos, endPos - 1]
+		//or Token::Type::Id if the identifier is not a keyword
+		Token::Type _findKeyword(std::string_view what, size_t startingPos, size_t endPos) const;
 	public:
+		//tokenData entry of tokens that have no data
+		static constexpr std::uint32_t noTokenData = 0xFFFFFFFF;
+
 		//default constructor for Lexer
 		Lexer() = default;
 
@@ -76,14 +185,80 @@ namespace jh{
 		Lexer& operator=(Lexer&&) = delete;
 
 		//tokenize given input
+		//input is only viewed, tokens refer to positions inside it, so it can as well
+		//be memory mapped file(see SourceFile) or any other buffer without copying it
 		//result is stored inside internal memory buffer, and after tokenizing is also returned
-		TokenList& tokenize(const std::string& input,
-							const KeywordList& keywords,
-							const Lexer::TokenType& exampleTokens);
+		//keywords are recognized using built-in keywordTable(see KeywordTable.hpp)
+		TokenList& tokenize(std::string_view input);
+
+		//tokenize given input into compact structure-of-arrays stream
+		//output is cleared first, internal memory buffer is not touched
+		TokenStream& tokenize(std::string_view input, TokenStream& output);
+
+		/*
+		Re-lexes input after an edit, reusing tokens of the internal memory buffer
+
+		The buffer has to hold the result of tokenize of the whole input before the edit.
+		The edit replaced removedLength bytes at editStart by insertedLength bytes, and
+		newInput is the whole input after it.
+
+		Lexing restarts right after the last newline before the edit, and stops at the
+		first newline past the edit that the old tokens also have a newline at. Tokens
+		after it are kept, with position and line shifted. The result is the same as
+		tokenize of newInput from scratch would give.
+		*/
+		TokenList& retokenize(std::string_view newInput, size_t editStart, size_t removedLength, size_t insertedLength);
+
+		//clears tokens and line counter, so that the same Lexer can lex another input
+		//allocated memory is kept, so lexing many files with one Lexer stops allocating
+		//once it has seen the biggest one
+		void reset();
+
+		//reserves memory buffer for tokens of input of given size
+		void reserveFor(size_t inputSize);
+
+		//estimates how many tokens input of given size has, from average token density
+		//of scripts, rather more than less
+		static size_t estimateTokenCount(size_t inputSize);
 
 		//returns constant reference to the underlying memory buffer which holds
 		//all so far parsed tokens
 		const TokenList& getTokens() const;
+
+		//interns every Id token into given table while lexing into the internal buffer,
+		//nullptr turns it off
+		//the table has to outlive lexing, and is not used for TokenStream output
+		void setInterner(Interner* identifiers);
+
+		//decodes values of Literal_int, Literal_real and Operator_rawcode tokens while
+		//lexing into the internal buffer, see getLiterals
+		void setDecodeLiterals(bool decode);
+
+		//evaluates #if, #elseif, #else and #endif against given defines while lexing, code
+		//in disabled branches is skipped without being lexed, nullptr turns it off, in
+		//which case they are lexed as tokens
+		//directives are not tokens with defines set, only the newline ending them is
+		//the defines have to outlive lexing, ParallelLexer and StreamLexer do not use them
+		void setDefines(const Defines* conditionDefines);
+
+		//returns problems with directives found by the last tokenize with defines
+		const std::vector<DirectiveError>& getDirectiveErrors() const;
+
+		//returns per-token data, parallel to getTokens(), empty if nothing is collected
+		//for Id tokens it is the symbol in the interner, for literal tokens index into
+		//getLiterals(), noTokenData for the other tokens(or when that is not collected)
+		const std::vector<std::uint32_t>& getTokenData() const;
+
+		//returns decoded literal values, indexed from getTokenData()
+		//retokenize appends values of relexed literals, the replaced ones stay unused
+		const std::vector<LiteralValue>& getLiterals() const;
+
+#ifdef JH_LEXER_PROFILE
+		//returns counters collected since construction or last resetProfile
+		const LexerProfile& getProfile() const;
+
+		void resetProfile();
+#endif
 	};
 }
 
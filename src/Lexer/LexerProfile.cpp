@@ -0,0 +1,194 @@
+#include "LexerProfile.hpp"
+#include "CharClass.hpp"
+#include "TokenName.hpp"
+#include <cstdio>
+
+namespace jh{
+	namespace{
+		//names of tokens are plain text, only quotes and backslashes need escaping
+		void appendJsonString(std::string& out, const char* text)
+		{
+			out += '\"';
+			for(; *text; ++text)
+			{
+				if(*text == '\"' || *text == '\\')
+					out += '\\';
+
+				out += *text;
+			}
+
+			out += '\"';
+		}
+
+		void appendNumber(std::string& out, std::uint64_t value)
+		{
+			out += std::to_string(value);
+		}
+
+		void appendNumber(std::string& out, double value)
+		{
+			char buffer[32];
+			std::snprintf(buffer, sizeof(buffer), "%.9f", value);
+			out += buffer;
+		}
+	}
+
+	LexerProfile::Branch LexerProfile::classify(std::string_view input, size_t at)
+	{
+		char c = input[at];
+		char next = at + 1 < input.size() ? input[at + 1] : '\0';
+
+		switch(charAction(c))
+		{
+			case CharAction::Word: return Branch::Word;
+			case CharAction::Number: return Branch::Number;
+			case CharAction::Blank: return Branch::Blank;
+			case CharAction::Newline: return Branch::Newline;
+			case CharAction::Unknown: return Branch::Unknown;
+			case CharAction::Operator: break;
+		}
+
+		switch(c)
+		{
+			case '/':
+				if(next == '*')
+					return Branch::BlockComment;
+
+				if(next == '/')
+					return at + 2 < input.size() && input[at + 2] == '!' ? Branch::Preprocessor : Branch::LineComment;
+
+				return Branch::Operator;
+
+			case '\"': return Branch::String;
+			case '\'': return Branch::Rawcode;
+			case '$': return Branch::TextmacroArg;
+			case '#': return Branch::Directive;
+			default: return Branch::Operator;
+		}
+	}
+
+	const char* LexerProfile::branchName(Branch branch)
+	{
+		switch(branch)
+		{
+			case Branch::Word: return "word";
+			case Branch::Number: return "number";
+			case Branch::Blank: return "blank";
+			case Branch::Newline: return "newline";
+			case Branch::BlockComment: return "block_comment";
+			case Branch::LineComment: return "line_comment";
+			case Branch::Preprocessor: return "preprocessor";
+			case Branch::String: return "string";
+			case Branch::Rawcode: return "rawcode";
+			case Branch::TextmacroArg: return "textmacro_arg";
+			case Branch::Directive: return "directive";
+			case Branch::Operator: return "operator";
+			case Branch::Unknown: return "unknown";
+			case Branch::Count: break;
+		}
+
+		return "invalid";
+	}
+
+	const char* LexerProfile::phaseName(Phase phase)
+	{
+		switch(phase)
+		{
+			case Phase::Tokenize: return "tokenize";
+			case Phase::Retokenize: return "retokenize";
+			case Phase::Count: break;
+		}
+
+		return "invalid";
+	}
+
+	void LexerProfile::reset()
+	{
+		*this = LexerProfile();
+	}
+
+	void LexerProfile::merge(const LexerProfile& other)
+	{
+		for(size_t i = 0; i < tokens.size(); ++i)
+			tokens[i] += other.tokens[i];
+
+		for(size_t i = 0; i < branchCount; ++i)
+		{
+			branchSteps[i] += other.branchSteps[i];
+			branchBytes[i] += other.branchBytes[i];
+		}
+
+		keywordLookups += other.keywordLookups;
+		keywordProbes += other.keywordProbes;
+		keywordHits += other.keywordHits;
+
+		for(size_t i = 0; i < phaseCount; ++i)
+		{
+			phaseSeconds[i] += other.phaseSeconds[i];
+			phaseRuns[i] += other.phaseRuns[i];
+		}
+	}
+
+	std::string LexerProfile::toJson() const
+	{
+		std::string out = "{\n\t\"tokens\": {";
+
+		bool first = true;
+		for(size_t i = 0; i < tokens.size(); ++i)
+		{
+			if(!tokens[i])
+				continue;
+
+			out += first ? "\n\t\t" : ",\n\t\t";
+			appendJsonString(out, tokenTypeName(static_cast<Token::Type>(i)));
+			out += ": ";
+			appendNumber(out, tokens[i]);
+			first = false;
+		}
+
+		out += "\n\t},\n\t\"branches\": {";
+
+		first = true;
+		for(size_t i = 0; i < branchCount; ++i)
+		{
+			if(!branchSteps[i])
+				continue;
+
+			out += first ? "\n\t\t" : ",\n\t\t";
+			appendJsonString(out, branchName(static_cast<Branch>(i)));
+			out += ": { \"steps\": ";
+			appendNumber(out, branchSteps[i]);
+			out += ", \"bytes\": ";
+			appendNumber(out, branchBytes[i]);
+			out += " }";
+			first = false;
+		}
+
+		out += "\n\t},\n\t\"keywords\": { \"lookups\": ";
+		appendNumber(out, keywordLookups);
+		out += ", \"probes\": ";
+		appendNumber(out, keywordProbes);
+		out += ", \"hits\": ";
+		appendNumber(out, keywordHits);
+		out += " },\n\t\"phases\": {";
+
+		first = true;
+		for(size_t i = 0; i < phaseCount; ++i)
+		{
+			if(!phaseRuns[i])
+				continue;
+
+			out += first ? "\n\t\t" : ",\n\t\t";
+			appendJsonString(out, phaseName(static_cast<Phase>(i)));
+			out += ": { \"runs\": ";
+			appendNumber(out, phaseRuns[i]);
+			out += ", \"seconds\": ";
+			appendNumber(out, phaseSeconds[i]);
+			out += " }";
+			first = false;
+		}
+
+		out += "\n\t}\n}\n";
+		return out;
+	}
+}
@@ -0,0 +1,115 @@
+#ifndef _JH_HEADER_LEXERPROFILE_
+#define _JH_HEADER_LEXERPROFILE_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "../Core/Token.hpp"
+
+namespace jh{
+	/*
+		Counters describing where the lexer spends its work
+
+		Lexer only collects these when compiled with JH_LEXER_PROFILE defined, otherwise
+		it does not even hold the member, so normal builds pay nothing. Counts cover
+		tokenize, retokenize and ParallelLexer(merge the per-range profiles).
+	*/
+	struct LexerProfile{
+		//branch of the lexer a step went through, decided by the first character(s)
+		enum class Branch{
+			Word,
+			Number,
+			Blank,
+			Newline,
+			BlockComment,
+			LineComment,
+			Preprocessor,
+			String,
+			Rawcode,
+			TextmacroArg,
+			Directive,
+			Operator,
+			Unknown,
+			Count,
+		};
+
+		enum class Phase{
+			Tokenize,
+			Retokenize,
+			Count,
+		};
+
+		static constexpr size_t branchCount = static_cast<size_t>(Branch::Count);
+		static constexpr size_t phaseCount = static_cast<size_t>(Phase::Count);
+
+		//tokens emitted, indexed by value of Token::Type
+		std::array<std::uint64_t, 256> tokens{};
+
+		//lexer steps taken in each branch, and the input bytes they consumed
+		std::array<std::uint64_t, branchCount> branchSteps{};
+		std::array<std::uint64_t, branchCount> branchBytes{};
+
+		//_findKeyword calls, those that had to probe the hash table(length is in range
+		//of keyword lengths), and those that found a keyword
+		std::uint64_t keywordLookups = 0;
+		std::uint64_t keywordProbes = 0;
+		std::uint64_t keywordHits = 0;
+
+		//wall time and number of runs of each phase
+		std::array<double, phaseCount> phaseSeconds{};
+		std::array<std::uint64_t, phaseCount> phaseRuns{};
+
+		//adds time of a phase when going out of scope
+		class PhaseTimer{
+			LexerProfile& profile;
+			Phase phase;
+			std::chrono::steady_clock::time_point start;
+		public:
+			PhaseTimer(LexerProfile& owner, Phase which)
+				: profile(owner), phase(which), start(std::chrono::steady_clock::now())
+			{
+			}
+
+			~PhaseTimer()
+			{
+				auto index = static_cast<size_t>(phase);
+				profile.phaseSeconds[index] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				++profile.phaseRuns[index];
+			}
+
+			PhaseTimer(const PhaseTimer&) = delete;
+			PhaseTimer& operator=(const PhaseTimer&) = delete;
+		};
+
+		//returns the branch lexer takes for token starting at position at
+		static Branch classify(std::string_view input, size_t at);
+
+		static const char* branchName(Branch branch);
+		static const char* phaseName(Phase phase);
+
+		void countStep(Branch branch, size_t bytes)
+		{
+			auto index = static_cast<size_t>(branch);
+			++branchSteps[index];
+			branchBytes[index] += bytes;
+		}
+
+		void countToken(Token::Type type)
+		{
+			++tokens[static_cast<size_t>(type) & 0xFF];
+		}
+
+		void reset();
+
+		//adds counters of other profile into this one
+		void merge(const LexerProfile& other);
+
+		//exports all non-zero counters as JSON object
+		std::string toJson() const;
+	};
+}
+
+#endif	//_JH_HEADER_LEXERPROFILE_
@@ -0,0 +1,136 @@
+#include "LiteralDecoder.hpp"
+#include <charconv>
+#include <cstddef>
+
+namespace jh{
+	namespace{
+		//loads 8 bytes with the first character in the lowest byte, whatever the byte
+		//order of the machine is, compilers turn this into single load
+		inline std::uint64_t loadLittle64(const char* at)
+		{
+			std::uint64_t value = 0;
+			for(int i = 7; i >= 0; --i)
+				value = (value << 8) | static_cast<unsigned char>(at[i]);
+
+			return value;
+		}
+
+		//value of 8 decimal digits, first digit most significant
+		inline std::uint64_t eightDecimalDigits(const char* at)
+		{
+			std::uint64_t value = loadLittle64(at) - 0x3030303030303030ULL;
+
+			//pairs, then quads, then all 8, each step multiplies the higher half
+			value = (value * 10) + (value >> 8);
+			value = (((value & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+					 (((value >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+
+			return value;
+		}
+
+		//value of 8 hexadecimal digits, first digit most significant
+		inline std::uint64_t eightHexDigits(const char* at)
+		{
+			std::uint64_t value = loadLittle64(at);
+
+			//letters have bit 6 set, digits do not, letters are low nibble + 9
+			std::uint64_t letters = (value & 0x4040404040404040ULL) >> 6;
+			value = (value & 0x0F0F0F0F0F0F0F0FULL) + letters * 9;
+
+			//join neighbours, the earlier character is the higher one
+			value = ((value & 0x00FF00FF00FF00FFULL) << 4) | ((value >> 8) & 0x00FF00FF00FF00FFULL);
+			value = ((value & 0x0000FFFF0000FFFFULL) << 8) | ((value >> 16) & 0x0000FFFF0000FFFFULL);
+			return ((value & 0xFFFF) << 16) | ((value >> 32) & 0xFFFF);
+		}
+
+		inline unsigned hexDigit(char c)
+		{
+			return (c & 0x0F) + ((c & 0x40) >> 6) * 9;
+		}
+
+		//digits past this many always overflow 32 bits, and would overflow the accumulator too
+		constexpr size_t maxDecimalDigits = 20;
+		constexpr size_t maxHexDigits = 16;
+	}
+
+	LiteralValue decodeInteger(std::string_view text)
+	{
+		LiteralValue result;
+		result.integer = 0;
+		result.overflow = false;
+
+		const char* at = text.data();
+		const char* end = at + text.size();
+
+		if(text.size() > 2 && at[0] == '0' && (at[1] == 'x' || at[1] == 'X'))
+		{
+			at += 2;
+
+			//leading zeros do not count towards overflow
+			while(end - at > 1 && *at == '0')
+				++at;
+
+			result.overflow = static_cast<size_t>(end - at) > 8;
+			if(static_cast<size_t>(end - at) > maxHexDigits)
+				at = end - maxHexDigits;
+
+			for(; end - at >= 8; at += 8)
+				result.integer = (result.integer << 32) | eightHexDigits(at);
+
+			for(; at < end; ++at)
+				result.integer = (result.integer << 4) | hexDigit(*at);
+		}
+		else if(text.size() > 1 && at[0] == '0')
+		{
+			//octal, rare enough for plain loop
+			for(++at; at < end; ++at)
+			{
+				if(result.integer >> 29)
+					result.overflow = true;
+
+				result.integer = (result.integer << 3) | static_cast<unsigned>(*at - '0');
+			}
+		}
+		else
+		{
+			if(static_cast<size_t>(end - at) >= maxDecimalDigits)
+				result.overflow = true;
+
+			for(; end - at >= 8; at += 8)
+				result.integer = result.integer * 100000000ULL + eightDecimalDigits(at);
+
+			for(; at < end; ++at)
+				result.integer = result.integer * 10 + static_cast<unsigned>(*at - '0');
+		}
+
+		if(result.integer > 0xFFFFFFFFULL)
+			result.overflow = true;
+
+		return result;
+	}
+
+	LiteralValue decodeReal(std::string_view text)
+	{
+		LiteralValue result;
+		result.real = 0.0;
+		result.overflow = false;
+
+		auto parsed = std::from_chars(text.data(), text.data() + text.size(), result.real);
+		if(parsed.ec == std::errc::result_out_of_range)
+			result.overflow = true;
+
+		return result;
+	}
+
+	LiteralValue decodeRawcode(std::string_view text)
+	{
+		LiteralValue result;
+		result.integer = 0;
+		result.overflow = text.size() != 1 && text.size() != 4;
+
+		for(char c : text)
+			result.integer = ((result.integer << 8) | static_cast<unsigned char>(c)) & 0xFFFFFFFFULL;
+
+		return result;
+	}
+}
@@ -0,0 +1,41 @@
+#ifndef _JH_HEADER_LITERALDECODER_
+#define _JH_HEADER_LITERALDECODER_
+
+#include <cstdint>
+#include <string_view>
+
+namespace jh{
+	//decoded value of Literal_int, Literal_real or Operator_rawcode token
+	struct LiteralValue{
+		union{
+			//Literal_int and Operator_rawcode
+			std::uint64_t integer;
+
+			//Literal_real
+			double real;
+		};
+
+		//integer does not fit into 32 bits, or rawcode is not 1 or 4 characters long
+		bool overflow;
+	};
+
+	/*
+		Decoders for literal text the lexer already validated, they do not check
+		the text again
+
+		Decimal and hexadecimal digits are converted 8 at a time(SWAR, 8 digits in one
+		64 bit register), reals go through std::from_chars, which is exact.
+	*/
+
+	//decodes decimal, octal(leading 0) or hexadecimal(0x) integer literal
+	LiteralValue decodeInteger(std::string_view text);
+
+	//decodes real literal, 1.5, 2. or .25
+	LiteralValue decodeReal(std::string_view text);
+
+	//packs rawcode contents(without the quotes) into integer the way the game does,
+	//first character in the highest byte, so 'A000' is 0x41303030
+	LiteralValue decodeRawcode(std::string_view text);
+}
+
+#endif	//_JH_HEADER_LITERALDECODER_
@@ -0,0 +1,157 @@
+#include "ParallelLexer.hpp"
+#include "Scanner.hpp"
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace jh{
+	namespace{
+		//tokens of single range, lexed as if the range started at line 1
+		struct LexedRange{
+			size_t start = 0;
+			size_t end = 0;
+
+			//where the last token of the range really ended, can be past end
+			size_t stoppedAt = 0;
+
+			//lines the range moved over
+			size_t lines = 0;
+
+			Lexer::TokenList tokens;
+
+#ifdef JH_LEXER_PROFILE
+			LexerProfile profile;
+#endif
+		};
+	}
+
+	ParallelLexer::ParallelLexer(size_t threads) : threadCount(threads)
+	{
+		if(!threadCount)
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	Lexer::TokenList& ParallelLexer::tokenize(std::string_view input)
+	{
+#ifdef JH_LEXER_PROFILE
+		LexerProfile::PhaseTimer timer(profile, LexerProfile::Phase::Tokenize);
+#endif
+
+		tokens.clear();
+		relexedRanges = 0;
+
+		size_t rangeCount = std::min(threadCount, std::max<size_t>(1, input.size() / std::max<size_t>(1, minRangeSize)));
+
+		//split right after newlines, so that in the usual case no token is cut
+		std::vector<LexedRange> ranges;
+		size_t start = 0;
+		for(size_t i = 1; i <= rangeCount && start < input.size(); ++i)
+		{
+			size_t end = input.size();
+			if(i < rangeCount)
+			{
+				size_t target = std::max(start, input.size() / rangeCount * i);
+				end = scan::findChar(input.data() + target, input.data() + input.size(), '\n') - input.data();
+				end = std::min(end + 1, input.size());
+			}
+
+			if(end <= start)
+				continue;
+
+			LexedRange range;
+			range.start = start;
+			range.end = end;
+			ranges.push_back(std::move(range));
+			start = end;
+		}
+
+		auto lexRange = [input](LexedRange& range, size_t from, size_t firstLine){
+			Lexer lexer;
+			lexer.currentLine = firstLine;
+			range.stoppedAt = lexer._tokenizeRange(input, from, range.end);
+			range.lines = lexer.currentLine - firstLine;
+			range.tokens = std::move(lexer.tokens);
+
+#ifdef JH_LEXER_PROFILE
+			range.profile.merge(lexer.profile);
+#endif
+		};
+
+		//the first range runs on this thread
+		std::vector<std::thread> workers;
+		workers.reserve(ranges.size());
+		for(size_t i = 1; i < ranges.size(); ++i)
+			workers.emplace_back(lexRange, std::ref(ranges[i]), ranges[i].start, 1);
+
+		if(!ranges.empty())
+			lexRange(ranges[0], 0, 1);
+
+		for(auto& worker : workers)
+			worker.join();
+
+		//stitch ranges in order, every range is valid only if the previous one ended
+		//exactly at its start, otherwise it began inside comment or string
+		size_t total = 0;
+		for(const auto& range : ranges)
+			total += range.tokens.size();
+
+		tokens.reserve(total);
+
+		size_t position = 0;
+		size_t line = 1;
+		for(auto& range : ranges)
+		{
+			//the previous token swallowed this whole range
+			if(position >= range.end)
+			{
+#ifdef JH_LEXER_PROFILE
+				profile.merge(range.profile);
+#endif
+				continue;
+			}
+
+			if(position != range.start)
+			{
+				lexRange(range, position, line);
+				++relexedRanges;
+			}
+			else
+			{
+				for(auto& token : range.tokens)
+					token.line += static_cast<int>(line - 1);
+			}
+
+			tokens.insert(tokens.end(), range.tokens.begin(), range.tokens.end());
+
+#ifdef JH_LEXER_PROFILE
+			profile.merge(range.profile);
+#endif
+			position = range.stoppedAt;
+			line += range.lines;
+		}
+
+		return tokens;
+	}
+
+	const Lexer::TokenList& ParallelLexer::getTokens() const
+	{
+		return tokens;
+	}
+
+	void ParallelLexer::setMinRangeSize(size_t size)
+	{
+		minRangeSize = size;
+	}
+
+	size_t ParallelLexer::getRelexedRanges() const
+	{
+		return relexedRanges;
+	}
+
+#ifdef JH_LEXER_PROFILE
+	const LexerProfile& ParallelLexer::getProfile() const
+	{
+		return profile;
+	}
+#endif
+}
@@ -0,0 +1,61 @@
+#ifndef _JH_HEADER_PARALLELLEXER_
+#define _JH_HEADER_PARALLELLEXER_
+
+#include <cstddef>
+#include <string_view>
+#include "Lexer.hpp"
+
+namespace jh{
+	/*
+		Lexes single big input on multiple threads
+
+		The input is split into ranges right after newlines, and every range is lexed
+		on its own thread as if it started at line 1. Afterwards the ranges are stitched
+		in order. If token of previous range did not end exactly where the next range
+		starts(block comment or string running over the newline), the speculative result
+		of that range is thrown away and it is lexed again from where the previous one
+		really ended. Line numbers of every range are shifted by the lines before it.
+
+		The result is the same as Lexer::tokenize would give for the whole input.
+	*/
+	class ParallelLexer{
+		Lexer::TokenList tokens;
+		size_t threadCount;
+
+		//ranges smaller than this are not worth a thread
+		size_t minRangeSize = 256 * 1024;
+
+		//number of ranges that had to be lexed again during last tokenize
+		size_t relexedRanges = 0;
+
+#ifdef JH_LEXER_PROFILE
+		//counters of every range lexer, thrown away speculative work included
+		LexerProfile profile;
+#endif
+	public:
+		//threadCount of 0 uses as many threads as the machine has cores
+		explicit ParallelLexer(size_t threads = 0);
+
+		ParallelLexer(const ParallelLexer&) = delete;
+		ParallelLexer& operator=(const ParallelLexer&) = delete;
+
+		//tokenize given input, result is stored inside internal memory buffer(which
+		//is cleared first), and after tokenizing is also returned
+		Lexer::TokenList& tokenize(std::string_view input);
+
+		//returns constant reference to tokens from last tokenize
+		const Lexer::TokenList& getTokens() const;
+
+		//sets the smallest range size given to single thread
+		void setMinRangeSize(size_t size);
+
+		//returns number of ranges that had to be lexed again in last tokenize
+		size_t getRelexedRanges() const;
+
+#ifdef JH_LEXER_PROFILE
+		const LexerProfile& getProfile() const;
+#endif
+	};
+}
+
+#endif	//_JH_HEADER_PARALLELLEXER_
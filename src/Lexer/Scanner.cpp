@@ -0,0 +1,367 @@
+#include "Scanner.hpp"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define JH_SCAN_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#endif
+#endif
+
+//gcc and clang only let us use intrinsics of instruction sets that are enabled for given
+//function, msvc lets us use all of them anywhere
+#if defined(__GNUC__) || defined(__clang__)
+	#define JH_TARGET_SSE2 __attribute__((target("sse2")))
+	#define JH_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#else
+	#define JH_TARGET_SSE2
+	#define JH_TARGET_AVX2
+#endif
+
+namespace jh{
+	namespace scan{
+		namespace{
+			//returns number of set bits
+			//the builtin becomes single popcnt inside avx2 kernels
+			inline unsigned bitCount(std::uint32_t v)
+			{
+#if defined(__GNUC__) || defined(__clang__)
+				return __builtin_popcount(v);
+#else
+				v = v - ((v >> 1) & 0x55555555u);
+				v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+				return (((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+			}
+
+			//returns index of lowest set bit, v must not be 0
+			inline unsigned lowestBit(std::uint32_t v)
+			{
+#if defined(__GNUC__) || defined(__clang__)
+				return __builtin_ctz(v);
+#else
+				unsigned long index;
+				_BitScanForward(&index, v);
+				return index;
+#endif
+			}
+
+			inline bool isBlank(char c)
+			{
+				return c == ' ' || c == '\t' || c == '\v' || c == '\f';
+			}
+
+			/*
+				Scalar kernels, used on non-x86 and for tails shorter than one vector
+			*/
+			const char* findCharScalar(const char* begin, const char* end, char what)
+			{
+				auto result = static_cast<const char*>(std::memchr(begin, what, end - begin));
+				return result ? result : end;
+			}
+
+			const char* findEitherScalar(const char* begin, const char* end, char first, char second)
+			{
+				while(begin < end && *begin != first && *begin != second)
+					++begin;
+
+				return begin;
+			}
+
+			const char* skipBlanksScalar(const char* begin, const char* end)
+			{
+				while(begin < end && isBlank(*begin))
+					++begin;
+
+				return begin;
+			}
+
+			LineBreaks countLineBreaksScalar(const char* begin, const char* end)
+			{
+				size_t lf = 0, cr = 0, crlf = 0;
+				for(; begin < end; ++begin)
+				{
+					if(*begin == '\n')
+						++lf;
+					else if(*begin == '\r')
+					{
+						++cr;
+						if(begin + 1 < end && begin[1] == '\n')
+							++crlf;
+					}
+				}
+
+				LineBreaks result;
+				result.lines = lf + cr - crlf;
+				result.crlf = crlf;
+				return result;
+			}
+
+#ifdef JH_SCAN_X86
+			/*
+				SSE2 kernels, 16 bytes per iteration
+			*/
+			JH_TARGET_SSE2 const char* findCharSse2(const char* begin, const char* end, char what)
+			{
+				auto needle = _mm_set1_epi8(what);
+				while(end - begin >= 16)
+				{
+					auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+					auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+					if(mask)
+						return begin + lowestBit(mask);
+
+					begin += 16;
+				}
+
+				return findCharScalar(begin, end, what);
+			}
+
+			JH_TARGET_SSE2 const char* findEitherSse2(const char* begin, const char* end, char first, char second)
+			{
+				auto firstNeedle = _mm_set1_epi8(first);
+				auto secondNeedle = _mm_set1_epi8(second);
+				while(end - begin >= 16)
+				{
+					auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+					auto hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, firstNeedle), _mm_cmpeq_epi8(chunk, secondNeedle));
+					auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(hits));
+					if(mask)
+						return begin + lowestBit(mask);
+
+					begin += 16;
+				}
+
+				return findEitherScalar(begin, end, first, second);
+			}
+
+			JH_TARGET_SSE2 const char* skipBlanksSse2(const char* begin, const char* end)
+			{
+				auto space = _mm_set1_epi8(' ');
+				auto tab = _mm_set1_epi8('\t');
+				auto vtab = _mm_set1_epi8('\v');
+				auto feed = _mm_set1_epi8('\f');
+				while(end - begin >= 16)
+				{
+					auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+					auto blanks = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+											   _mm_or_si128(_mm_cmpeq_epi8(chunk, vtab), _mm_cmpeq_epi8(chunk, feed)));
+					auto mask = ~static_cast<std::uint32_t>(_mm_movemask_epi8(blanks)) & 0xFFFFu;
+					if(mask)
+						return begin + lowestBit(mask);
+
+					begin += 16;
+				}
+
+				return skipBlanksScalar(begin, end);
+			}
+
+			JH_TARGET_SSE2 LineBreaks countLineBreaksSse2(const char* begin, const char* end)
+			{
+				auto lfNeedle = _mm_set1_epi8('\n');
+				auto crNeedle = _mm_set1_epi8('\r');
+				size_t lf = 0, cr = 0, crlf = 0;
+
+				//second load is shifted by one, so it needs one more byte to be in range
+				while(end - begin >= 17)
+				{
+					auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+					auto next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + 1));
+					auto isCr = _mm_cmpeq_epi8(chunk, crNeedle);
+					auto isLf = _mm_cmpeq_epi8(chunk, lfNeedle);
+					auto nextLf = _mm_cmpeq_epi8(next, lfNeedle);
+
+					lf += bitCount(static_cast<std::uint32_t>(_mm_movemask_epi8(isLf)));
+					cr += bitCount(static_cast<std::uint32_t>(_mm_movemask_epi8(isCr)));
+					crlf += bitCount(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(isCr, nextLf))));
+
+					begin += 16;
+				}
+
+				auto tail = countLineBreaksScalar(begin, end);
+
+				LineBreaks result;
+				result.lines = lf + cr - crlf + tail.lines;
+				result.crlf = crlf + tail.crlf;
+				return result;
+			}
+
+			/*
+				AVX2 kernels, 32 bytes per iteration
+			*/
+			JH_TARGET_AVX2 const char* findCharAvx2(const char* begin, const char* end, char what)
+			{
+				auto needle = _mm256_set1_epi8(what);
+				while(end - begin >= 32)
+				{
+					auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+					auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+					if(mask)
+						return begin + lowestBit(mask);
+
+					begin += 32;
+				}
+
+				return findCharScalar(begin, end, what);
+			}
+
+			JH_TARGET_AVX2 const char* findEitherAvx2(const char* begin, const char* end, char first, char second)
+			{
+				auto firstNeedle = _mm256_set1_epi8(first);
+				auto secondNeedle = _mm256_set1_epi8(second);
+				while(end - begin >= 32)
+				{
+					auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+					auto hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, firstNeedle),
+												_mm256_cmpeq_epi8(chunk, secondNeedle));
+					auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(hits));
+					if(mask)
+						return begin + lowestBit(mask);
+
+					begin += 32;
+				}
+
+				return findEitherScalar(begin, end, first, second);
+			}
+
+			JH_TARGET_AVX2 const char* skipBlanksAvx2(const char* begin, const char* end)
+			{
+				auto space = _mm256_set1_epi8(' ');
+				auto tab = _mm256_set1_epi8('\t');
+				auto vtab = _mm256_set1_epi8('\v');
+				auto feed = _mm256_set1_epi8('\f');
+				while(end - begin >= 32)
+				{
+					auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+					auto blanks = _mm256_or_si256(
+									_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+									_mm256_or_si256(_mm256_cmpeq_epi8(chunk, vtab), _mm256_cmpeq_epi8(chunk, feed)));
+					auto mask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(blanks));
+					if(mask)
+						return begin + lowestBit(mask);
+
+					begin += 32;
+				}
+
+				return skipBlanksScalar(begin, end);
+			}
+
+			JH_TARGET_AVX2 LineBreaks countLineBreaksAvx2(const char* begin, const char* end)
+			{
+				auto lfNeedle = _mm256_set1_epi8('\n');
+				auto crNeedle = _mm256_set1_epi8('\r');
+				size_t lf = 0, cr = 0, crlf = 0;
+
+				//second load is shifted by one, so it needs one more byte to be in range
+				while(end - begin >= 33)
+				{
+					auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+					auto next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + 1));
+					auto isCr = _mm256_cmpeq_epi8(chunk, crNeedle);
+					auto isLf = _mm256_cmpeq_epi8(chunk, lfNeedle);
+					auto nextLf = _mm256_cmpeq_epi8(next, lfNeedle);
+
+					lf += bitCount(static_cast<std::uint32_t>(_mm256_movemask_epi8(isLf)));
+					cr += bitCount(static_cast<std::uint32_t>(_mm256_movemask_epi8(isCr)));
+					crlf += bitCount(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(isCr, nextLf))));
+
+					begin += 32;
+				}
+
+				auto tail = countLineBreaksScalar(begin, end);
+
+				LineBreaks result;
+				result.lines = lf + cr - crlf + tail.lines;
+				result.crlf = crlf + tail.crlf;
+				return result;
+			}
+
+			bool cpuHasSse2()
+			{
+#if defined(_M_X64) || defined(__x86_64__)
+				//always there on x86-64
+				return true;
+#elif defined(_MSC_VER)
+				int regs[4];
+				__cpuid(regs, 1);
+				return (regs[3] & (1 << 26)) != 0;
+#else
+				__builtin_cpu_init();
+				return __builtin_cpu_supports("sse2");
+#endif
+			}
+
+			bool cpuHasAvx2()
+			{
+#if defined(_MSC_VER)
+				int regs[4];
+				__cpuid(regs, 1);
+
+				//cpu has to support avx and os has to save ymm registers
+				bool osSaves = (regs[2] & (1 << 27)) != 0 && (regs[2] & (1 << 28)) != 0;
+				if(!osSaves || (_xgetbv(0) & 6) != 6)
+					return false;
+
+				__cpuidex(regs, 7, 0);
+				return (regs[1] & (1 << 5)) != 0;
+#else
+				__builtin_cpu_init();
+				return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+			}
+#endif	//JH_SCAN_X86
+
+			struct Kernels{
+				const char* name;
+				const char* (*findChar)(const char*, const char*, char);
+				const char* (*findEither)(const char*, const char*, char, char);
+				const char* (*skipBlanks)(const char*, const char*);
+				LineBreaks (*countLineBreaks)(const char*, const char*);
+			};
+
+			Kernels selectKernels()
+			{
+#ifdef JH_SCAN_X86
+				if(cpuHasAvx2())
+					return { "avx2", findCharAvx2, findEitherAvx2, skipBlanksAvx2, countLineBreaksAvx2 };
+				if(cpuHasSse2())
+					return { "sse2", findCharSse2, findEitherSse2, skipBlanksSse2, countLineBreaksSse2 };
+#endif
+				return { "scalar", findCharScalar, findEitherScalar, skipBlanksScalar, countLineBreaksScalar };
+			}
+
+			const Kernels& kernels()
+			{
+				static const Kernels selected = selectKernels();
+				return selected;
+			}
+		}
+
+		const char* findChar(const char* begin, const char* end, char what)
+		{
+			return kernels().findChar(begin, end, what);
+		}
+
+		const char* findEither(const char* begin, const char* end, char first, char second)
+		{
+			return kernels().findEither(begin, end, first, second);
+		}
+
+		const char* skipBlanks(const char* begin, const char* end)
+		{
+			return kernels().skipBlanks(begin, end);
+		}
+
+		LineBreaks countLineBreaks(const char* begin, const char* end)
+		{
+			return kernels().countLineBreaks(begin, end);
+		}
+
+		const char* kernelName()
+		{
+			return kernels().name;
+		}
+	}
+}
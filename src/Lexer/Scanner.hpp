@@ -0,0 +1,39 @@
+#ifndef _JH_HEADER_SCANNER_
+#define _JH_HEADER_SCANNER_
+
+#include <cstddef>
+
+namespace jh{
+	//bulk scanning kernels used by the lexer to jump over comments, strings,
+	//rawcodes, textmacro arguments and runs of blanks
+	//every function has scalar, SSE2 and AVX2 version, the best one supported
+	//by the running cpu is picked once, on first use
+	namespace scan{
+		//result of countLineBreaks
+		struct LineBreaks{
+			//number of lines ended inside the range, \r\n counts as one, lone \r or \n as one
+			size_t lines = 0;
+
+			//number of \r\n pairs inside the range, so that callers can count
+			//\r\n as single character the same way the lexer always did
+			size_t crlf = 0;
+		};
+
+		//returns pointer to first character in [begin, end) that is equal to what, or end
+		const char* findChar(const char* begin, const char* end, char what);
+
+		//returns pointer to first character in [begin, end) that is equal to first or second, or end
+		const char* findEither(const char* begin, const char* end, char first, char second);
+
+		//returns pointer to first character in [begin, end) that is not blank(space, \t, \v, \f), or end
+		const char* skipBlanks(const char* begin, const char* end);
+
+		//counts line breaks inside [begin, end)
+		LineBreaks countLineBreaks(const char* begin, const char* end);
+
+		//returns name of kernel set that is in use, "scalar", "sse2" or "avx2"
+		const char* kernelName();
+	}
+}
+
+#endif	//_JH_HEADER_SCANNER_
@@ -0,0 +1,322 @@
+#include "StreamLexer.hpp"
+#include "Scanner.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace jh{
+	StreamLexer::StreamLexer(Callback onToken) : callback(std::move(onToken))
+	{
+	}
+
+	void StreamLexer::_emit(Token::Type type, size_t position, size_t line, size_t length, std::string_view text)
+	{
+		Token token(type, static_cast<int>(position), static_cast<int>(line), static_cast<int>(length));
+		callback(token, text);
+	}
+
+	bool StreamLexer::_startPending(bool atEnd, bool& started)
+	{
+		size_t rest = window.size() - scanPos;
+		size_t contentStart = 0;
+
+		switch(window[scanPos])
+		{
+			case '/':
+			{
+				//need to see up to 3 characters to tell /* from // from //!
+				if(rest < 3 && !atEnd)
+					return false;
+
+				if(rest >= 2 && window[scanPos + 1] == '*')
+				{
+					pending = Pending::BlockComment;
+					contentStart = scanPos + 2;
+					pendingMatch = 1;
+				}
+				else if(rest >= 2 && window[scanPos + 1] == '/')
+				{
+					if(rest >= 3 && window[scanPos + 2] == '!')
+					{
+						pending = Pending::Preprocessor;
+						contentStart = scanPos + 3;
+					}
+					else
+					{
+						pending = Pending::LineComment;
+						contentStart = scanPos + 2;
+					}
+				}
+				//just / or /=, which are short
+				else
+					return true;
+
+				break;
+			}
+
+			case '\"':
+				pending = Pending::String;
+				contentStart = scanPos + 1;
+				break;
+
+			case '\'':
+				pending = Pending::Rawcode;
+				contentStart = scanPos + 1;
+				break;
+
+			case '$':
+				pending = Pending::TextmacroArg;
+				contentStart = scanPos + 1;
+				break;
+
+			default:
+				return true;
+		}
+
+		pendingStart = windowBase + contentStart;
+		pendingScanned = pendingStart;
+		pendingKept = pendingStart;
+		pendingLine = lexer.currentLine;
+		pendingLines = 0;
+		pendingLength = 0;
+		started = true;
+
+		return true;
+	}
+
+	bool StreamLexer::_continuePending(bool atEnd)
+	{
+		size_t from = pendingScanned - windowBase;
+		const char* data = window.data();
+
+		switch(pending)
+		{
+			case Pending::BlockComment:
+			{
+				size_t closing = lexer._findCommentEnd(window, from, pendingMatch);
+				size_t kept = pendingKept - windowBase;
+
+				if(closing == std::string_view::npos)
+				{
+					if(!atEnd)
+					{
+						//the last character was not checked yet, it needs the one after it
+						if(!window.empty())
+							pendingScanned = windowBase + std::max(from, window.size() - 1);
+
+						return false;
+					}
+
+					closing = window.empty() ? 0 : lexer._unterminatedCommentEnd(window, kept);
+				}
+
+				//lines and length of the part that is still in window, plus what was dropped
+				auto breaks = scan::countLineBreaks(data + kept, data + closing);
+				lexer.currentLine += pendingLines + breaks.lines;
+				size_t length = pendingLength + (closing - kept) - breaks.crlf;
+
+				_emit(Token::Type::Operator_dComment, pendingStart, pendingLine, length, std::string_view());
+				scanPos = closing + 2;
+				break;
+			}
+
+			case Pending::LineComment:
+			case Pending::Preprocessor:
+			{
+				size_t end = scan::findChar(data + from, data + window.size(), '\n') - data;
+				if(end == window.size() && !atEnd)
+				{
+					pendingScanned = windowBase + end;
+					return false;
+				}
+
+				if(pending == Pending::Preprocessor)
+				{
+					size_t start = pendingStart - windowBase;
+					_emit(Token::Type::Operator_preprocessor, pendingStart, pendingLine, end - start,
+						  std::string_view(window).substr(start, end - start));
+				}
+
+				scanPos = end;
+				break;
+			}
+
+			case Pending::String:
+			case Pending::Rawcode:
+			case Pending::TextmacroArg:
+			{
+				size_t end;
+				Token::Type type;
+				if(pending == Pending::String)
+				{
+					end = lexer._findStringEnd(window, from);
+					type = Token::Type::Operator_string;
+				}
+				else
+				{
+					char terminator = pending == Pending::Rawcode ? '\'' : '$';
+					end = scan::findChar(data + from, data + window.size(), terminator) - data;
+					type = pending == Pending::Rawcode ? Token::Type::Operator_rawcode : Token::Type::Operator_textmacroarg;
+				}
+
+				if(end == window.size() && !atEnd)
+				{
+					pendingScanned = windowBase + end;
+					return false;
+				}
+
+				//even tho it could be \r\n, still consider it as one char
+				size_t start = pendingStart - windowBase;
+				auto breaks = scan::countLineBreaks(data + start, data + end);
+				lexer.currentLine += breaks.lines;
+
+				_emit(type, pendingStart, pendingLine, end - start - breaks.crlf,
+					  std::string_view(window).substr(start, end - start));
+				scanPos = end + 1;
+				break;
+			}
+
+			case Pending::None:
+				break;
+		}
+
+		pending = Pending::None;
+		return true;
+	}
+
+	void StreamLexer::_run(bool atEnd)
+	{
+		while(true)
+		{
+			if(pending != Pending::None)
+			{
+				if(!_continuePending(atEnd))
+					break;
+
+				continue;
+			}
+
+			if(scanPos >= window.size())
+				break;
+
+			bool started = false;
+			if(!_startPending(atEnd, started))
+				break;
+
+			if(started)
+				continue;
+
+			//everything else is short, let the lexer do it
+			size_t line = lexer.currentLine;
+			size_t next = lexer._lexToken(window, scanPos);
+
+			//the lexer looks at most one character past the end of any token, so if the token
+			//ends this close to the end of what we have, more input could still change it
+			if(!atEnd && next + 2 > window.size())
+			{
+				lexer.tokens.clear();
+				lexer.currentLine = line;
+				break;
+			}
+
+			for(const auto& token : lexer.tokens)
+			{
+				_emit(token.type, windowBase + token.position, token.line, token.length,
+					  std::string_view(window).substr(token.position, next - token.position));
+			}
+
+			lexer.tokens.clear();
+			scanPos = next;
+		}
+
+		_compact();
+	}
+
+	void StreamLexer::_compact()
+	{
+		size_t keepFrom = 0;
+
+		switch(pending)
+		{
+			case Pending::None:
+				keepFrom = scanPos;
+				break;
+
+			//nothing of // comment is needed
+			case Pending::LineComment:
+				keepFrom = window.size();
+				break;
+
+			case Pending::BlockComment:
+			{
+				//keep the last character, since it is the next to be checked, and never
+				//split \r\n, so that it is still counted as single line
+				size_t kept = pendingKept - windowBase;
+				size_t dropTo = window.empty() ? 0 : window.size() - 1;
+				if(dropTo > kept && window[dropTo - 1] == '\r')
+					--dropTo;
+
+				if(dropTo > kept)
+				{
+					auto breaks = scan::countLineBreaks(window.data() + kept, window.data() + dropTo);
+					pendingLines += breaks.lines;
+					pendingLength += (dropTo - kept) - breaks.crlf;
+					pendingKept = windowBase + dropTo;
+				}
+
+				keepFrom = pendingKept - windowBase;
+				break;
+			}
+
+			//string end check looks 2 characters back, which can reach the opening "
+			case Pending::String:
+				keepFrom = pendingStart - windowBase - 1;
+				break;
+
+			default:
+				keepFrom = pendingStart - windowBase;
+				break;
+		}
+
+		keepFrom = std::min(keepFrom, window.size());
+		if(!keepFrom)
+			return;
+
+		window.erase(0, keepFrom);
+		windowBase += keepFrom;
+		scanPos = scanPos > keepFrom ? scanPos - keepFrom : 0;
+	}
+
+	void StreamLexer::feed(std::string_view chunk)
+	{
+		window.append(chunk.data(), chunk.size());
+		_run(false);
+	}
+
+	void StreamLexer::finish()
+	{
+		if(finished)
+			return;
+
+		_run(true);
+		finished = true;
+	}
+
+	void StreamLexer::feed(std::istream& input, size_t chunkSize)
+	{
+		std::string chunk(chunkSize, '\0');
+		while(input.read(&chunk[0], chunkSize) || input.gcount())
+			feed(std::string_view(chunk.data(), static_cast<size_t>(input.gcount())));
+
+		finish();
+	}
+
+	size_t StreamLexer::getPendingSize() const
+	{
+		return window.size();
+	}
+
+	size_t StreamLexer::getLine() const
+	{
+		return lexer.currentLine;
+	}
+}
@@ -0,0 +1,111 @@
+#ifndef _JH_HEADER_STREAMLEXER_
+#define _JH_HEADER_STREAMLEXER_
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <string>
+#include <string_view>
+#include "Lexer.hpp"
+
+namespace jh{
+	/*
+		Lexer for input that arrives in pieces(pipes, archive extraction, ...)
+
+		Input is fed chunk by chunk, and every token that can no longer change is passed
+		to the callback right away. Only the bytes of the token that is not finished yet
+		are kept between chunks, so memory stays bounded by the longest string, rawcode
+		or //! line, not by the size of the input. Block and // comments are skipped as
+		they come in, without keeping their text.
+
+		Tokens are exactly the same as Lexer::tokenize would produce for the whole input
+		at once, positions are offsets from the start of the whole stream.
+	*/
+	class StreamLexer{
+	public:
+		//receives every finished token together with its raw text
+		//the text is only valid during the call, and is empty for Operator_dComment,
+		//since comment contents are not kept
+		using Callback = std::function<void(const Token&, std::string_view)>;
+	private:
+		//long tokens that can span over chunk boundary, these are scanned
+		//incrementally so that no part of input is scanned twice
+		enum class Pending{
+			None,
+			BlockComment,
+			LineComment,
+			Preprocessor,
+			String,
+			Rawcode,
+			TextmacroArg,
+		};
+
+		Lexer lexer;
+		Callback callback;
+
+		//bytes not consumed yet, window[0] lies at windowBase in the whole stream
+		std::string window;
+		size_t windowBase = 0;
+
+		//position inside window where lexing continues
+		size_t scanPos = 0;
+
+		Pending pending = Pending::None;
+
+		//stream position of contents of the pending token and the line it started at
+		size_t pendingStart = 0;
+		size_t pendingLine = 0;
+
+		//stream position the terminator search continues from
+		size_t pendingScanned = 0;
+
+		//open nested comments, for Pending::BlockComment
+		size_t pendingMatch = 0;
+
+		//stream position from which comment bytes are still in window, and the lines and length
+		//of the part before it that was already dropped, for Pending::BlockComment
+		size_t pendingKept = 0;
+		size_t pendingLines = 0;
+		size_t pendingLength = 0;
+
+		bool finished = false;
+
+		//lexes as far as possible, atEnd says there is no more input coming
+		void _run(bool atEnd);
+
+		//starts pending token if there is one at scanPos, returns false
+		//if more input is needed to decide
+		bool _startPending(bool atEnd, bool& started);
+
+		//continues scanning pending token, returns false if it needs more input
+		bool _continuePending(bool atEnd);
+
+		//drops bytes of window that are no longer needed
+		void _compact();
+
+		//passes token to callback, position is relative to window
+		void _emit(Token::Type type, size_t position, size_t line, size_t length, std::string_view text);
+	public:
+		explicit StreamLexer(Callback onToken);
+
+		StreamLexer(const StreamLexer&) = delete;
+		StreamLexer& operator=(const StreamLexer&) = delete;
+
+		//feeds next piece of input, tokens that got finished are passed to callback
+		void feed(std::string_view chunk);
+
+		//tells there is no more input, passes the remaining tokens to callback
+		void finish();
+
+		//reads whole stream in chunks of given size, feeding each one, and finishes
+		void feed(std::istream& input, size_t chunkSize = 64 * 1024);
+
+		//returns number of bytes currently held back
+		size_t getPendingSize() const;
+
+		//returns the line the lexer is at
+		size_t getLine() const;
+	};
+}
+
+#endif	//_JH_HEADER_STREAMLEXER_
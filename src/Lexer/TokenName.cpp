@@ -0,0 +1,66 @@
+#include "TokenName.hpp"
+#include "KeywordTable.hpp"
+
+namespace jh{
+	const char* tokenTypeName(Token::Type type)
+	{
+		switch(type)
+		{
+			case Token::Type::Literal_int: return "integer literal";
+			case Token::Type::Literal_real: return "real literal";
+			case Token::Type::Keyword_hashif: return "#if";
+			case Token::Type::Keyword_hashelseif: return "#elseif";
+			case Token::Type::Keyword_hashelse: return "#else";
+			case Token::Type::Keyword_hashendif: return "#endif";
+			case Token::Type::Operator_newline: return "newline";
+			case Token::Type::Operator_plus: return "+";
+			case Token::Type::Operator_minus: return "-";
+			case Token::Type::Operator_multiply: return "*";
+			case Token::Type::Operator_divide: return "/";
+			case Token::Type::Operator_LPar: return "(";
+			case Token::Type::Operator_RPar: return ")";
+			case Token::Type::Operator_LBPar: return "[";
+			case Token::Type::Operator_RBPar: return "]";
+			case Token::Type::Operator_assign: return "=";
+			case Token::Type::Operator_equal: return "==";
+			case Token::Type::Operator_notequal: return "!=";
+			case Token::Type::Operator_less: return "<";
+			case Token::Type::Operator_bigger: return ">";
+			case Token::Type::Operator_biggerequal: return ">=";
+			case Token::Type::Operator_lessequal: return "<=";
+			case Token::Type::Operator_rawcode: return "rawcode";
+			case Token::Type::Operator_string: return "string";
+			case Token::Type::Operator_comma: return ",";
+			case Token::Type::Operator_modulo: return "%";
+			case Token::Type::Operator_rshift: return ">>";
+			case Token::Type::Operator_lshift: return "<<";
+			case Token::Type::Operator_eqplus: return "+=";
+			case Token::Type::Operator_eqminus: return "-=";
+			case Token::Type::Operator_eqmultiply: return "*=";
+			case Token::Type::Operator_eqdivide: return "/=";
+			case Token::Type::Operator_eqmodulo: return "%=";
+			case Token::Type::Operator_eqrshift: return ">>=";
+			case Token::Type::Operator_eqlshift: return "<<=";
+			case Token::Type::Operator_increment: return "++";
+			case Token::Type::Operator_decrement: return "--";
+			case Token::Type::Operator_dComment: return "block comment";
+			case Token::Type::Operator_preprocessor: return "//!";
+			case Token::Type::Operator_LCPar: return "{";
+			case Token::Type::Operator_RCPar: return "}";
+			case Token::Type::Operator_semi: return ";";
+			case Token::Type::Operator_dot: return ".";
+			case Token::Type::Operator_textmacroarg: return "textmacro argument";
+			case Token::Type::Id: return "identifier";
+			default: break;
+		}
+
+		//every other type is keyword or literal keyword, spelled in keywordTable
+		for(const auto& keyword : keywordTable)
+		{
+			if(keyword.type == type)
+				return keyword.spelling.data();
+		}
+
+		return "unknown token";
+	}
+}
@@ -0,0 +1,12 @@
+#ifndef _JH_HEADER_TOKENNAME_
+#define _JH_HEADER_TOKENNAME_
+
+#include "../Core/Token.hpp"
+
+namespace jh{
+	//returns readable name of token type, the spelling for keywords and operators
+	//(endfunction, +=, #if) and description for the rest(identifier, string, ...)
+	const char* tokenTypeName(Token::Type type);
+}
+
+#endif	//_JH_HEADER_TOKENNAME_
@@ -0,0 +1,144 @@
+#include "TokenStream.hpp"
+#include <algorithm>
+
+namespace jh{
+	namespace{
+		inline size_t bitCount64(std::uint64_t v)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return __builtin_popcountll(v);
+#else
+			v = v - ((v >> 1) & 0x5555555555555555ull);
+			v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+			return (((v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full) * 0x0101010101010101ull) >> 56;
+#endif
+		}
+	}
+
+	size_t TokenStream::_findMark(size_t position) const
+	{
+		//first mark that lies past position, the one before it is ours
+		auto it = std::upper_bound(lineMarks.begin(), lineMarks.end(), position,
+			[](size_t pos, const LineMark& mark){ return pos < mark.position; });
+
+		return it == lineMarks.begin() ? 0 : (it - lineMarks.begin()) - 1;
+	}
+
+	void TokenStream::clear()
+	{
+		types.clear();
+		positions.clear();
+		lengths.clear();
+		lengthBits.clear();
+		lengthBase.clear();
+		lineMarks.clear();
+	}
+
+	void TokenStream::reserve(size_t tokenCount)
+	{
+		types.reserve(tokenCount);
+		positions.reserve(tokenCount);
+		lengthBits.reserve(tokenCount / 64 + 1);
+		lengthBase.reserve(tokenCount / 64 + 1);
+
+		//roughly every third token carries length(identifiers and literals)
+		lengths.reserve(tokenCount / 3);
+	}
+
+	size_t TokenStream::length(size_t index) const
+	{
+		auto bits = lengthBits[index >> 6];
+		auto bit = index & 63;
+		if(!((bits >> bit) & 1))
+			return 0;
+
+		//entries before this block + entries before this token inside the block
+		auto below = bits & ((std::uint64_t(1) << bit) - 1);
+		return lengths[lengthBase[index >> 6] + bitCount64(below)];
+	}
+
+	size_t TokenStream::line(size_t index) const
+	{
+		if(lineMarks.empty())
+			return 1;
+
+		return lineMarks[_findMark(positions[index])].line;
+	}
+
+	Token TokenStream::operator[](size_t index) const
+	{
+		return Token(type(index), static_cast<int>(position(index)),
+					 static_cast<int>(line(index)), static_cast<int>(length(index)));
+	}
+
+	TokenStream::const_iterator TokenStream::begin() const
+	{
+		return const_iterator(this, 0);
+	}
+
+	TokenStream::const_iterator TokenStream::end() const
+	{
+		return const_iterator(this, size());
+	}
+
+	size_t TokenStream::memoryUsage() const
+	{
+		return types.size() * sizeof(types[0]) + positions.size() * sizeof(positions[0]) +
+			lengths.size() * sizeof(lengths[0]) + lengthBits.size() * sizeof(lengthBits[0]) +
+			lengthBase.size() * sizeof(lengthBase[0]) + lineMarks.size() * sizeof(lineMarks[0]);
+	}
+
+	std::vector<Token> TokenStream::toTokenList() const
+	{
+		std::vector<Token> result;
+		result.reserve(size());
+
+		for(auto token : *this)
+			result.push_back(token);
+
+		return result;
+	}
+
+	TokenStream::const_iterator::const_iterator(const TokenStream* owner, size_t startIndex)
+		: stream(owner), index(startIndex)
+	{
+		//only begin() and end() construct iterators, end() never gets dereferenced
+		if(index == 0 && !stream->lineMarks.empty() && !stream->empty())
+			markIndex = stream->_findMark(stream->positions[0]);
+	}
+
+	Token TokenStream::const_iterator::operator*() const
+	{
+		auto type = stream->type(index);
+		size_t length = tokenHasLength(type) ? stream->lengths[lengthIndex] : 0;
+		size_t line = stream->lineMarks.empty() ? 1 : stream->lineMarks[markIndex].line;
+
+		return Token(type, static_cast<int>(stream->positions[index]),
+					 static_cast<int>(line), static_cast<int>(length));
+	}
+
+	TokenStream::const_iterator& TokenStream::const_iterator::operator++()
+	{
+		if(tokenHasLength(stream->type(index)))
+			++lengthIndex;
+
+		++index;
+
+		if(index < stream->size())
+		{
+			const auto& marks = stream->lineMarks;
+			auto position = stream->positions[index];
+			while(markIndex + 1 < marks.size() && marks[markIndex + 1].position <= position)
+				++markIndex;
+		}
+
+		return *this;
+	}
+
+	TokenStream::const_iterator TokenStream::const_iterator::operator++(int)
+	{
+		auto copy = *this;
+		++*this;
+		return copy;
+	}
+}
@@ -0,0 +1,155 @@
+#ifndef _JH_HEADER_TOKENSTREAM_
+#define _JH_HEADER_TOKENSTREAM_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+#include "../Core/Token.hpp"
+
+namespace jh{
+	//returns whether tokens of given type carry 'length'(see the list in Token.hpp)
+	constexpr bool tokenHasLength(Token::Type type)
+	{
+		switch(type)
+		{
+			case Token::Type::Literal_int:
+			case Token::Type::Literal_real:
+			case Token::Type::Operator_preprocessor:
+			case Token::Type::Operator_rawcode:
+			case Token::Type::Operator_string:
+			case Token::Type::Operator_dComment:
+			case Token::Type::Operator_textmacroarg:
+			case Token::Type::Id:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	/*
+		Compact structure-of-arrays storage of lexed tokens
+
+		Per token it only keeps 1 byte type and 4 byte position. Length is only stored
+		for tokens that carry it(tokenHasLength), and is found through one bit per token
+		plus one counter per 64 tokens. Lines are not stored per token at all, instead
+		every time the line changes a mark(position, line) is stored, and line of a token
+		is the line of the last mark at or before its position.
+
+		Reading goes through Token values, so code written against Lexer::TokenList
+		can iterate this the same way.
+	*/
+	class TokenStream{
+	public:
+		//position where lexer continued on new line, and the line number from there on
+		struct LineMark{
+			std::uint32_t position;
+			std::uint32_t line;
+		};
+
+		class const_iterator{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = Token;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = Token;
+
+			const_iterator() = default;
+
+			Token operator*() const;
+
+			const_iterator& operator++();
+			const_iterator operator++(int);
+
+			bool operator==(const const_iterator& other) const { return index == other.index; }
+			bool operator!=(const const_iterator& other) const { return index != other.index; }
+		private:
+			friend class TokenStream;
+
+			const_iterator(const TokenStream* owner, size_t index);
+
+			const TokenStream* stream = nullptr;
+			size_t index = 0;
+
+			//running indices into lengths and lineMarks, so iteration never needs
+			//to count bits or binary search
+			size_t lengthIndex = 0;
+			size_t markIndex = 0;
+		};
+	private:
+		std::vector<std::uint8_t> types;
+		std::vector<std::uint32_t> positions;
+
+		//lengths of tokens that carry one, in token order
+		std::vector<std::uint32_t> lengths;
+
+		//one bit per token, set if the token has entry in lengths
+		std::vector<std::uint64_t> lengthBits;
+
+		//number of entries in lengths before given block of 64 tokens
+		std::vector<std::uint32_t> lengthBase;
+
+		std::vector<LineMark> lineMarks;
+
+		//returns index of mark that applies to given position
+		size_t _findMark(size_t position) const;
+	public:
+		TokenStream() = default;
+
+		//appends token, to be called by lexer
+		void push(Token::Type type, size_t position, size_t length = 0)
+		{
+			auto index = types.size();
+			if(!(index & 63))
+			{
+				lengthBits.push_back(0);
+				lengthBase.push_back(static_cast<std::uint32_t>(lengths.size()));
+			}
+
+			types.push_back(static_cast<std::uint8_t>(type));
+			positions.push_back(static_cast<std::uint32_t>(position));
+
+			if(tokenHasLength(type))
+			{
+				lengthBits.back() |= std::uint64_t(1) << (index & 63);
+				lengths.push_back(static_cast<std::uint32_t>(length));
+			}
+		}
+
+		//records that starting at position, tokens lie at given line
+		//positions have to be passed in increasing order
+		void markLine(size_t position, size_t line)
+		{
+			lineMarks.push_back({ static_cast<std::uint32_t>(position), static_cast<std::uint32_t>(line) });
+		}
+
+		//removes all tokens and line marks, but keeps the allocated memory
+		void clear();
+
+		//reserves memory for given number of tokens
+		void reserve(size_t tokenCount);
+
+		size_t size() const { return types.size(); }
+		bool empty() const { return types.empty(); }
+
+		Token::Type type(size_t index) const { return static_cast<Token::Type>(types[index]); }
+		size_t position(size_t index) const { return positions[index]; }
+		size_t length(size_t index) const;
+		size_t line(size_t index) const;
+
+		//builds Token out of the stored data, same as what Lexer::TokenList would hold
+		Token operator[](size_t index) const;
+
+		const_iterator begin() const;
+		const_iterator end() const;
+
+		//returns number of bytes held by the stream(not counting unused capacity)
+		size_t memoryUsage() const;
+
+		//converts into the classic array of Token
+		std::vector<Token> toTokenList() const;
+	};
+}
+
+#endif	//_JH_HEADER_TOKENSTREAM_
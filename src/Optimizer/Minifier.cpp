@@ -0,0 +1,324 @@
+#include "Minifier.hpp"
+#include <algorithm>
+
+namespace jh{
+	namespace{
+		//functions named by strings, kept only until the names are given out
+		constexpr std::uint32_t keptSlot = 0xFFFFFFFE;
+
+		//names Jass reads as something else
+		constexpr std::string_view keywords[] = {
+			"and", "or", "not", "if", "then", "else", "elseif", "endif", "loop", "endloop",
+			"exitwhen", "set", "call", "local", "return", "function", "endfunction", "takes",
+			"returns", "nothing", "native", "constant", "globals", "endglobals", "type", "extends",
+			"array", "true", "false", "null", "debug", "integer", "real", "boolean", "string",
+			"handle", "code", "this",
+		};
+
+		//names of common.j and blizzard.j without underscore of at most 4 characters,
+		//generated names only get longer past 12 million symbols, setNatives adds the rest
+		constexpr std::string_view nativeNames[] = {
+			"unit", "item", "race", "rect", "buff",
+			"Or", "And", "Not", "Sin", "Cos", "Tan", "Asin", "Acos", "Atan", "Pow",
+			"I2R", "R2I", "I2S", "R2S", "S2I", "S2R", "R2SW", "Rect",
+		};
+
+		//first character is a letter, the rest letter or digit
+		constexpr std::string_view firstCharacters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+		constexpr std::string_view characters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+		//index-th identifier, shorter ones first
+		std::string candidate(size_t index)
+		{
+			size_t count = firstCharacters.size();
+			size_t length = 1;
+			while(index >= count)
+			{
+				index -= count;
+				count *= characters.size();
+				++length;
+			}
+
+			std::string text(length, ' ');
+			text[0] = firstCharacters[index % firstCharacters.size()];
+			index /= firstCharacters.size();
+			for(size_t i = 1; i < length; ++i)
+			{
+				text[i] = characters[index % characters.size()];
+				index /= characters.size();
+			}
+
+			return text;
+		}
+	}
+
+	bool Minifier::_renames(SymbolIndex symbol) const
+	{
+		const auto& declaration = names->getTable()[symbol];
+		switch(declaration.kind)
+		{
+			case SymbolKind::Global:
+			case SymbolKind::Member:
+				return true;
+			case SymbolKind::Method:
+			{
+				//the generator calls allocator of the struct by its mangled name
+				auto text = ast->text(declaration.node);
+				return text != "allocate" && text != "deallocate";
+			}
+			case SymbolKind::Local:
+			case SymbolKind::Parameter:
+				//uses of this are not bound to it, they are written as they are
+				return ast->text(declaration.node) != "this";
+			case SymbolKind::Function:
+			{
+				//the game calls these by name
+				auto text = ast->text(declaration.node);
+				return text != "main" && text != "config" && slots[symbol] != keptSlot;
+			}
+			default:
+				return false;
+		}
+	}
+
+	void Minifier::_reserve()
+	{
+		for(auto keyword : keywords)
+			reserved.intern(keyword);
+
+		for(auto name : nativeNames)
+			reserved.intern(name);
+
+		//names of natives of common.j and functions of blizzard.j are not declared
+		for(NodeIndex node = 0; node < ast->size(); ++node)
+		{
+			auto kind = (*ast)[node].kind;
+			if((kind == NodeKind::Name || kind == NodeKind::TypeRef) && names->symbolOf(node) == noSymbol)
+				reserved.intern(ast->text(node));
+		}
+
+		const auto& table = names->getTable();
+		for(SymbolIndex symbol = 0; symbol < table.size(); ++symbol)
+		{
+			if(slots[symbol] == noSlot || slots[symbol] == keptSlot)
+				reserved.intern(table.name(table[symbol].outputName));
+		}
+	}
+
+	void Minifier::_generate(size_t slot)
+	{
+		while(generated.size() <= slot)
+		{
+			auto text = candidate(nextCandidate++);
+			if(reserved.find(text) == Interner::invalidSymbol && (!natives || natives->find(text) == Interner::invalidSymbol))
+				generated.push_back(std::move(text));
+		}
+	}
+
+	std::uint32_t Minifier::_nameNodes(std::uint32_t first)
+	{
+		const auto& table = names->getTable();
+		auto slot = first;
+		for(SymbolIndex symbol = 0; symbol < table.size(); ++symbol)
+		{
+			if(table[symbol].kind != SymbolKind::Struct)
+				continue;
+
+			//structs extending array and the ones with allocator block get no allocator
+			auto node = table[symbol].node;
+			auto parent = ast->child(node, 0);
+			bool allocates = parent == noNode || ast->token(parent).type != Token::Type::Keyword_array;
+			for(auto declaration : ast->children(ast->child(node, 1)))
+				allocates = allocates && (declaration == noNode || (*ast)[declaration].kind != NodeKind::Allocator);
+
+			if(allocates)
+			{
+				nodeSlots[node] = slot;
+				namedNodes.emplace_back(node, symbol);
+				slot += structNameCount;
+			}
+
+			for(NodeIndex method = ast->subtreeStart(node); method < node; ++method)
+			{
+				const auto& current = (*ast)[method];
+				if(current.kind == NodeKind::Method &&
+				   (current.flags & (NodeFlag::Operator | NodeFlag::Constructor | NodeFlag::Destructor)))
+				{
+					nodeSlots[method] = slot++;
+					namedNodes.emplace_back(method, symbol);
+				}
+			}
+		}
+
+		return slot;
+	}
+
+	void Minifier::_writeNodeName(OutputBuffer& out, NodeIndex node, SymbolIndex owner, size_t part) const
+	{
+		const auto& table = names->getTable();
+		out.write(table.name(table.getScope(table[owner].body).publicPrefix));
+
+		//the same as JassGenerator writes without minifier
+		const auto& current = (*ast)[node];
+		if(current.kind == NodeKind::Struct)
+			out.write(structSuffixes[part]);
+		else if(current.flags & NodeFlag::Constructor)
+			out.write("create");
+		else if(current.flags & NodeFlag::Destructor)
+			out.write("destroy");
+		else
+		{
+			out.write(current.flags & NodeFlag::Setter ? "_set" : "_get");
+			if(ast->token(node).type == Token::Type::Operator_LBPar)
+				out.write("index");
+			else
+			{
+				out.put('_');
+				out.write(ast->text(node));
+			}
+		}
+	}
+
+	void Minifier::setNatives(const Interner* declared)
+	{
+		natives = declared;
+	}
+
+	void Minifier::minify(const Ast& tree, const NameResolver& resolver)
+	{
+		ast = &tree;
+		names = &resolver;
+		renamedCount = 0;
+		nextCandidate = 0;
+		generated.clear();
+		reserved.clear();
+
+		const auto& table = resolver.getTable();
+		slots.assign(table.size(), noSlot);
+		uses.assign(table.size(), 0);
+		nodeSlots.assign(tree.size(), noSlot);
+		namedNodes.clear();
+
+		for(NodeIndex node = 0; node < tree.size(); ++node)
+		{
+			auto symbol = resolver.symbolOf(node);
+			if(symbol != noSymbol)
+				++uses[symbol];
+			else if((*ast)[node].kind == NodeKind::Literal && ast->token(node).type == Token::Type::Operator_string)
+			{
+				//ExecuteFunc("name") and the like
+				auto name = table.findName(ast->text(node));
+				auto named = name == Interner::invalidSymbol ? noSymbol : table.find(SymbolTable::fileScope, name);
+				if(named != noSymbol && table[named].kind == SymbolKind::Function)
+					slots[named] = keptSlot;
+			}
+		}
+
+		std::vector<SymbolIndex> locals;
+		std::vector<SymbolIndex> globals;
+		for(SymbolIndex symbol = 0; symbol < table.size(); ++symbol)
+		{
+			if(!_renames(symbol))
+				continue;
+
+			auto kind = table[symbol].kind;
+			(kind == SymbolKind::Local || kind == SymbolKind::Parameter ? locals : globals).push_back(symbol);
+		}
+
+		//slots are given out before the names exist, so that reserved names are known
+		for(auto symbol : locals)
+			slots[symbol] = 0;
+
+		for(auto symbol : globals)
+			slots[symbol] = 0;
+
+		_reserve();
+
+		//most used first, every function from the first name
+		std::sort(locals.begin(), locals.end(), [&](SymbolIndex a, SymbolIndex b){
+			if(table[a].scope != table[b].scope)
+				return table[a].scope < table[b].scope;
+
+			return uses[a] != uses[b] ? uses[a] > uses[b] : a < b;
+		});
+
+		std::sort(globals.begin(), globals.end(), [&](SymbolIndex a, SymbolIndex b){
+			return uses[a] != uses[b] ? uses[a] > uses[b] : a < b;
+		});
+
+		std::uint32_t localCount = 0;
+		for(size_t i = 0, first = 0; i < locals.size(); ++i)
+		{
+			if(table[locals[i]].scope != table[locals[first]].scope)
+				first = i;
+
+			slots[locals[i]] = static_cast<std::uint32_t>(i - first);
+			localCount = std::max(localCount, slots[locals[i]] + 1);
+		}
+
+		for(size_t i = 0; i < globals.size(); ++i)
+			slots[globals[i]] = localCount + static_cast<std::uint32_t>(i);
+
+		for(auto& slot : slots)
+		{
+			if(slot == keptSlot)
+				slot = noSlot;
+		}
+
+		auto firstNode = localCount + static_cast<std::uint32_t>(globals.size());
+		auto end = _nameNodes(firstNode);
+
+		renamedCount = locals.size() + globals.size() + (end - firstNode);
+		if(end)
+			_generate(end - 1);
+	}
+
+	void Minifier::writeMapping(OutputBuffer& out) const
+	{
+		const auto& table = names->getTable();
+		for(SymbolIndex symbol = 0; symbol < slots.size(); ++symbol)
+		{
+			if(!isRenamed(symbol))
+				continue;
+
+			const auto& declaration = table[symbol];
+			out.write(nameOf(symbol));
+			out.put('\t');
+
+			//constructors and operators have no name of their own, their line is written
+			if(declaration.kind == SymbolKind::Local || declaration.kind == SymbolKind::Parameter)
+			{
+				auto owner = table.getScope(declaration.scope).owner;
+				if(owner != noSymbol)
+					out.write(table.name(table[owner].outputName));
+				else
+				{
+					out.write("line ");
+					out.write(std::to_string(ast->token(declaration.node).line));
+				}
+
+				out.put('.');
+			}
+
+			out.write(table.name(declaration.outputName));
+			out.put('\n');
+		}
+
+		for(const auto& [node, owner] : namedNodes)
+		{
+			size_t count = (*ast)[node].kind == NodeKind::Struct ? structNameCount : 1;
+			for(size_t part = 0; part < count; ++part)
+			{
+				out.write(generated[nodeSlots[node] + part]);
+				out.put('\t');
+				_writeNodeName(out, node, owner, part);
+				out.put('\n');
+			}
+		}
+	}
+
+	size_t Minifier::getRenamedCount() const
+	{
+		return renamedCount;
+	}
+}
@@ -0,0 +1,152 @@
+#ifndef _JH_HEADER_MINIFIER_
+#define _JH_HEADER_MINIFIER_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../Core/Interner.hpp"
+#include "../Core/OutputBuffer.hpp"
+#include "../Parser/Ast.hpp"
+#include "../Semantic/NameResolver.hpp"
+
+namespace jh{
+	//globals and functions JassGenerator adds for allocator of every struct
+	enum class StructName : std::uint8_t{
+		Free,			//s__A__free
+		Count,			//s__A__count
+		Freed,			//s__A__freed
+		Allocate,		//s__A_allocate
+		Deallocate,		//s__A_deallocate
+	};
+
+	constexpr size_t structNameCount = 5;
+
+	//what follows prefix of the struct in every StructName
+	constexpr std::string_view structSuffixes[structNameCount] = {
+		"_free", "_count", "_freed", "allocate", "deallocate",
+	};
+
+	/*
+		Shortest names for functions, globals and locals of single resolved tree
+
+		The game hashes every identifier it looks up, so shorter names make maps load
+		and run faster. Every symbol the file declares gets new name, apart from main,
+		config, natives, types and functions some string literal names(ExecuteFunc).
+		The names used most get the shortest ones. Functions and globals that the
+		generator adds for structs, allocators, constructors, destructors and method
+		operators, have no symbol, they get names after the globals.
+
+		Locals and parameters of every function are named from the first names again,
+		globals and functions take the names after the most any function needs, so
+		local never hides global. Generated names have no underscore, which keeps them
+		apart from every mangled name(s__A_x, Lib__x), and names the file uses without
+		declaring them, keywords, names of common.j and blizzard.j and the names that
+		are kept are skipped.
+
+		JassGenerator writes the new names in place of the output names, see
+		setMinifier, and writeMapping lists them to get back the original ones.
+	*/
+	class Minifier{
+		static constexpr std::uint32_t noSlot = 0xFFFFFFFF;
+
+		const Ast* ast = nullptr;
+		const NameResolver* names = nullptr;
+
+		//index of the name of every symbol in generated, noSlot if it keeps its own
+		std::vector<std::uint32_t> slots;
+
+		//number of nodes bound to every symbol
+		std::vector<std::uint32_t> uses;
+
+		//index of the name of every node the generator names itself, the first of
+		//structNameCount names for Struct, the name of constructor, destructor and
+		//method operator for Method, noSlot for the rest
+		std::vector<std::uint32_t> nodeSlots;
+
+		//nodes with slot, and the struct they belong to, in order of the slots
+		std::vector<std::pair<NodeIndex, SymbolIndex>> namedNodes;
+
+		//names generated can not be any of these
+		Interner reserved;
+
+		//names of common.j, blizzard.j and the like, nullptr if only the short ones known
+		//to the minifier are skipped
+		const Interner* natives = nullptr;
+
+		//generated names, in order of length, views of them stay valid
+		std::deque<std::string> generated;
+		size_t nextCandidate = 0;
+
+		size_t renamedCount = 0;
+
+		//returns whether symbol gets new name
+		bool _renames(SymbolIndex symbol) const;
+
+		//reserves keywords, names used without declaration and names that are kept
+		void _reserve();
+
+		//makes names up to slot, skipping the reserved ones
+		void _generate(size_t slot);
+
+		//gives slots from first to nodes the generator names itself, returns the next
+		//free slot
+		std::uint32_t _nameNodes(std::uint32_t first);
+
+		//writes name the generator gives to node of owner, part of struct or method
+		void _writeNodeName(OutputBuffer& out, NodeIndex node, SymbolIndex owner, size_t part) const;
+	public:
+		Minifier() = default;
+
+		Minifier(const Minifier&) = delete;
+		Minifier& operator=(const Minifier&) = delete;
+
+		//sets names declared outside of the file, which generated names skip as well,
+		//the minifier only reads them, so one table can be shared by every thread
+		void setNatives(const Interner* declared);
+
+		//names every symbol of tree resolved by resolver, valid until the next call
+		void minify(const Ast& tree, const NameResolver& resolver);
+
+		//returns whether symbol is written by new name
+		bool isRenamed(SymbolIndex symbol) const
+		{
+			return symbol < slots.size() && slots[symbol] != noSlot;
+		}
+
+		//returns new name of renamed symbol
+		std::string_view nameOf(SymbolIndex symbol) const { return generated[slots[symbol]]; }
+
+		//returns new name of global or function the generator adds for struct declared
+		//by node, empty if the tree is not minified
+		std::string_view structName(NodeIndex node, StructName part) const
+		{
+			if(node >= nodeSlots.size() || nodeSlots[node] == noSlot)
+				return {};
+
+			return generated[nodeSlots[node] + static_cast<size_t>(part)];
+		}
+
+		//returns new name of constructor, destructor or method operator, empty if the
+		//tree is not minified
+		std::string_view methodName(NodeIndex method) const
+		{
+			if(method >= nodeSlots.size() || nodeSlots[method] == noSlot)
+				return {};
+
+			return generated[nodeSlots[method]];
+		}
+
+		//writes one line for every renamed symbol, new name and tab followed by the
+		//output name, function.name for locals and parameters, then one for every name
+		//the generator adds
+		void writeMapping(OutputBuffer& out) const;
+
+		size_t getRenamedCount() const;
+	};
+}
+
+#endif	//_JH_HEADER_MINIFIER_
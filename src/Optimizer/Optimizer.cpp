@@ -0,0 +1,913 @@
+#include "Optimizer.hpp"
+#include "../Lexer/LiteralDecoder.hpp"
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+namespace jh{
+	namespace{
+		//states of values for globals, apart from index of the value
+		constexpr std::uint32_t notConstant = 0xFFFFFFFE;
+		constexpr std::uint32_t folding = 0xFFFFFFFD;
+
+		constexpr std::int32_t minInteger = std::numeric_limits<std::int32_t>::min();
+
+		//longest string literal the game reads
+		constexpr size_t maxStringLength = 1023;
+
+		//integer arithmetic of the game wraps around
+		std::int32_t wrap(std::uint32_t value)
+		{
+			return static_cast<std::int32_t>(value);
+		}
+	}
+
+	void Optimizer::setOptions(const Options& newOptions)
+	{
+		options = newOptions;
+	}
+
+	void Optimizer::_collect(NodeIndex block)
+	{
+		for(auto declaration : ast->children(block))
+		{
+			if(declaration == noNode)
+				continue;
+
+			const auto& node = (*ast)[declaration];
+			switch(node.kind)
+			{
+				case NodeKind::Globals:
+					for(auto variable : ast->children(declaration))
+						globals.push_back(variable);
+
+					break;
+				case NodeKind::Function:
+					functions.push_back(declaration);
+					break;
+				case NodeKind::Library:
+					if(ast->child(declaration, 0) != noNode)
+						initializers.push_back(ast->child(declaration, 0));
+
+					_collect(ast->child(declaration, 2));
+					break;
+				case NodeKind::Scope:
+					if(ast->child(declaration, 0) != noNode)
+						initializers.push_back(ast->child(declaration, 0));
+
+					_collect(ast->child(declaration, 1));
+					break;
+				case NodeKind::Struct:
+					structs.push_back(declaration);
+					_collect(ast->child(declaration, 1));
+					break;
+				case NodeKind::Allocator:
+					_collect(ast->child(declaration, 0));
+					break;
+				case NodeKind::Method:
+					methods.push_back(declaration);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	bool Optimizer::_valueOf(NodeIndex node, Constant& value) const
+	{
+		if(node == noNode)
+			return false;
+
+		if(values[node] != noValue)
+		{
+			value = constants[values[node]];
+			return true;
+		}
+
+		if((*ast)[node].kind != NodeKind::Literal)
+			return false;
+
+		LiteralValue literal;
+		switch(ast->token(node).type)
+		{
+			case Token::Type::Literal_int:
+				literal = decodeInteger(ast->text(node));
+				value.kind = ConstantKind::Integer;
+				value.integer = wrap(static_cast<std::uint32_t>(literal.integer));
+				return !literal.overflow;
+			case Token::Type::Operator_rawcode:
+				literal = decodeRawcode(ast->text(node));
+				value.kind = ConstantKind::Integer;
+				value.integer = wrap(static_cast<std::uint32_t>(literal.integer));
+				return !literal.overflow;
+			case Token::Type::Literal_real:
+				literal = decodeReal(ast->text(node));
+				value.kind = ConstantKind::Real;
+				value.real = static_cast<float>(literal.real);
+				return !literal.overflow && std::isfinite(value.real);
+			case Token::Type::Literal_bool_true:
+			case Token::Type::Literal_bool_false:
+				value.kind = ConstantKind::Boolean;
+				value.integer = ast->token(node).type == Token::Type::Literal_bool_true;
+				return true;
+			case Token::Type::Operator_string:
+				value.kind = ConstantKind::String;
+				value.text = ast->text(node);
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	bool Optimizer::_valueOfGlobal(NodeIndex variable, Constant& value)
+	{
+		auto& state = values[variable];
+		if(state == noValue)
+		{
+			auto initializer = ast->child(variable, 1);
+			state = folding;
+
+			//the initializer is folded like any other expression, only once
+			if(initializer != noNode)
+				_foldRange(ast->subtreeStart(initializer), initializer + 1);
+
+			//integer initializer of real is real, the other way round it is an error
+			Constant result;
+			bool real = ast->text(ast->child(variable, 0)) == "real";
+			bool constant = _valueOf(initializer, result);
+			if(constant && real && result.kind == ConstantKind::Integer)
+			{
+				result.kind = ConstantKind::Real;
+				result.real = static_cast<float>(result.integer);
+			}
+			else if(constant && !real && result.kind == ConstantKind::Real)
+				constant = false;
+
+			if(constant)
+			{
+				values[variable] = static_cast<std::uint32_t>(constants.size());
+				constants.push_back(result);
+				foldedTexts.emplace_back();
+			}
+			else
+				values[variable] = notConstant;
+		}
+
+		//folding means the initializer uses the global itself
+		if(values[variable] == notConstant || values[variable] == folding)
+			return false;
+
+		value = constants[values[variable]];
+		return true;
+	}
+
+	bool Optimizer::_foldBinary(Token::Type type, const Constant& left, const Constant& right, Constant& result)
+	{
+		if(left.kind == ConstantKind::String || right.kind == ConstantKind::String)
+		{
+			if(left.kind != right.kind)
+				return false;
+
+			result.kind = ConstantKind::Boolean;
+			switch(type)
+			{
+				case Token::Type::Operator_plus:
+					if(left.text.size() + right.text.size() > maxStringLength)
+						return false;
+
+					strings.emplace_back(left.text);
+					strings.back() += right.text;
+					result.kind = ConstantKind::String;
+					result.text = strings.back();
+					return true;
+				default:
+					break;
+			}
+
+			//escapes could spell the same string differently
+			if(left.text.find('\\') != std::string_view::npos || right.text.find('\\') != std::string_view::npos)
+				return false;
+
+			switch(type)
+			{
+				case Token::Type::Operator_equal:
+					result.integer = left.text == right.text;
+					return true;
+				case Token::Type::Operator_notequal:
+					result.integer = left.text != right.text;
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		if(left.kind == ConstantKind::Boolean || right.kind == ConstantKind::Boolean)
+		{
+			if(left.kind != right.kind)
+				return false;
+
+			result.kind = ConstantKind::Boolean;
+			switch(type)
+			{
+				case Token::Type::Keyword_and:
+					result.integer = left.integer && right.integer;
+					return true;
+				case Token::Type::Keyword_or:
+					result.integer = left.integer || right.integer;
+					return true;
+				case Token::Type::Operator_equal:
+					result.integer = left.integer == right.integer;
+					return true;
+				case Token::Type::Operator_notequal:
+					result.integer = left.integer != right.integer;
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		if(left.kind == ConstantKind::Real || right.kind == ConstantKind::Real)
+		{
+			//integer operand is converted, as the game does
+			float a = left.kind == ConstantKind::Real ? left.real : static_cast<float>(left.integer);
+			float b = right.kind == ConstantKind::Real ? right.real : static_cast<float>(right.integer);
+
+			result.kind = ConstantKind::Real;
+			switch(type)
+			{
+				case Token::Type::Operator_plus:
+					result.real = a + b;
+					break;
+				case Token::Type::Operator_minus:
+					result.real = a - b;
+					break;
+				case Token::Type::Operator_multiply:
+					result.real = a * b;
+					break;
+				case Token::Type::Operator_divide:
+					if(b == 0.0f)
+						return false;
+
+					result.real = a / b;
+					break;
+				default:
+					result.kind = ConstantKind::Boolean;
+					break;
+			}
+
+			if(result.kind == ConstantKind::Real)
+				return std::isfinite(result.real);
+
+			//== and != of reals have tolerance in game, they are not folded
+			switch(type)
+			{
+				case Token::Type::Operator_less:
+					result.integer = a < b;
+					return true;
+				case Token::Type::Operator_bigger:
+					result.integer = a > b;
+					return true;
+				case Token::Type::Operator_lessequal:
+					result.integer = a <= b;
+					return true;
+				case Token::Type::Operator_biggerequal:
+					result.integer = a >= b;
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		auto a = left.integer;
+		auto b = right.integer;
+		auto ua = static_cast<std::uint32_t>(a);
+		auto ub = static_cast<std::uint32_t>(b);
+
+		result.kind = ConstantKind::Integer;
+		switch(type)
+		{
+			case Token::Type::Operator_plus:
+				result.integer = wrap(ua + ub);
+				return true;
+			case Token::Type::Operator_minus:
+				result.integer = wrap(ua - ub);
+				return true;
+			case Token::Type::Operator_multiply:
+				result.integer = wrap(ua * ub);
+				return true;
+			case Token::Type::Operator_divide:
+				//division by zero stops the thread in game, it has to stay
+				if(b == 0 || (a == minInteger && b == -1))
+					return false;
+
+				result.integer = a / b;
+				return true;
+			case Token::Type::Operator_modulo:
+				//ModuloInteger, the result has sign of the divisor
+				if(b == 0 || (a == minInteger && b == -1))
+					return false;
+
+				result.integer = a % b;
+				if(result.integer < 0)
+					result.integer = wrap(static_cast<std::uint32_t>(result.integer) + ub);
+
+				return true;
+			default:
+				break;
+		}
+
+		result.kind = ConstantKind::Boolean;
+		switch(type)
+		{
+			case Token::Type::Operator_equal:
+				result.integer = a == b;
+				return true;
+			case Token::Type::Operator_notequal:
+				result.integer = a != b;
+				return true;
+			case Token::Type::Operator_less:
+				result.integer = a < b;
+				return true;
+			case Token::Type::Operator_bigger:
+				result.integer = a > b;
+				return true;
+			case Token::Type::Operator_lessequal:
+				result.integer = a <= b;
+				return true;
+			case Token::Type::Operator_biggerequal:
+				result.integer = a >= b;
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	bool Optimizer::_fold(NodeIndex node, Constant& result)
+	{
+		switch((*ast)[node].kind)
+		{
+			case NodeKind::Paren:
+				return _valueOf(ast->child(node, 0), result);
+			case NodeKind::Unary:
+				return _valueOf(ast->child(node, 0), result) && _foldUnary(ast->token(node).type, result);
+			case NodeKind::Binary:
+			{
+				Constant left;
+				Constant right;
+				return _valueOf(ast->child(node, 0), left) && _valueOf(ast->child(node, 1), right) &&
+					   _foldBinary(ast->token(node).type, left, right, result);
+			}
+			case NodeKind::Name:
+			{
+				auto symbol = names->symbolOf(node);
+				if(symbol == noSymbol || substitutes[symbol] == noNode)
+					return false;
+
+				return _valueOfGlobal(substitutes[symbol], result);
+			}
+			default:
+				return false;
+		}
+	}
+
+	bool Optimizer::_foldUnary(Token::Type type, Constant& result) const
+	{
+		switch(type)
+		{
+			case Token::Type::Keyword_not:
+				result.integer = !result.integer;
+				return result.kind == ConstantKind::Boolean;
+			case Token::Type::Operator_minus:
+				if(result.kind == ConstantKind::Real)
+				{
+					result.real = -result.real;
+					return true;
+				}
+
+				result.integer = wrap(0u - static_cast<std::uint32_t>(result.integer));
+				return result.kind == ConstantKind::Integer;
+			default:
+				return result.kind == ConstantKind::Integer || result.kind == ConstantKind::Real;
+		}
+	}
+
+	bool Optimizer::_foldInlined(NodeIndex node, NodeIndex target, NodeIndex call, Constant& result)
+	{
+		if(node == noNode)
+			return false;
+
+		if(_valueOf(node, result))
+			return true;
+
+		switch((*ast)[node].kind)
+		{
+			case NodeKind::Paren:
+				return _foldInlined(ast->child(node, 0), target, call, result);
+			case NodeKind::Unary:
+				return _foldInlined(ast->child(node, 0), target, call, result) &&
+					   _foldUnary(ast->token(node).type, result);
+			case NodeKind::Binary:
+			{
+				Constant left;
+				Constant right;
+				return _foldInlined(ast->child(node, 0), target, call, left) &&
+					   _foldInlined(ast->child(node, 1), target, call, right) &&
+					   _foldBinary(ast->token(node).type, left, right, result);
+			}
+			case NodeKind::Name:
+			{
+				auto symbol = names->symbolOf(node);
+				if(symbol == noSymbol || names->getTable()[symbol].kind != SymbolKind::Parameter)
+					return _fold(node, result);
+
+				auto parameters = ast->children(ast->child(target, 0));
+				for(size_t i = 0; i < parameters.size(); ++i)
+				{
+					if(parameters[i] == names->getTable()[symbol].node)
+						return _valueOf(ast->child(call, i + 1), result);
+				}
+
+				return false;
+			}
+			default:
+				return false;
+		}
+	}
+
+	bool Optimizer::_spell(const Constant& value, std::string& text) const
+	{
+		switch(value.kind)
+		{
+			case ConstantKind::Integer:
+				//the literal would be out of range
+				if(value.integer == minInteger)
+					return false;
+
+				text = std::to_string(value.integer);
+				return true;
+			case ConstantKind::Real:
+			{
+				//shortest text that reads back as the same float, Jass has no exponent
+				char buffer[64];
+				auto end = std::to_chars(buffer, buffer + sizeof(buffer), value.real).ptr;
+				text.assign(buffer, end);
+				if(text.find_first_of("eEn") != std::string::npos)
+					return false;
+
+				if(text.find('.') == std::string::npos)
+					text += '.';
+
+				return true;
+			}
+			case ConstantKind::Boolean:
+				text = value.integer ? "true" : "false";
+				return true;
+			case ConstantKind::String:
+				text.assign(1, '"');
+				text += value.text;
+				text += '"';
+				return true;
+		}
+
+		return false;
+	}
+
+	bool Optimizer::_foldRange(NodeIndex first, NodeIndex last)
+	{
+		bool changed = false;
+		for(NodeIndex node = first; node < last; ++node)
+		{
+			//nodes with value are done already, when expressions around inlined calls
+			//are folded again
+			auto kind = (*ast)[node].kind;
+			if(kind != NodeKind::Binary && kind != NodeKind::Unary && kind != NodeKind::Paren && kind != NodeKind::Name)
+				continue;
+
+			Constant value;
+			if(values[node] != noValue || !_fold(node, value))
+				continue;
+
+			//-5 and (5) are written as they are already, and would only stop the function
+			//from being copied
+			bool unary = kind == NodeKind::Unary && ast->token(node).type == Token::Type::Operator_minus;
+			bool literal = (unary || kind == NodeKind::Paren) && (*ast)[ast->child(node, 0)].kind == NodeKind::Literal;
+			changed = _setValue(node, value, !literal) || changed;
+		}
+
+		return changed;
+	}
+
+	bool Optimizer::_setValue(NodeIndex node, const Constant& value, bool written)
+	{
+		values[node] = static_cast<std::uint32_t>(constants.size());
+		constants.push_back(value);
+		foldedTexts.emplace_back();
+
+		std::string text;
+		if(!written || !_spell(value, text))
+			return false;
+
+		strings.push_back(std::move(text));
+		foldedTexts.back() = strings.back();
+		marks[node] |= Folded;
+		++foldedCount;
+		return true;
+	}
+
+	bool Optimizer::_hasCall(NodeIndex first, NodeIndex last) const
+	{
+		for(NodeIndex node = first; node < last; ++node)
+		{
+			if((*ast)[node].kind == NodeKind::Call)
+				return true;
+		}
+
+		return false;
+	}
+
+	void Optimizer::_markInlinable(NodeIndex function)
+	{
+		const auto& table = names->getTable();
+		auto text = ast->text(function);
+		if(text == "main" || text == "config")
+			return;
+
+		auto statements = ast->children(ast->child(function, 2));
+		if(statements.size() != 1 || ((*ast)[statements[0]].flags & NodeFlag::Debug))
+			return;
+
+		//single return of value, or single call or set of function returning nothing
+		auto statement = statements[0];
+		auto kind = (*ast)[statement].kind;
+		auto returnType = ast->child(function, 1);
+		bool returns = returnType != noNode && ast->text(returnType) != "nothing";
+		if(returns ? kind != NodeKind::Return || ast->child(statement, 0) == noNode :
+					 kind != NodeKind::CallStatement && kind != NodeKind::Set)
+			return;
+
+		NodeIndex start = ast->subtreeStart(statement);
+		if(statement - start + 1 > options.inlineSize && !((*ast)[function].flags & NodeFlag::Inline))
+			return;
+
+		if(kind == NodeKind::Set)
+		{
+			auto target = names->symbolOf(ast->child(statement, 0));
+			if(target != noSymbol && table[target].kind == SymbolKind::Parameter)
+				return;
+		}
+
+		//integer passed as real would be divided as integer once the conversion is gone
+		auto parameters = ast->children(ast->child(function, 0));
+		if(returns && ast->text(returnType) == "real")
+			return;
+
+		for(auto parameter : parameters)
+		{
+			if(ast->text(ast->child(parameter, 0)) == "real")
+				return;
+		}
+
+		//every parameter exactly once, in order, the arguments are then evaluated once
+		//and in the same order as before, and(or) could skip some of them
+		auto self = names->symbolOf(function);
+		size_t next = 0;
+		bool pure = true;
+		for(NodeIndex node = start; node < statement; ++node)
+		{
+			auto nodeKind = (*ast)[node].kind;
+			auto type = ast->token(node).type;
+			pure = pure && nodeKind != NodeKind::Call &&
+				   !(nodeKind == NodeKind::Binary && (type == Token::Type::Keyword_and || type == Token::Type::Keyword_or));
+			if(nodeKind != NodeKind::Name)
+				continue;
+
+			auto symbol = names->symbolOf(node);
+			if(symbol == self)
+				return;
+
+			if(symbol != noSymbol && table[symbol].kind == SymbolKind::Parameter)
+			{
+				if(next >= parameters.size() || parameters[next] != table[symbol].node)
+					return;
+
+				++next;
+			}
+			else if(symbol == noSymbol || !(table[symbol].flags & NodeFlag::Constant))
+				pure = false;
+		}
+
+		if(next != parameters.size())
+			return;
+
+		marks[function] |= Inlinable | (pure ? Pure : 0);
+		if(self != noSymbol)
+			substitutes[self] = function;
+	}
+
+	void Optimizer::_markCalls(NodeIndex function)
+	{
+		NodeIndex start = ast->subtreeStart(function);
+
+		for(NodeIndex node = start; node < function; ++node)
+		{
+			if((*ast)[node].kind == NodeKind::CallStatement)
+				marks[ast->child(node, 0)] |= StatementCall;
+		}
+
+		//expressions around calls folded below are folded again, (Add(1, 2) + 1) * 2
+		bool refold = false;
+		for(NodeIndex call = start; call < function; ++call)
+		{
+			if((*ast)[call].kind != NodeKind::Call)
+			{
+				if(refold)
+					_foldRange(call, call + 1);
+
+				continue;
+			}
+
+			auto callee = ast->child(call, 0);
+			auto symbol = (*ast)[callee].kind == NodeKind::Name ? names->symbolOf(callee) : noSymbol;
+			if(symbol == noSymbol || substitutes[symbol] == noNode)
+				continue;
+
+			//functions declared later could be inlined into each other forever
+			auto target = substitutes[symbol];
+			if(target >= function)
+				continue;
+
+			auto arguments = ast->children(call);
+			if(arguments.size() - 1 != ast->children(ast->child(target, 0)).size())
+				continue;
+
+			//statement can not be written as call, unless it is call itself
+			auto body = ast->child(ast->child(target, 2), 0);
+			bool statementCall = marks[call] & StatementCall;
+			if((*ast)[body].kind == NodeKind::Return ?
+			   statementCall && (*ast)[ast->child(body, 0)].kind != NodeKind::Call : !statementCall)
+				continue;
+
+			//calls in arguments could see globals changed by the body before them, or be
+			//skipped by its and(or), R2(1, Bump()) with return g + a + b reads g before
+			//Bump runs, AndF(false, Bump() > 0) with return a and b never runs it
+			bool ordered = marks[target] & Pure;
+			if(!ordered)
+			{
+				ordered = true;
+				for(size_t i = 1; i < arguments.size(); ++i)
+					ordered = ordered && !_hasCall(ast->subtreeStart(arguments[i]), arguments[i] + 1);
+			}
+
+			if(!ordered)
+				continue;
+
+			if(_shadows(function, target))
+				continue;
+
+			marks[call] |= Inlined;
+			marks[callee] |= InlinedCallee;
+			marks[function] |= Rewritten;
+			++inlinedCount;
+
+			//pure body of constant arguments is constant too, Add(1, 2) is written as 3
+			Constant value;
+			if(options.fold && (marks[target] & Pure) && (*ast)[body].kind == NodeKind::Return &&
+			   _foldInlined(ast->child(body, 0), target, call, value))
+			{
+				_setValue(call, value, true);
+				refold = true;
+			}
+		}
+	}
+
+	bool Optimizer::_shadows(NodeIndex function, NodeIndex target) const
+	{
+		const auto& table = names->getTable();
+		auto statement = ast->child(ast->child(target, 2), 0);
+		NodeIndex start = ast->subtreeStart(function);
+
+		for(NodeIndex node = ast->subtreeStart(statement); node < statement; ++node)
+		{
+			auto symbol = (*ast)[node].kind == NodeKind::Name ? names->symbolOf(node) : noSymbol;
+			if(symbol == noSymbol || table[symbol].kind == SymbolKind::Parameter)
+				continue;
+
+			auto name = names->outputName(node);
+			for(NodeIndex local = start; local < function; ++local)
+			{
+				auto kind = (*ast)[local].kind;
+				if((kind == NodeKind::Local || kind == NodeKind::Parameter) && ast->text(local) == name)
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	void Optimizer::_use(SymbolIndex symbol, std::vector<NodeIndex>& pending)
+	{
+		if(symbol == noSymbol)
+			return;
+
+		const auto& declaration = names->getTable()[symbol];
+		if(declaration.kind != SymbolKind::Function && declaration.kind != SymbolKind::Global)
+			return;
+
+		marks[declaration.node] |= Reachable;
+		if(!(marks[declaration.node] & Scanned))
+		{
+			marks[declaration.node] |= Scanned;
+			pending.push_back(declaration.node);
+		}
+	}
+
+	void Optimizer::_markReachable(bool hasMain)
+	{
+		if(!options.removeUnused || !hasMain)
+			return;
+
+		const auto& table = names->getTable();
+		std::vector<NodeIndex> pending;
+
+		for(auto function : functions)
+		{
+			auto text = ast->text(function);
+			if(text == "main" || text == "config")
+				_use(names->symbolOf(function), pending);
+		}
+
+		for(auto initializer : initializers)
+			_use(names->symbolOf(initializer), pending);
+
+		//methods are written with their structs
+		for(auto declaration : structs)
+			pending.push_back(declaration);
+
+		//initializers calling functions are kept, for whatever the calls do
+		for(auto variable : globals)
+		{
+			auto initializer = ast->child(variable, 1);
+			if(initializer != noNode && _hasCall(ast->subtreeStart(initializer), initializer + 1))
+				_use(names->symbolOf(variable), pending);
+		}
+
+		while(pending.size())
+		{
+			auto declaration = pending.back();
+			pending.pop_back();
+
+			//backwards, so that folded expressions are skipped as a whole
+			NodeIndex first = ast->subtreeStart(declaration);
+			for(NodeIndex node = declaration; node-- > first;)
+			{
+				auto mark = marks[node];
+				if(mark & Folded)
+				{
+					node = ast->subtreeStart(node);
+					continue;
+				}
+
+				const auto& current = (*ast)[node];
+				if(current.kind == NodeKind::Name)
+				{
+					auto symbol = names->symbolOf(node);
+					if(!(mark & InlinedCallee))
+						_use(symbol, pending);
+					else if(!(marks[table[symbol].node] & Scanned))
+					{
+						//body of inlined function is part of the caller
+						marks[table[symbol].node] |= Scanned;
+						pending.push_back(table[symbol].node);
+					}
+				}
+				else if(current.kind == NodeKind::Literal && ast->token(node).type == Token::Type::Operator_string)
+				{
+					//ExecuteFunc("name") and the like
+					auto name = table.findName(ast->text(node));
+					if(name != Interner::invalidSymbol)
+						_use(table.find(SymbolTable::fileScope, name), pending);
+				}
+			}
+		}
+
+		for(auto function : functions)
+		{
+			if(!(marks[function] & Reachable))
+			{
+				marks[function] |= Removed;
+				++removedCount;
+			}
+		}
+
+		for(auto variable : globals)
+		{
+			if(!(marks[variable] & Reachable))
+			{
+				marks[variable] |= Removed;
+				++removedCount;
+			}
+		}
+	}
+
+	void Optimizer::optimize(const Ast& tree, const NameResolver& resolver)
+	{
+		ast = &tree;
+		names = &resolver;
+		foldedCount = 0;
+		inlinedCount = 0;
+		removedCount = 0;
+
+		marks.assign(tree.size(), 0);
+		values.assign(tree.size(), noValue);
+		constants.clear();
+		foldedTexts.clear();
+		strings.clear();
+		functions.clear();
+		methods.clear();
+		globals.clear();
+		structs.clear();
+		initializers.clear();
+
+		if(tree.getRoot() == noNode)
+			return;
+
+		_collect(tree.getRoot());
+
+		//constant globals and constant static members, replaced by their value
+		const auto& table = resolver.getTable();
+		substitutes.assign(table.size(), noNode);
+		for(SymbolIndex symbol = 0; symbol < table.size(); ++symbol)
+		{
+			const auto& declaration = table[symbol];
+			bool global = declaration.kind == SymbolKind::Global ||
+						  (declaration.kind == SymbolKind::Member && (declaration.flags & NodeFlag::Static));
+
+			if(global && (declaration.flags & NodeFlag::Constant) && !(declaration.flags & NodeFlag::Array))
+				substitutes[symbol] = declaration.node;
+		}
+
+		if(options.fold)
+		{
+			Constant value;
+			for(auto variable : globals)
+				_valueOfGlobal(variable, value);
+
+			for(const auto* list : { &functions, &methods })
+			{
+				for(auto function : *list)
+				{
+					if(_foldRange(ast->subtreeStart(function), function))
+						marks[function] |= Rewritten;
+				}
+			}
+
+			//members of structs are folded as globals, they are not in any function
+			for(auto declaration : structs)
+			{
+				for(NodeIndex node = ast->subtreeStart(declaration); node < declaration; ++node)
+				{
+					if((*ast)[node].kind == NodeKind::Variable)
+						_valueOfGlobal(node, value);
+				}
+			}
+		}
+
+		bool hasMain = false;
+		for(auto function : functions)
+			hasMain = hasMain || ast->text(function) == "main";
+
+		if(options.inlineCalls)
+		{
+			for(auto function : functions)
+				_markInlinable(function);
+
+			for(const auto* list : { &functions, &methods })
+			{
+				for(auto function : *list)
+					_markCalls(function);
+			}
+		}
+
+		_markReachable(hasMain);
+	}
+
+	bool Optimizer::isRemoved(NodeIndex declaration) const
+	{
+		return marks[declaration] & Removed;
+	}
+
+	size_t Optimizer::getFoldedCount() const
+	{
+		return foldedCount;
+	}
+
+	size_t Optimizer::getInlinedCount() const
+	{
+		return inlinedCount;
+	}
+
+	size_t Optimizer::getRemovedCount() const
+	{
+		return removedCount;
+	}
+}
@@ -0,0 +1,187 @@
+#ifndef _JH_HEADER_OPTIMIZER_
+#define _JH_HEADER_OPTIMIZER_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Parser/Ast.hpp"
+#include "../Semantic/NameResolver.hpp"
+
+namespace jh{
+	/*
+		Optimizations of single resolved tree, applied by JassGenerator as it writes
+
+		The tree is not rewritten, the optimizer only marks nodes, and the generator
+		writes marked ones differently, so that functions nothing was done to are still
+		copied from the source as they are.
+
+		Constant folding
+			Arithmetic, comparisons and logic of literals and of constant globals are
+			computed the way the game does, integers wrap at 32 bits and reals are
+			floats, and the expression is written as single literal. Comparing reals
+			by == and != is left alone, the game compares them with tolerance.
+
+		Inlining
+			Function whose body is single return, call or set, using every parameter
+			exactly once and in order, is written in place of its calls, if it is
+			marked inline or its body has at most inlineSize nodes. Only functions
+			declared before the caller are inlined, which keeps the order Jass needs
+			and rules out recursion. Inlined call of pure body with constant arguments
+			is folded, with the expressions around it.
+
+		Removing unused code
+			Only for map scripts, files with function main. Functions and globals that
+			are not reachable from main, config, initializers, methods of structs and
+			strings naming functions(ExecuteFunc) are not written.
+	*/
+	class Optimizer{
+	public:
+		struct Options{
+			bool fold = true;
+			bool inlineCalls = true;
+			bool removeUnused = true;
+
+			//functions not marked inline are inlined up to this many nodes of body
+			size_t inlineSize = 12;
+		};
+	private:
+		enum class ConstantKind : std::uint8_t{
+			Integer,
+			Real,
+			Boolean,
+			String,
+		};
+
+		struct Constant{
+			ConstantKind kind;
+			std::int32_t integer = 0;
+			float real = 0.0f;
+
+			//contents of string, without quotes
+			std::string_view text;
+		};
+
+		//bits of marks
+		enum Mark : std::uint16_t{
+			Folded			= 1 << 0,	//written as foldedText
+			Inlined			= 1 << 1,	//call written as body of the function
+			StatementCall	= 1 << 2,	//call of call statement
+			InlinedCallee	= 1 << 3,	//name of inlined function, not a use of it
+			Rewritten		= 1 << 4,	//function with folded or inlined nodes
+			Reachable		= 1 << 5,	//used function or global
+			Scanned			= 1 << 6,	//uses of declaration were marked
+			Inlinable		= 1 << 7,	//function that can be inlined
+			Pure			= 1 << 8,	//inlinable function whose body has no calls and globals
+			Removed			= 1 << 9,	//function or global that is not written
+		};
+
+		const Ast* ast = nullptr;
+		const NameResolver* names = nullptr;
+		Options options;
+
+		std::vector<std::uint16_t> marks;
+
+		//value of every constant expression, index into constants, noValue if it is not
+		//for globals the value of the initializer, computed the first time it is needed
+		std::vector<std::uint32_t> values;
+		std::vector<Constant> constants;
+
+		//Jass text of every constant, empty unless some node is folded to it
+		std::vector<std::string_view> foldedTexts;
+
+		//strings made by folding and texts of folded nodes, views of them stay valid
+		std::deque<std::string> strings;
+
+		//for every symbol, declaration its names can be replaced by, the Variable of
+		//constant global or the Function that is inlined, noNode for the rest
+		//names are looked up for every node, this keeps them off the symbol table
+		std::vector<NodeIndex> substitutes;
+
+		//declarations of the tree, see _collect, methods include members of structs
+		std::vector<NodeIndex> functions;
+		std::vector<NodeIndex> methods;
+		std::vector<NodeIndex> globals;
+		std::vector<NodeIndex> structs;
+		std::vector<NodeIndex> initializers;
+
+		size_t foldedCount = 0;
+		size_t inlinedCount = 0;
+		size_t removedCount = 0;
+
+		void _collect(NodeIndex block);
+
+		//sets value of node, decoding literals, returns false if it is not constant
+		bool _valueOf(NodeIndex node, Constant& value) const;
+
+		//folds initializer of global, once, returns false if its value is not constant
+		bool _valueOfGlobal(NodeIndex variable, Constant& value);
+
+		//computes value of every node in [first, last) from its children, returns
+		//whether any was folded
+		bool _foldRange(NodeIndex first, NodeIndex last);
+		bool _fold(NodeIndex node, Constant& result);
+		bool _foldUnary(Token::Type type, Constant& result) const;
+		bool _foldBinary(Token::Type type, const Constant& left, const Constant& right, Constant& result);
+
+		//computes node of body of inlined target with parameters taking the values of
+		//arguments of call, returns false if it is not constant
+		bool _foldInlined(NodeIndex node, NodeIndex target, NodeIndex call, Constant& result);
+
+		//sets value of node, and marks it written as literal if written is true and the
+		//value has Jass text, returns whether it was marked
+		bool _setValue(NodeIndex node, const Constant& value, bool written);
+
+		//makes Jass text of folded value
+		bool _spell(const Constant& value, std::string& text) const;
+
+		//marks function that can be inlined, and calls of function that are inlined
+		void _markInlinable(NodeIndex function);
+		void _markCalls(NodeIndex function);
+
+		//returns whether local or parameter of function hides name used by body of target
+		bool _shadows(NodeIndex function, NodeIndex target) const;
+
+		//returns whether range [first, last) has a call
+		bool _hasCall(NodeIndex first, NodeIndex last) const;
+
+		//marks everything reachable from the roots
+		void _markReachable(bool hasMain);
+		void _use(SymbolIndex symbol, std::vector<NodeIndex>& pending);
+	public:
+		static constexpr std::uint32_t noValue = 0xFFFFFFFF;
+
+		Optimizer() = default;
+
+		Optimizer(const Optimizer&) = delete;
+		Optimizer& operator=(const Optimizer&) = delete;
+
+		void setOptions(const Options& newOptions);
+
+		//optimizes tree resolved by resolver, the marks are valid until the next call
+		void optimize(const Ast& tree, const NameResolver& resolver);
+
+		//returns whether expression is written as its folded value
+		bool isFolded(NodeIndex node) const { return marks[node] & Folded; }
+
+		//returns Jass text of folded expression
+		std::string_view foldedText(NodeIndex node) const { return foldedTexts[values[node]]; }
+
+		//returns whether call is written as body of the function it calls
+		bool isInlined(NodeIndex call) const { return marks[call] & Inlined; }
+
+		//returns whether function has folded or inlined nodes, and can not be copied
+		bool isRewritten(NodeIndex function) const { return marks[function] & Rewritten; }
+
+		//returns whether function or global is not written at all
+		bool isRemoved(NodeIndex declaration) const;
+
+		size_t getFoldedCount() const;
+		size_t getInlinedCount() const;
+		size_t getRemovedCount() const;
+	};
+}
+
+#endif	//_JH_HEADER_OPTIMIZER_
@@ -0,0 +1,99 @@
+#include "Ast.hpp"
+#include "../Lexer/TokenName.hpp"
+#include "../Lexer/TokenStream.hpp"
+
+namespace jh{
+	void Ast::reset(const std::vector<Token>& tokenList, std::string_view text)
+	{
+		nodes.clear();
+		links.clear();
+		root = noNode;
+		tokens = &tokenList;
+		source = text;
+	}
+
+	void Ast::reserveFor(size_t tokenCount)
+	{
+		//function code has about 3 nodes per 4 tokens, and about as many links
+		nodes.reserve(tokenCount / 4 * 3 + 16);
+		links.reserve(tokenCount / 4 * 3 + 16);
+	}
+
+	void Ast::reserve(size_t nodeCount, size_t linkCount)
+	{
+		nodes.reserve(nodeCount);
+		links.reserve(linkCount);
+	}
+
+	NodeIndex Ast::addNode(NodeKind kind, std::uint16_t flags, size_t token, const NodeIndex* children, size_t count)
+	{
+		Node node;
+		node.kind = kind;
+		node.flags = flags;
+		node.token = static_cast<std::uint32_t>(token);
+		node.firstChild = static_cast<std::uint32_t>(links.size());
+		node.childCount = static_cast<std::uint32_t>(count);
+
+		links.insert(links.end(), children, children + count);
+		nodes.push_back(node);
+		return static_cast<NodeIndex>(nodes.size() - 1);
+	}
+
+	NodeIndex Ast::subtreeStart(NodeIndex index) const
+	{
+		//the first leaf is reached through the smallest child at every level,
+		//noNode is bigger than any index, so missing children are never picked
+		for(;;)
+		{
+			NodeIndex first = noNode;
+			for(auto child : children(index))
+				first = child < first ? child : first;
+
+			if(first == noNode)
+				return index;
+
+			index = first;
+		}
+	}
+
+	NodeIndex Ast::append(const Ast& other)
+	{
+		auto nodeBase = static_cast<NodeIndex>(nodes.size());
+		auto linkBase = static_cast<std::uint32_t>(links.size());
+
+		nodes.resize(nodes.size() + other.nodes.size());
+		auto* node = nodes.data() + nodeBase;
+		for(const auto& copied : other.nodes)
+		{
+			*node = copied;
+			node->firstChild += linkBase;
+			++node;
+		}
+
+		links.resize(links.size() + other.links.size());
+		auto* link = links.data() + linkBase;
+		for(auto copied : other.links)
+			*link++ = copied == noNode ? noNode : copied + nodeBase;
+
+		return other.root == noNode ? noNode : other.root + nodeBase;
+	}
+
+	std::string_view Ast::text(NodeIndex index) const
+	{
+		return tokenText(nodes[index].token);
+	}
+
+	std::string_view Ast::tokenText(size_t tokenIndex) const
+	{
+		const auto& token = (*tokens)[tokenIndex];
+		if(tokenHasLength(token.type))
+			return source.substr(token.position, token.length);
+
+		return tokenTypeName(token.type);
+	}
+
+	size_t Ast::getMemoryUsage() const
+	{
+		return nodes.capacity() * sizeof(Node) + links.capacity() * sizeof(NodeIndex);
+	}
+}
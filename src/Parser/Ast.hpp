@@ -0,0 +1,221 @@
+#ifndef _JH_HEADER_AST_
+#define _JH_HEADER_AST_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "../Core/Token.hpp"
+
+namespace jh{
+	using NodeIndex = std::uint32_t;
+
+	//stands in for optional child that is not there
+	constexpr NodeIndex noNode = 0xFFFFFFFF;
+
+	/*
+		Kinds of AST nodes, with the meaning of token and children of each
+
+		Children listed in [] are always present in that order, noNode standing in for
+		the ones that are optional. Children listed after ... are variable count.
+	*/
+	enum class NodeKind : std::uint8_t{
+		/*
+			Declarations
+		*/
+		File,			//... declarations
+		Globals,		//... Variable
+		Variable,		//global or struct member, token is name, [TypeRef, initial value, array size]
+		TypeDecl,		//type name extends parent, token is name, [TypeRef parent]
+		Native,			//token is name, [Parameters, TypeRef returns]
+		Function,		//token is name, [Parameters, TypeRef returns, Block]
+		Parameters,		//token is takes, ... Parameter
+		Parameter,		//token is name, [TypeRef]
+		TypeRef,		//token is name of the type(Id, thistype)
+		Library,		//token is name, [Name initializer, Requirements, Block]
+		Requirements,	//token is requires/uses/needs(or library name if there is none), ... Requirement
+		Requirement,	//token is name of required library
+		Scope,			//token is name, [Name initializer, Block]
+		Struct,			//token is name, [TypeRef extends, Block]
+		Interface,		//token is name, [Block]
+		Module,			//token is name, [Block]
+		Implement,		//token is name of the module
+		Method,			//token is name(first token after operator), [Parameters, TypeRef returns, Block, defaults value]
+		Allocator,		//token is allocator, [Block]
+		Textmacro,		//token is name, body is not parsed
+		RunTextmacro,	//token is name of the macro
+		Block,			//token is first token of the block, ... declarations or statements
+
+		/*
+			Statements
+		*/
+		Local,			//token is name, [TypeRef, initial value, array size(always noNode)]
+		Set,			//token is the operator(=, +=, ++, ...), [target, value(noNode for ++ and --)]
+		CallStatement,	//token is call(or first token of the call), [Call]
+		If,				//token is if/elseif, [condition, Block then, else(If for elseif, Block or noNode)]
+		Loop,			//token is loop, [Block]
+		Exitwhen,		//token is exitwhen, [condition]
+		Return,			//token is return, [value]
+		While,			//token is while, [condition, Block]
+		For,			//token is for, [init, condition, step, Block]
+		Break,			//token is break
+
+		/*
+			Expressions
+		*/
+		Binary,			//token is the operator, [left, right]
+		Unary,			//token is the operator(-, +, not), [operand]
+		Literal,		//token is the literal(integer, real, rawcode, string, null, true, false)
+		Name,			//token is Id, this, super or thistype
+		Call,			//token is (, [callee, ... arguments]
+		Index,			//token is [, [array, index]
+		Member,			//token is the member name, [object(noNode for .name inside struct)]
+		FunctionRef,	//token is function, [Name or Member of the function]
+		Paren,			//token is (, [expression]
+	};
+
+	//bits of Node::flags
+	namespace NodeFlag{
+		constexpr std::uint16_t Private		= 1 << 0;
+		constexpr std::uint16_t Public		= 1 << 1;
+		constexpr std::uint16_t Static		= 1 << 2;
+		constexpr std::uint16_t Constant	= 1 << 3;
+		constexpr std::uint16_t Array		= 1 << 4;
+		constexpr std::uint16_t Readonly	= 1 << 5;
+		constexpr std::uint16_t Stub		= 1 << 6;
+		constexpr std::uint16_t Operator	= 1 << 7;	//method operator
+		constexpr std::uint16_t Setter		= 1 << 8;	//method operator x= or []=
+		constexpr std::uint16_t Optional	= 1 << 9;	//optional requirement or implement
+		constexpr std::uint16_t Debug		= 1 << 10;	//debug statement
+		constexpr std::uint16_t Constructor	= 1 << 11;
+		constexpr std::uint16_t Destructor	= 1 << 12;
+		constexpr std::uint16_t Inline		= 1 << 13;
+		constexpr std::uint16_t Implicit	= 1 << 14;	//assignment or call written without set or call
+	}
+
+	//16 bytes, 4 nodes per cache line
+	struct Node{
+		NodeKind kind;
+		std::uint8_t unused = 0;
+		std::uint16_t flags;
+
+		//index into the token list the AST was parsed from
+		std::uint32_t token;
+
+		//children are childCount consecutive entries of Ast's child list from firstChild
+		std::uint32_t firstChild;
+		std::uint32_t childCount;
+	};
+
+	/*
+		Syntax tree of single file, in two flat arrays
+
+		Nodes refer to each other by index, never by pointer, and children of every node
+		are stored next to each other in one shared list. The whole tree is then just two
+		allocations that grow like vectors, instead of one allocation per node, and
+		walking it touches memory in order.
+
+		Nodes are added children first, so the root is always the last one. Nodes do not
+		hold any text, only index of token, so the token list and source the tree was
+		parsed from have to outlive it.
+	*/
+	class Ast{
+		std::vector<Node> nodes;
+		std::vector<NodeIndex> links;
+
+		NodeIndex root = noNode;
+
+		const std::vector<Token>* tokens = nullptr;
+		std::string_view source;
+	public:
+		//children of single node, usable in range-for
+		struct Children{
+			const NodeIndex* first;
+			const NodeIndex* last;
+
+			const NodeIndex* begin() const { return first; }
+			const NodeIndex* end() const { return last; }
+			size_t size() const { return last - first; }
+			NodeIndex operator[](size_t index) const { return first[index]; }
+		};
+
+		Ast() = default;
+
+		Ast(const Ast&) = delete;
+		Ast& operator=(const Ast&) = delete;
+		Ast(Ast&&) = default;
+		Ast& operator=(Ast&&) = default;
+
+		//removes all nodes, keeping the allocated memory, and binds the tree to
+		//tokens lexed from source
+		void reset(const std::vector<Token>& tokenList, std::string_view text);
+
+		//reserves memory for tree parsed from given number of tokens
+		void reserveFor(size_t tokenCount);
+
+		//reserves memory for given number of nodes and links
+		void reserve(size_t nodeCount, size_t linkCount);
+
+		//adds node with count children taken from given array, returns its index
+		NodeIndex addNode(NodeKind kind, std::uint16_t flags, size_t token, const NodeIndex* children, size_t count);
+
+		NodeIndex addNode(NodeKind kind, std::uint16_t flags, size_t token)
+		{
+			return addNode(kind, flags, token, nullptr, 0);
+		}
+
+		const Node& operator[](NodeIndex index) const { return nodes[index]; }
+		Node& operator[](NodeIndex index) { return nodes[index]; }
+
+		Children children(NodeIndex index) const
+		{
+			const auto* first = links.data() + nodes[index].firstChild;
+			return { first, first + nodes[index].childCount };
+		}
+
+		//returns n-th child of given node
+		NodeIndex child(NodeIndex index, size_t n) const
+		{
+			return links[nodes[index].firstChild + n];
+		}
+
+		//replaces n-th child of given node
+		void setChild(NodeIndex index, size_t n, NodeIndex newChild)
+		{
+			links[nodes[index].firstChild + n] = newChild;
+		}
+
+		//returns the first node of subtree of given node, nodes are added children first,
+		//so the whole subtree is the range [subtreeStart(index), index]
+		NodeIndex subtreeStart(NodeIndex index) const;
+
+		//copies every node of other, which has to be parsed from the same tokens, into
+		//this tree, returns the index the root of other got
+		NodeIndex append(const Ast& other);
+
+		//returns token the node was created from
+		const Token& token(NodeIndex index) const { return (*tokens)[nodes[index].token]; }
+
+		//returns text of the node's token, the spelling for keywords and operators
+		std::string_view text(NodeIndex index) const;
+
+		//returns text of given token
+		std::string_view tokenText(size_t tokenIndex) const;
+
+		NodeIndex getRoot() const { return root; }
+		void setRoot(NodeIndex index) { root = index; }
+
+		size_t size() const { return nodes.size(); }
+
+		//returns number of entries in the shared child list
+		size_t getLinkCount() const { return links.size(); }
+
+		const std::vector<Token>& getTokens() const { return *tokens; }
+		std::string_view getSource() const { return source; }
+
+		//returns bytes held by the tree
+		size_t getMemoryUsage() const;
+	};
+}
+
+#endif	//_JH_HEADER_AST_
@@ -0,0 +1,257 @@
+#include "LibraryGraph.hpp"
+#include "../Core/Error.hpp"
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace jh{
+	namespace{
+		struct Wanted{
+			size_t unit;
+			size_t token;
+			bool optional;
+		};
+
+		inline bool isTrivia(Token::Type type)
+		{
+			return type == Token::Type::Operator_dComment || type == Token::Type::Operator_preprocessor;
+		}
+
+		void report(std::string_view fileName, size_t line, const std::string& message)
+		{
+			if(fileName.empty())
+				error() << "line " << line << ": " << message << "\n";
+			else
+				error() << fileName << ":" << line << ": " << message << "\n";
+		}
+	}
+
+	size_t LibraryGraph::_findLibrary(std::string_view name) const
+	{
+		//maps have tens of libraries, not worth a hash table
+		for(size_t i = 0; i < units.size(); ++i)
+		{
+			if(!units[i].name.empty() && units[i].name == name)
+				return i;
+		}
+
+		return units.size();
+	}
+
+	bool LibraryGraph::_sort()
+	{
+		std::vector<size_t> waiting(units.size());
+		std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+
+		for(size_t i = 0; i < units.size(); ++i)
+		{
+			waiting[i] = units[i].requirements.size();
+			if(!waiting[i])
+				ready.push(i);
+		}
+
+		while(!ready.empty())
+		{
+			auto unit = ready.top();
+			ready.pop();
+			order.push_back(unit);
+
+			for(auto dependent : units[unit].dependents)
+			{
+				if(!--waiting[dependent])
+					ready.push(dependent);
+			}
+		}
+
+		return order.size() == units.size();
+	}
+
+	bool LibraryGraph::build(const Lexer::TokenList& tokens, std::string_view source, std::string_view fileName)
+	{
+		units.clear();
+		order.clear();
+
+		auto text = [&](size_t index){
+			return source.substr(tokens[index].position, tokens[index].length);
+		};
+
+		std::vector<Wanted> wanted;
+		size_t gapStart = 0;
+		bool gapHasCode = false;
+		bool lineStart = true;
+
+		auto closeGap = [&](size_t end){
+			if(gapHasCode)
+			{
+				CompilationUnit gap;
+				gap.firstToken = gapStart;
+				gap.lastToken = end;
+				units.push_back(gap);
+			}
+
+			gapHasCode = false;
+		};
+
+		for(size_t i = 0; i < tokens.size();)
+		{
+			auto type = tokens[i].type;
+			if(type == Token::Type::Operator_newline || isTrivia(type))
+			{
+				lineStart |= type == Token::Type::Operator_newline;
+				++i;
+				continue;
+			}
+
+			if(!lineStart || type != Token::Type::Keyword_library)
+			{
+				gapHasCode = true;
+				lineStart = false;
+				++i;
+				continue;
+			}
+
+			closeGap(i);
+
+			CompilationUnit library;
+			library.firstToken = i++;
+			size_t self = units.size();
+
+			if(i < tokens.size() && tokens[i].type == Token::Type::Id)
+				library.name = text(i++);
+
+			//header line, requirements are every name after requires/uses/needs
+			//up to the end of line or initializer
+			bool inRequirements = false;
+			bool optional = false;
+			for(; i < tokens.size() && tokens[i].type != Token::Type::Operator_newline; ++i)
+			{
+				switch(tokens[i].type)
+				{
+					case Token::Type::Keyword_requires:
+					case Token::Type::Keyword_uses:
+					case Token::Type::Keyword_needs:
+						inRequirements = true;
+						break;
+					case Token::Type::Keyword_initializer:
+						inRequirements = false;
+						break;
+					case Token::Type::Keyword_optional:
+						optional = true;
+						break;
+					case Token::Type::Id:
+						if(inRequirements)
+							wanted.push_back({ self, i, optional });
+
+						optional = false;
+						break;
+					default:
+						break;
+				}
+			}
+
+			//libraries do not nest, so the first endlibrary closes it
+			while(i < tokens.size() && tokens[i].type != Token::Type::Keyword_endlibrary)
+				++i;
+
+			i = std::min(i + 1, tokens.size());
+			library.lastToken = i;
+			units.push_back(library);
+
+			gapStart = i;
+			lineStart = false;
+		}
+
+		closeGap(tokens.size());
+
+		bool ok = true;
+		for(size_t i = 0; i < units.size(); ++i)
+		{
+			if(units[i].name.empty())
+				continue;
+
+			if(_findLibrary(units[i].name) != i)
+			{
+				report(fileName, tokens[units[i].firstToken].line,
+					"library " + std::string(units[i].name) + " is declared more than once");
+				ok = false;
+			}
+		}
+
+		for(const auto& want : wanted)
+		{
+			auto name = text(want.token);
+			auto required = _findLibrary(name);
+			auto& requirements = units[want.unit].requirements;
+
+			if(required == units.size())
+			{
+				if(!want.optional)
+				{
+					report(fileName, tokens[want.token].line, "library " + std::string(units[want.unit].name) +
+						" requires unknown library " + std::string(name));
+					ok = false;
+				}
+
+				continue;
+			}
+
+			if(std::find(requirements.begin(), requirements.end(), required) == requirements.end())
+				requirements.push_back(required);
+		}
+
+		//code outside libraries can use all of them
+		for(auto& unit : units)
+		{
+			if(!unit.name.empty())
+				continue;
+
+			for(size_t i = 0; i < units.size(); ++i)
+			{
+				if(!units[i].name.empty())
+					unit.requirements.push_back(i);
+			}
+		}
+
+		for(size_t i = 0; i < units.size(); ++i)
+		{
+			for(auto required : units[i].requirements)
+				units[required].dependents.push_back(i);
+		}
+
+		if(!_sort())
+		{
+			std::string names;
+			std::vector<bool> sorted(units.size());
+			for(auto unit : order)
+				sorted[unit] = true;
+
+			size_t line = 0;
+			for(size_t i = 0; i < units.size(); ++i)
+			{
+				if(sorted[i] || units[i].name.empty())
+					continue;
+
+				if(!line)
+					line = tokens[units[i].firstToken].line;
+
+				names += names.empty() ? "" : ", ";
+				names += units[i].name;
+			}
+
+			report(fileName, line, "requirement cycle between libraries " + names);
+			ok = false;
+		}
+
+		return ok;
+	}
+
+	const std::vector<CompilationUnit>& LibraryGraph::getUnits() const
+	{
+		return units;
+	}
+
+	const std::vector<size_t>& LibraryGraph::getOrder() const
+	{
+		return order;
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef _JH_HEADER_LIBRARYGRAPH_
+#define _JH_HEADER_LIBRARYGRAPH_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Lexer/Lexer.hpp"
+
+namespace jh{
+	//part of file that is parsed on its own, single library or code between libraries
+	struct CompilationUnit{
+		//library name, empty for code between libraries
+		std::string_view name;
+
+		//tokens [firstToken, lastToken), from library through endlibrary
+		size_t firstToken = 0;
+		size_t lastToken = 0;
+
+		//units that have to be analyzed before this one, and the ones waiting for it
+		std::vector<size_t> requirements;
+		std::vector<size_t> dependents;
+	};
+
+	/*
+		Libraries of single file and the requirement graph between them
+
+		Built by quick scan over tokens, which only looks at lines starting by library
+		or endlibrary and at the requires/uses/needs clause, without parsing anything.
+		Code between libraries forms units too, which require every library, since vJass
+		places all libraries before the rest of the code.
+
+		Optional requirements of libraries that do not exist are dropped, missing
+		required libraries and requirement cycles are errors.
+	*/
+	class LibraryGraph{
+		std::vector<CompilationUnit> units;
+
+		//every unit comes after all units it requires, ties keep source order
+		std::vector<size_t> order;
+
+		//finds unit of library with given name, units.size() if there is none
+		size_t _findLibrary(std::string_view name) const;
+
+		//fills order, returns false if there is cycle
+		bool _sort();
+	public:
+		//scans tokens lexed from source, returns false and reports into error()
+		//if the requirements can not be satisfied
+		bool build(const Lexer::TokenList& tokens, std::string_view source, std::string_view fileName = "");
+
+		const std::vector<CompilationUnit>& getUnits() const;
+
+		//returns units in the order they can be analyzed in
+		const std::vector<size_t>& getOrder() const;
+	};
+}
+
+#endif	//_JH_HEADER_LIBRARYGRAPH_
@@ -0,0 +1,87 @@
+#include "ParallelParser.hpp"
+#include "Parser.hpp"
+
+namespace jh{
+	namespace{
+		//every worker keeps its parser, and with it the scratch memory, between units
+		Parser& workerParser()
+		{
+			thread_local Parser parser;
+			return parser;
+		}
+	}
+
+	ParallelParser::ParallelParser(size_t threads) : pool(threads)
+	{
+	}
+
+	bool ParallelParser::parse(const Lexer::TokenList& tokens, std::string_view source, std::string_view name)
+	{
+		tree.reset(tokens, source);
+		if(!graph.build(tokens, source, name))
+		{
+			tree.setRoot(tree.addNode(NodeKind::File, 0, 0));
+			return false;
+		}
+
+		const auto& units = graph.getUnits();
+		unitTrees.resize(units.size());
+		succeeded.assign(units.size(), 0);
+
+		for(size_t unit = 0; unit < units.size(); ++unit)
+		{
+			pool.submit([&, unit]{
+				const auto& range = units[unit];
+				succeeded[unit] = workerParser().parseRange(tokens, range.firstToken, range.lastToken,
+															 source, unitTrees[unit], name);
+			});
+		}
+
+		pool.wait();
+
+		_merge(tokens, source);
+
+		for(auto good : succeeded)
+		{
+			if(!good)
+				return false;
+		}
+
+		return true;
+	}
+
+	void ParallelParser::_merge(const Lexer::TokenList& tokens, std::string_view source)
+	{
+		tree.reset(tokens, source);
+
+		size_t nodes = 1;
+		size_t links = 0;
+		for(const auto& unitTree : unitTrees)
+		{
+			nodes += unitTree.size();
+			links += unitTree.getLinkCount() + unitTree.children(unitTree.getRoot()).size();
+		}
+
+		tree.reserve(nodes, links);
+
+		std::vector<NodeIndex> declarations;
+		for(auto unit : graph.getOrder())
+		{
+			auto root = tree.append(unitTrees[unit]);
+			for(auto declaration : tree.children(root))
+				declarations.push_back(declaration);
+		}
+
+		tree.setRoot(tree.addNode(NodeKind::File, 0, 0, declarations.data(), declarations.size()));
+	}
+
+	const LibraryGraph& ParallelParser::getGraph() const
+	{
+		return graph;
+	}
+
+	const Ast& ParallelParser::getTree() const
+	{
+		return tree;
+	}
+}
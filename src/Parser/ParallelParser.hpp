@@ -0,0 +1,55 @@
+#ifndef _JH_HEADER_PARALLELPARSER_
+#define _JH_HEADER_PARALLELPARSER_
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "Ast.hpp"
+#include "LibraryGraph.hpp"
+#include "../Core/ThreadPool.hpp"
+
+namespace jh{
+	/*
+		Parses libraries of single file concurrently
+
+		The file is split into units by LibraryGraph. Parsing a unit does not depend on
+		any other unit, so all of them are submitted to ThreadPool at once, each parsed
+		into its own Ast by Parser::parseRange. Requirements only decide the order the
+		trees are then appended into one, that of LibraryGraph::getOrder, which is also
+		where vJass places libraries in the output. Names are resolved afterwards on
+		the whole tree, since a library sees the names of the ones it requires.
+	*/
+	class ParallelParser{
+		LibraryGraph graph;
+
+		//one tree per unit, and all of them together
+		std::vector<Ast> unitTrees;
+		Ast tree;
+
+		//1 if the unit was parsed without errors
+		std::vector<char> succeeded;
+
+		//kept between files, so that threads are started only once
+		ThreadPool pool;
+
+		//appends unit trees into tree, under single File
+		void _merge(const Lexer::TokenList& tokens, std::string_view source);
+	public:
+		//threads of 0 uses as many threads as the machine has cores
+		explicit ParallelParser(size_t threads = 0);
+
+		ParallelParser(const ParallelParser&) = delete;
+		ParallelParser& operator=(const ParallelParser&) = delete;
+
+		//parses tokens lexed from source, returns false if there were any errors
+		//in the library graph or in parsing
+		bool parse(const Lexer::TokenList& tokens, std::string_view source, std::string_view name = "");
+
+		const LibraryGraph& getGraph() const;
+
+		//returns all units in one tree
+		const Ast& getTree() const;
+	};
+}
+
+#endif	//_JH_HEADER_PARALLELPARSER_
@@ -0,0 +1,1135 @@
+#include "Parser.hpp"
+#include "../Core/Error.hpp"
+#include "../Lexer/TokenName.hpp"
+
+namespace jh{
+	namespace{
+		//tokens that never take part in the grammar
+		inline bool isTrivia(Token::Type type)
+		{
+			return type == Token::Type::Operator_dComment || type == Token::Type::Operator_preprocessor;
+		}
+
+		//precedence of binary operator, 0 if the token is not one
+		//not sits between and and comparisons, see Parser::_parseUnary
+		inline int binaryPrecedence(Token::Type type)
+		{
+			switch(type)
+			{
+				case Token::Type::Keyword_or:
+					return 1;
+				case Token::Type::Keyword_and:
+					return 2;
+				case Token::Type::Operator_equal:
+				case Token::Type::Operator_notequal:
+				case Token::Type::Operator_less:
+				case Token::Type::Operator_bigger:
+				case Token::Type::Operator_lessequal:
+				case Token::Type::Operator_biggerequal:
+					return 3;
+				case Token::Type::Operator_lshift:
+				case Token::Type::Operator_rshift:
+					return 4;
+				case Token::Type::Operator_plus:
+				case Token::Type::Operator_minus:
+					return 5;
+				case Token::Type::Operator_multiply:
+				case Token::Type::Operator_divide:
+				case Token::Type::Operator_modulo:
+					return 6;
+				default:
+					return 0;
+			}
+		}
+
+		constexpr int comparisonPrecedence = 3;
+
+		inline bool isAssignment(Token::Type type)
+		{
+			switch(type)
+			{
+				case Token::Type::Operator_assign:
+				case Token::Type::Operator_eqplus:
+				case Token::Type::Operator_eqminus:
+				case Token::Type::Operator_eqmultiply:
+				case Token::Type::Operator_eqdivide:
+				case Token::Type::Operator_eqmodulo:
+				case Token::Type::Operator_eqlshift:
+				case Token::Type::Operator_eqrshift:
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		//keywords that close a block of declarations
+		inline bool isDeclarationsEnd(Token::Type type)
+		{
+			switch(type)
+			{
+				case Token::Type::Keyword_endlibrary:
+				case Token::Type::Keyword_endscope:
+				case Token::Type::Keyword_endstruct:
+				case Token::Type::Keyword_endclass:
+				case Token::Type::Keyword_endmodule:
+				case Token::Type::Keyword_endinterface:
+				case Token::Type::Keyword_endallocator:
+				case Token::Type::Keyword_endglobals:
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		//keywords that end block of statements, either by closing it, or by starting
+		//something that can not be inside function(missing endfunction)
+		inline bool isStatementsEnd(Token::Type type)
+		{
+			switch(type)
+			{
+				case Token::Type::Keyword_endfunction:
+				case Token::Type::Keyword_endmethod:
+				case Token::Type::Keyword_endconstructor:
+				case Token::Type::Keyword_enddestructor:
+				case Token::Type::Keyword_endif:
+				case Token::Type::Keyword_else:
+				case Token::Type::Keyword_elseif:
+				case Token::Type::Keyword_endloop:
+				case Token::Type::Keyword_endwhile:
+				case Token::Type::Keyword_endfor:
+				case Token::Type::Keyword_function:
+				case Token::Type::Keyword_method:
+				case Token::Type::Keyword_native:
+				case Token::Type::Keyword_globals:
+				case Token::Type::Keyword_library:
+				case Token::Type::Keyword_scope:
+				case Token::Type::Keyword_struct:
+				case Token::Type::Keyword_class:
+				case Token::Type::Keyword_module:
+				case Token::Type::Keyword_interface:
+					return true;
+				default:
+					return isDeclarationsEnd(type);
+			}
+		}
+	}
+
+	Token::Type Parser::_peekAhead(size_t ahead) const
+	{
+		for(size_t index = current; index < last; ++index)
+		{
+			auto type = (*tokens)[index].type;
+			if(isTrivia(type))
+				continue;
+
+			if(!ahead)
+				return type;
+
+			--ahead;
+		}
+
+		return endOfInput;
+	}
+
+	bool Parser::_atWord(std::string_view word) const
+	{
+		return _at(Token::Type::Id) && ast->tokenText(current) == word;
+	}
+
+	size_t Parser::_tokenIndex() const
+	{
+		if(current < last || first == last)
+			return current;
+
+		return last - 1;
+	}
+
+	size_t Parser::_advance()
+	{
+		size_t from = current;
+		if(current < last)
+			++current;
+
+		while(current < last && isTrivia((*tokens)[current].type))
+			++current;
+
+		return from;
+	}
+
+	bool Parser::_accept(Token::Type type)
+	{
+		if(!_at(type))
+			return false;
+
+		_advance();
+		return true;
+	}
+
+	size_t Parser::_expect(Token::Type type, const char* what)
+	{
+		if(_at(type))
+			return _advance();
+
+		_unexpected(what ? what : tokenTypeName(type));
+		return _tokenIndex();
+	}
+
+	void Parser::_error(const char* message)
+	{
+		++errorCount;
+
+		size_t line = first == last ? 1 : (*tokens)[_tokenIndex()].line;
+		if(line == lastErrorLine)
+			return;
+
+		lastErrorLine = line;
+		if(fileName.empty())
+			error() << "line " << line << ": " << message << "\n";
+		else
+			error() << fileName << ":" << line << ": " << message << "\n";
+	}
+
+	void Parser::_unexpected(const char* expected)
+	{
+		std::string message = "expected ";
+		message += expected;
+		message += ", got ";
+
+		auto type = _peek();
+		if(type == endOfInput)
+			message += "end of input";
+		else if(type == Token::Type::Operator_newline)
+			message += "end of line";
+		else if(type == Token::Type::Id)
+		{
+			message += "identifier '";
+			message += ast->tokenText(current);
+			message += "'";
+		}
+		else
+			message += tokenTypeName(type);
+
+		_error(message.c_str());
+	}
+
+	void Parser::_skipLine()
+	{
+		while(!_at(Token::Type::Operator_newline) && !_at(endOfInput))
+			_advance();
+	}
+
+	bool Parser::_atLineStart() const
+	{
+		for(size_t index = current; index > first; --index)
+		{
+			auto type = (*tokens)[index - 1].type;
+			if(!isTrivia(type))
+				return type == Token::Type::Operator_newline;
+		}
+
+		return true;
+	}
+
+	void Parser::_endLine()
+	{
+		//block that is missing its end keyword stops at the first line it can not
+		//contain, which is then already at the start of the line
+		if(!_at(Token::Type::Operator_newline) && !_at(endOfInput) && !_atLineStart())
+		{
+			_unexpected("end of line");
+			_skipLine();
+		}
+
+		_skipNewlines();
+	}
+
+	void Parser::_skipNewlines()
+	{
+		while(_at(Token::Type::Operator_newline))
+			_advance();
+	}
+
+	NodeIndex Parser::_finish(size_t mark, NodeKind kind, std::uint16_t flags, size_t token)
+	{
+		auto node = ast->addNode(kind, flags, token, scratch.data() + mark, scratch.size() - mark);
+		scratch.resize(mark);
+		return node;
+	}
+
+	std::uint16_t Parser::_parseModifiers()
+	{
+		std::uint16_t flags = 0;
+		for(;;)
+		{
+			switch(_peek())
+			{
+				case Token::Type::Keyword_private: flags |= NodeFlag::Private; break;
+				case Token::Type::Keyword_public: flags |= NodeFlag::Public; break;
+				case Token::Type::Keyword_static: flags |= NodeFlag::Static; break;
+				case Token::Type::Keyword_constant: flags |= NodeFlag::Constant; break;
+				case Token::Type::Keyword_readonly: flags |= NodeFlag::Readonly; break;
+				case Token::Type::Keyword_stub: flags |= NodeFlag::Stub; break;
+				case Token::Type::Keyword_inline: flags |= NodeFlag::Inline; break;
+				default: return flags;
+			}
+
+			_advance();
+		}
+	}
+
+	NodeIndex Parser::_parseDeclaration(NodeKind context)
+	{
+		bool inStruct = context == NodeKind::Struct || context == NodeKind::Module ||
+						context == NodeKind::Allocator;
+		bool inType = inStruct || context == NodeKind::Interface;
+
+		auto flags = _parseModifiers();
+		switch(_peek())
+		{
+			case Token::Type::Keyword_globals:
+				return _parseGlobals();
+			case Token::Type::Keyword_type:
+				return _parseTypeDecl();
+			case Token::Type::Keyword_native:
+				return _parseNative(flags);
+			case Token::Type::Keyword_function:
+				return _parseFunction(flags);
+			case Token::Type::Keyword_library:
+				if(context != NodeKind::File)
+					_error("library can only be declared at top level");
+
+				return _parseLibrary(flags);
+			case Token::Type::Keyword_scope:
+				return _parseScope(flags);
+			case Token::Type::Keyword_struct:
+			case Token::Type::Keyword_class:
+				return _parseStruct(flags);
+			case Token::Type::Keyword_interface:
+				return _parseInterface(flags);
+			case Token::Type::Keyword_module:
+				return _parseModule(flags);
+			case Token::Type::Keyword_textmacro:
+				return _parseTextmacro();
+			case Token::Type::Keyword_runtextmacro:
+				return _parseRunTextmacro();
+			default:
+				break;
+		}
+
+		if(inType)
+		{
+			switch(_peek())
+			{
+				case Token::Type::Keyword_method:
+					return _parseMethod(flags, context != NodeKind::Interface);
+				case Token::Type::Keyword_implement:
+					return _parseImplement(flags);
+				case Token::Type::Keyword_constructor:
+				case Token::Type::Keyword_destructor:
+					return _parseSpecialMethod(flags);
+				case Token::Type::Keyword_allocator:
+					if(inStruct)
+						return _parseAllocator();
+
+					break;
+				case Token::Type::Id:
+				case Token::Type::Keyword_thistype:
+					return _parseVariable(NodeKind::Variable, flags);
+				default:
+					break;
+			}
+		}
+
+		_unexpected("declaration");
+		_skipLine();
+		return noNode;
+	}
+
+	NodeIndex Parser::_parseDeclarations(NodeKind context)
+	{
+		size_t mark = _mark();
+		size_t token = _tokenIndex();
+
+		for(;;)
+		{
+			_skipNewlines();
+
+			auto type = _peek();
+			if(type == endOfInput || (context != NodeKind::File && isDeclarationsEnd(type)))
+				break;
+
+			size_t before = current;
+			auto declaration = _parseDeclaration(context);
+			if(declaration != noNode)
+				scratch.push_back(declaration);
+
+			//make sure every round moves forward
+			if(current == before)
+				_advance();
+
+			_endLine();
+		}
+
+		return _finish(mark, context == NodeKind::File ? NodeKind::File : NodeKind::Block, 0, token);
+	}
+
+	NodeIndex Parser::_parseGlobals()
+	{
+		size_t token = _advance();
+		_endLine();
+
+		size_t mark = _mark();
+		for(;;)
+		{
+			_skipNewlines();
+
+			auto flags = _parseModifiers();
+			if(!_at(Token::Type::Id) && !_at(Token::Type::Keyword_thistype))
+				break;
+
+			scratch.push_back(_parseVariable(NodeKind::Variable, flags));
+			_endLine();
+		}
+
+		_parseBlockEnd(Token::Type::Keyword_endglobals);
+		return _finish(mark, NodeKind::Globals, 0, token);
+	}
+
+	NodeIndex Parser::_parseTypeDecl()
+	{
+		_advance();
+		size_t name = _expect(Token::Type::Id, "type name");
+
+		size_t mark = _mark();
+		_expect(Token::Type::Keyword_extends);
+		scratch.push_back(_parseTypeRef());
+
+		return _finish(mark, NodeKind::TypeDecl, 0, name);
+	}
+
+	NodeIndex Parser::_parseNative(std::uint16_t flags)
+	{
+		_advance();
+		size_t name = _expect(Token::Type::Id, "native name");
+
+		size_t mark = _mark();
+		_parseSignature(true);
+		return _finish(mark, NodeKind::Native, flags, name);
+	}
+
+	NodeIndex Parser::_parseFunction(std::uint16_t flags)
+	{
+		_advance();
+		size_t name = _expect(Token::Type::Id, "function name");
+
+		size_t mark = _mark();
+		_parseSignature(true);
+		_endLine();
+
+		scratch.push_back(_parseStatements());
+		_parseBlockEnd(Token::Type::Keyword_endfunction);
+
+		return _finish(mark, NodeKind::Function, flags, name);
+	}
+
+	NodeIndex Parser::_parseLibrary(std::uint16_t flags)
+	{
+		_advance();
+		size_t name = _expect(Token::Type::Id, "library name");
+
+		size_t mark = _mark();
+		size_t requirementsToken = name;
+		NodeIndex initializer = noNode;
+
+		//initializer and requirements can come in either order
+		for(;;)
+		{
+			if(_at(Token::Type::Keyword_initializer))
+				initializer = _parseInitializer();
+			else if(_at(Token::Type::Keyword_requires) || _at(Token::Type::Keyword_uses) ||
+					_at(Token::Type::Keyword_needs))
+			{
+				requirementsToken = _advance();
+				do{
+					std::uint16_t optional = _accept(Token::Type::Keyword_optional) ? NodeFlag::Optional : 0;
+					size_t required = _expect(Token::Type::Id, "library name");
+					scratch.push_back(ast->addNode(NodeKind::Requirement, optional, required));
+				}while(_accept(Token::Type::Operator_comma));
+			}
+			else
+				break;
+		}
+
+		auto requirements = _finish(mark, NodeKind::Requirements, 0, requirementsToken);
+		scratch.push_back(initializer);
+		scratch.push_back(requirements);
+		_endLine();
+
+		scratch.push_back(_parseDeclarations(NodeKind::Library));
+		_parseBlockEnd(Token::Type::Keyword_endlibrary);
+
+		return _finish(mark, NodeKind::Library, flags, name);
+	}
+
+	NodeIndex Parser::_parseScope(std::uint16_t flags)
+	{
+		_advance();
+		size_t name = _expect(Token::Type::Id, "scope name");
+
+		size_t mark = _mark();
+		scratch.push_back(_at(Token::Type::Keyword_initializer) ? _parseInitializer() : noNode);
+		_endLine();
+
+		scratch.push_back(_parseDeclarations(NodeKind::Scope));
+		_parseBlockEnd(Token::Type::Keyword_endscope);
+
+		return _finish(mark, NodeKind::Scope, flags, name);
+	}
+
+	NodeIndex Parser::_parseStruct(std::uint16_t flags)
+	{
+		_advance();
+		size_t name = _expect(Token::Type::Id, "struct name");
+
+		size_t mark = _mark();
+		NodeIndex parent = noNode;
+		if(_accept(Token::Type::Keyword_extends))
+		{
+			//extends array is not a type, but is kept as one, with array as its name
+			if(_at(Token::Type::Keyword_array))
+				parent = ast->addNode(NodeKind::TypeRef, 0, _advance());
+			else
+				parent = _parseTypeRef();
+		}
+
+		scratch.push_back(parent);
+		_endLine();
+
+		scratch.push_back(_parseDeclarations(NodeKind::Struct));
+		_parseBlockEnd(Token::Type::Keyword_endstruct, Token::Type::Keyword_endclass);
+
+		return _finish(mark, NodeKind::Struct, flags, name);
+	}
+
+	NodeIndex Parser::_parseInterface(std::uint16_t flags)
+	{
+		_advance();
+		size_t name = _expect(Token::Type::Id, "interface name");
+		_endLine();
+
+		size_t mark = _mark();
+		scratch.push_back(_parseDeclarations(NodeKind::Interface));
+		_parseBlockEnd(Token::Type::Keyword_endinterface);
+
+		return _finish(mark, NodeKind::Interface, flags, name);
+	}
+
+	NodeIndex Parser::_parseModule(std::uint16_t flags)
+	{
+		_advance();
+		size_t name = _expect(Token::Type::Id, "module name");
+		_endLine();
+
+		size_t mark = _mark();
+		scratch.push_back(_parseDeclarations(NodeKind::Module));
+		_parseBlockEnd(Token::Type::Keyword_endmodule);
+
+		return _finish(mark, NodeKind::Module, flags, name);
+	}
+
+	NodeIndex Parser::_parseImplement(std::uint16_t flags)
+	{
+		_advance();
+		if(_accept(Token::Type::Keyword_optional))
+			flags |= NodeFlag::Optional;
+
+		size_t name = _expect(Token::Type::Id, "module name");
+		return ast->addNode(NodeKind::Implement, flags, name);
+	}
+
+	NodeIndex Parser::_parseMethod(std::uint16_t flags, bool hasBody)
+	{
+		_advance();
+
+		size_t name;
+		if(_accept(Token::Type::Keyword_operator))
+		{
+			//operator name is any single token, or [], and setters end by =
+			flags |= NodeFlag::Operator;
+			name = _tokenIndex();
+
+			if(_accept(Token::Type::Operator_LBPar))
+				_expect(Token::Type::Operator_RBPar);
+			else if(!_at(Token::Type::Keyword_takes))
+				_advance();
+			else
+				_unexpected("operator");
+
+			if(_accept(Token::Type::Operator_assign))
+				flags |= NodeFlag::Setter;
+		}
+		else
+			name = _expect(Token::Type::Id, "method name");
+
+		size_t mark = _mark();
+		_parseSignature(true);
+
+		if(hasBody)
+		{
+			_endLine();
+			scratch.push_back(_parseStatements());
+			_parseBlockEnd(Token::Type::Keyword_endmethod);
+			scratch.push_back(noNode);
+		}
+		else
+		{
+			scratch.push_back(noNode);
+			scratch.push_back(_accept(Token::Type::Keyword_defaults) ? _parseExpression() : noNode);
+		}
+
+		return _finish(mark, NodeKind::Method, flags, name);
+	}
+
+	NodeIndex Parser::_parseSpecialMethod(std::uint16_t flags)
+	{
+		bool constructor = _at(Token::Type::Keyword_constructor);
+		flags |= constructor ? NodeFlag::Constructor : NodeFlag::Destructor;
+		size_t token = _advance();
+
+		size_t mark = _mark();
+		_parseSignature(false);
+		_endLine();
+
+		scratch.push_back(_parseStatements());
+		_parseBlockEnd(constructor ? Token::Type::Keyword_endconstructor : Token::Type::Keyword_enddestructor);
+		scratch.push_back(noNode);
+
+		return _finish(mark, NodeKind::Method, flags, token);
+	}
+
+	NodeIndex Parser::_parseAllocator()
+	{
+		size_t token = _advance();
+		_endLine();
+
+		size_t mark = _mark();
+		scratch.push_back(_parseDeclarations(NodeKind::Allocator));
+		_parseBlockEnd(Token::Type::Keyword_endallocator);
+
+		return _finish(mark, NodeKind::Allocator, 0, token);
+	}
+
+	NodeIndex Parser::_parseTextmacro()
+	{
+		_advance();
+		size_t name = _expect(Token::Type::Id, "textmacro name");
+
+		//the body is text to be substituted, not code yet
+		while(!_at(Token::Type::Keyword_endtextmacro) && !_at(endOfInput))
+			_advance();
+
+		_parseBlockEnd(Token::Type::Keyword_endtextmacro);
+		return ast->addNode(NodeKind::Textmacro, 0, name);
+	}
+
+	NodeIndex Parser::_parseRunTextmacro()
+	{
+		_advance();
+		std::uint16_t flags = _accept(Token::Type::Keyword_optional) ? NodeFlag::Optional : 0;
+		size_t name = _expect(Token::Type::Id, "textmacro name");
+
+		//arguments are only strings, they are used by the expansion, not here
+		_skipLine();
+		return ast->addNode(NodeKind::RunTextmacro, flags, name);
+	}
+
+	NodeIndex Parser::_parseVariable(NodeKind kind, std::uint16_t flags)
+	{
+		size_t mark = _mark();
+		scratch.push_back(_parseTypeRef());
+
+		if(_accept(Token::Type::Keyword_array))
+			flags |= NodeFlag::Array;
+
+		//local thistype this is common in struct code
+		size_t name = _at(Token::Type::Literal_this) ? _advance() : _expect(Token::Type::Id, "variable name");
+
+		NodeIndex size = noNode;
+		if((flags & NodeFlag::Array) && _accept(Token::Type::Operator_LBPar))
+		{
+			size = _parseExpression();
+			_expect(Token::Type::Operator_RBPar);
+		}
+
+		NodeIndex value = noNode;
+		if(_accept(Token::Type::Operator_assign))
+			value = _parseExpression();
+
+		scratch.push_back(value);
+		scratch.push_back(size);
+		return _finish(mark, kind, flags, name);
+	}
+
+	void Parser::_parseSignature(bool returnsRequired)
+	{
+		size_t mark = _mark();
+		size_t takes = _tokenIndex();
+
+		if(_accept(Token::Type::Keyword_takes))
+		{
+			if(_atWord("nothing"))
+				_advance();
+			else
+			{
+				do{
+					size_t parameterMark = _mark();
+					scratch.push_back(_parseTypeRef());
+					size_t name = _at(Token::Type::Literal_this) ? _advance() : _expect(Token::Type::Id, "parameter name");
+					scratch.push_back(_finish(parameterMark, NodeKind::Parameter, 0, name));
+				}while(_accept(Token::Type::Operator_comma));
+			}
+		}
+		else if(returnsRequired)
+			_unexpected("takes");
+
+		auto parameters = _finish(mark, NodeKind::Parameters, 0, takes);
+		scratch.push_back(parameters);
+
+		NodeIndex returns = noNode;
+		if(_accept(Token::Type::Keyword_returns))
+			returns = _parseTypeRef();
+		else if(returnsRequired)
+			_unexpected("returns");
+
+		scratch.push_back(returns);
+	}
+
+	NodeIndex Parser::_parseInitializer()
+	{
+		_advance();
+		size_t name = _expect(Token::Type::Id, "initializer function");
+		return ast->addNode(NodeKind::Name, 0, name);
+	}
+
+	NodeIndex Parser::_parseTypeRef()
+	{
+		if(_at(Token::Type::Id) || _at(Token::Type::Keyword_thistype))
+			return ast->addNode(NodeKind::TypeRef, 0, _advance());
+
+		_unexpected("type name");
+		return ast->addNode(NodeKind::TypeRef, 0, _tokenIndex());
+	}
+
+	void Parser::_parseBlockEnd(Token::Type end, Token::Type alternative)
+	{
+		if(_at(end) || (alternative != Token::Type::Id && _at(alternative)))
+		{
+			_advance();
+			return;
+		}
+
+		//not consumed, it most likely closes some outer block
+		_unexpected(tokenTypeName(end));
+	}
+
+	NodeIndex Parser::_parseStatements()
+	{
+		size_t mark = _mark();
+		size_t token = _tokenIndex();
+
+		for(;;)
+		{
+			_skipNewlines();
+
+			auto type = _peek();
+			if(type == endOfInput || isStatementsEnd(type))
+				break;
+
+			size_t before = current;
+			auto statement = _parseStatement();
+			if(statement != noNode)
+				scratch.push_back(statement);
+
+			if(current == before)
+				_advance();
+
+			_endLine();
+		}
+
+		return _finish(mark, NodeKind::Block, 0, token);
+	}
+
+	NodeIndex Parser::_parseStatement()
+	{
+		std::uint16_t flags = _accept(Token::Type::Keyword_debug) ? NodeFlag::Debug : 0;
+
+		NodeIndex statement = noNode;
+		switch(_peek())
+		{
+			case Token::Type::Keyword_local:
+				_advance();
+				statement = _parseVariable(NodeKind::Local, 0);
+				break;
+			case Token::Type::Keyword_set:
+				_advance();
+				statement = _parseAssignment(_parsePostfix(_parsePrimary()));
+				break;
+			case Token::Type::Keyword_call:
+			{
+				size_t token = _advance();
+				NodeIndex call = _parseExpression();
+				if((*ast)[call].kind != NodeKind::Call)
+					_error("expected function call after call");
+
+				statement = ast->addNode(NodeKind::CallStatement, 0, token, &call, 1);
+				break;
+			}
+			case Token::Type::Keyword_if:
+				statement = _parseIf();
+				break;
+			case Token::Type::Keyword_loop:
+				statement = _parseLoop();
+				break;
+			case Token::Type::Keyword_while:
+				statement = _parseWhile();
+				break;
+			case Token::Type::Keyword_for:
+				statement = _parseFor();
+				break;
+			case Token::Type::Keyword_exitwhen:
+			{
+				size_t token = _advance();
+				NodeIndex condition = _parseExpression();
+				statement = ast->addNode(NodeKind::Exitwhen, 0, token, &condition, 1);
+				break;
+			}
+			case Token::Type::Keyword_return:
+			{
+				size_t token = _advance();
+				NodeIndex value = noNode;
+				if(!_at(Token::Type::Operator_newline) && !_at(endOfInput))
+					value = _parseExpression();
+
+				statement = ast->addNode(NodeKind::Return, 0, token, &value, 1);
+				break;
+			}
+			case Token::Type::Keyword_break:
+				statement = ast->addNode(NodeKind::Break, 0, _advance());
+				break;
+			case Token::Type::Keyword_runtextmacro:
+				statement = _parseRunTextmacro();
+				break;
+			case Token::Type::Id:
+			case Token::Type::Literal_this:
+			case Token::Type::Literal_super:
+			case Token::Type::Keyword_thistype:
+			case Token::Type::Operator_dot:
+				statement = _parseExpressionStatement();
+				break;
+			default:
+				_unexpected("statement");
+				_skipLine();
+				return noNode;
+		}
+
+		(*ast)[statement].flags |= flags;
+		return statement;
+	}
+
+	NodeIndex Parser::_parseAssignment(NodeIndex target)
+	{
+		NodeIndex children[2] = { target, noNode };
+		size_t token = _tokenIndex();
+
+		if(isAssignment(_peek()))
+		{
+			_advance();
+			children[1] = _parseExpression();
+		}
+		else if(_at(Token::Type::Operator_increment) || _at(Token::Type::Operator_decrement))
+			_advance();
+		else
+			_unexpected("=");
+
+		return ast->addNode(NodeKind::Set, 0, token, children, 2);
+	}
+
+	NodeIndex Parser::_parseIf()
+	{
+		size_t token = _advance();
+
+		size_t mark = _mark();
+		scratch.push_back(_parseExpression());
+		_expect(Token::Type::Keyword_then);
+		_endLine();
+
+		scratch.push_back(_parseStatements());
+
+		//elseif is nested If in else branch, the innermost one takes the endif
+		if(_at(Token::Type::Keyword_elseif))
+			scratch.push_back(_parseIf());
+		else if(_accept(Token::Type::Keyword_else))
+		{
+			_endLine();
+			scratch.push_back(_parseStatements());
+			_parseBlockEnd(Token::Type::Keyword_endif);
+		}
+		else
+		{
+			scratch.push_back(noNode);
+			_parseBlockEnd(Token::Type::Keyword_endif);
+		}
+
+		return _finish(mark, NodeKind::If, 0, token);
+	}
+
+	NodeIndex Parser::_parseLoop()
+	{
+		size_t token = _advance();
+		_endLine();
+
+		NodeIndex body = _parseStatements();
+		_parseBlockEnd(Token::Type::Keyword_endloop);
+
+		return ast->addNode(NodeKind::Loop, 0, token, &body, 1);
+	}
+
+	NodeIndex Parser::_parseWhile()
+	{
+		size_t token = _advance();
+
+		size_t mark = _mark();
+		scratch.push_back(_parseExpression());
+		_endLine();
+
+		scratch.push_back(_parseStatements());
+		_parseBlockEnd(Token::Type::Keyword_endwhile);
+
+		return _finish(mark, NodeKind::While, 0, token);
+	}
+
+	NodeIndex Parser::_parseFor()
+	{
+		//for init; condition; step, each part can be left out
+		size_t token = _advance();
+		size_t mark = _mark();
+
+		NodeIndex init = noNode;
+		if(_accept(Token::Type::Keyword_local))
+			init = _parseVariable(NodeKind::Local, 0);
+		else if((_at(Token::Type::Id) || _at(Token::Type::Keyword_thistype)) && _peekAhead(1) == Token::Type::Id)
+			init = _parseVariable(NodeKind::Local, 0);
+		else if(!_at(Token::Type::Operator_semi))
+		{
+			_accept(Token::Type::Keyword_set);
+			init = _parseAssignment(_parsePostfix(_parsePrimary()));
+		}
+
+		scratch.push_back(init);
+		_expect(Token::Type::Operator_semi);
+
+		scratch.push_back(_at(Token::Type::Operator_semi) ? noNode : _parseExpression());
+		_expect(Token::Type::Operator_semi);
+
+		NodeIndex step = noNode;
+		if(!_at(Token::Type::Operator_newline) && !_at(endOfInput))
+		{
+			_accept(Token::Type::Keyword_set);
+			step = _parseAssignment(_parsePostfix(_parsePrimary()));
+		}
+
+		scratch.push_back(step);
+		_endLine();
+
+		scratch.push_back(_parseStatements());
+		_parseBlockEnd(Token::Type::Keyword_endfor);
+
+		return _finish(mark, NodeKind::For, 0, token);
+	}
+
+	NodeIndex Parser::_parseExpressionStatement()
+	{
+		NodeIndex target = _parsePostfix(_parsePrimary());
+
+		auto type = _peek();
+		if(isAssignment(type) || type == Token::Type::Operator_increment || type == Token::Type::Operator_decrement)
+		{
+			NodeIndex statement = _parseAssignment(target);
+			(*ast)[statement].flags |= NodeFlag::Implicit;
+			return statement;
+		}
+
+		if((*ast)[target].kind != NodeKind::Call)
+			_unexpected("assignment or function call");
+
+		return ast->addNode(NodeKind::CallStatement, NodeFlag::Implicit, (*ast)[target].token, &target, 1);
+	}
+
+	NodeIndex Parser::_parseExpression()
+	{
+		return _parseBinary(1);
+	}
+
+	NodeIndex Parser::_parseBinary(int precedence)
+	{
+		NodeIndex left = _parseUnary();
+
+		for(;;)
+		{
+			int found = binaryPrecedence(_peek());
+			if(found < precedence || !found)
+				return left;
+
+			size_t token = _advance();
+			NodeIndex children[2] = { left, _parseBinary(found + 1) };
+			left = ast->addNode(NodeKind::Binary, 0, token, children, 2);
+		}
+	}
+
+	NodeIndex Parser::_parseUnary()
+	{
+		//not a == b is not(a == b), as in Jass
+		if(_at(Token::Type::Keyword_not))
+		{
+			size_t token = _advance();
+			NodeIndex operand = _parseBinary(comparisonPrecedence);
+			return ast->addNode(NodeKind::Unary, 0, token, &operand, 1);
+		}
+
+		if(_at(Token::Type::Operator_minus) || _at(Token::Type::Operator_plus))
+		{
+			size_t token = _advance();
+			NodeIndex operand = _parseUnary();
+			return ast->addNode(NodeKind::Unary, 0, token, &operand, 1);
+		}
+
+		return _parsePostfix(_parsePrimary());
+	}
+
+	NodeIndex Parser::_parsePostfix(NodeIndex target)
+	{
+		for(;;)
+		{
+			if(_at(Token::Type::Operator_dot))
+			{
+				_advance();
+				size_t name = _expect(Token::Type::Id, "member name");
+				target = ast->addNode(NodeKind::Member, 0, name, &target, 1);
+			}
+			else if(_at(Token::Type::Operator_LBPar))
+			{
+				size_t token = _advance();
+				NodeIndex children[2] = { target, _parseExpression() };
+				_expect(Token::Type::Operator_RBPar);
+				target = ast->addNode(NodeKind::Index, 0, token, children, 2);
+			}
+			else if(_at(Token::Type::Operator_LPar))
+			{
+				size_t token = _advance();
+				size_t mark = _mark();
+				scratch.push_back(target);
+
+				if(!_at(Token::Type::Operator_RPar))
+				{
+					do{
+						scratch.push_back(_parseExpression());
+					}while(_accept(Token::Type::Operator_comma));
+				}
+
+				_expect(Token::Type::Operator_RPar);
+				target = _finish(mark, NodeKind::Call, 0, token);
+			}
+			else
+				return target;
+		}
+	}
+
+	NodeIndex Parser::_parsePrimary()
+	{
+		switch(_peek())
+		{
+			case Token::Type::Literal_int:
+			case Token::Type::Literal_real:
+			case Token::Type::Literal_null:
+			case Token::Type::Literal_bool_true:
+			case Token::Type::Literal_bool_false:
+			case Token::Type::Operator_rawcode:
+			case Token::Type::Operator_string:
+				return ast->addNode(NodeKind::Literal, 0, _advance());
+			case Token::Type::Id:
+			case Token::Type::Literal_this:
+			case Token::Type::Literal_super:
+			case Token::Type::Keyword_thistype:
+				return ast->addNode(NodeKind::Name, 0, _advance());
+			case Token::Type::Keyword_function:
+			{
+				//function name, or function Struct.method
+				size_t token = _advance();
+				NodeIndex target = ast->addNode(NodeKind::Name, 0, _expect(Token::Type::Id, "function name"));
+				while(_accept(Token::Type::Operator_dot))
+				{
+					size_t name = _expect(Token::Type::Id, "method name");
+					target = ast->addNode(NodeKind::Member, 0, name, &target, 1);
+				}
+
+				return ast->addNode(NodeKind::FunctionRef, 0, token, &target, 1);
+			}
+			case Token::Type::Operator_LPar:
+			{
+				size_t token = _advance();
+				NodeIndex inner = _parseExpression();
+				_expect(Token::Type::Operator_RPar);
+				return ast->addNode(NodeKind::Paren, 0, token, &inner, 1);
+			}
+			case Token::Type::Operator_dot:
+			{
+				//.member inside struct, the object is this
+				_advance();
+				NodeIndex object = noNode;
+				size_t name = _expect(Token::Type::Id, "member name");
+				return ast->addNode(NodeKind::Member, 0, name, &object, 1);
+			}
+			default:
+				break;
+		}
+
+		//keep the tree shape, the error makes the result unusable anyway
+		_unexpected("expression");
+		return ast->addNode(NodeKind::Name, 0, _tokenIndex());
+	}
+
+	bool Parser::parse(const Lexer::TokenList& tokenList, std::string_view text, Ast& output, std::string_view name)
+	{
+		return parseRange(tokenList, 0, tokenList.size(), text, output, name);
+	}
+
+	bool Parser::parseRange(const Lexer::TokenList& tokenList, size_t from, size_t to, std::string_view text,
+							Ast& output, std::string_view name)
+	{
+		tokens = &tokenList;
+		first = from;
+		last = to;
+		source = text;
+		ast = &output;
+		fileName = name;
+		errorCount = 0;
+		lastErrorLine = 0;
+		scratch.clear();
+
+		output.reset(tokenList, text);
+		output.reserveFor(to - from);
+
+		//trivia at the very start is not skipped by any _advance
+		current = first;
+		while(current < last && isTrivia((*tokens)[current].type))
+			++current;
+
+		output.setRoot(_parseDeclarations(NodeKind::File));
+		return errorCount == 0;
+	}
+
+	size_t Parser::getErrorCount() const
+	{
+		return errorCount;
+	}
+}
@@ -0,0 +1,187 @@
+#ifndef _JH_HEADER_PARSER_
+#define _JH_HEADER_PARSER_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Lexer/Lexer.hpp"
+#include "Ast.hpp"
+
+namespace jh{
+	/*
+		Recursive descent parser from Lexer tokens into Ast
+
+		Jass is line based, every declaration and statement ends at newline, so on error
+		the parser reports it and skips to the end of the line, and carries on with the
+		next one. Block comments and //! lines are skipped, textmacro bodies are not
+		parsed, only recorded(see NodeKind::Textmacro).
+
+		Children of the node being parsed are collected on one scratch stack and copied
+		into the Ast once the node is complete, so parsing does not allocate once the
+		Parser and Ast have grown to the biggest file.
+	*/
+	class Parser{
+		const Lexer::TokenList* tokens = nullptr;
+		std::string_view source;
+		Ast* ast = nullptr;
+
+		//range of tokens being parsed, and index of the current one
+		size_t first = 0;
+		size_t last = 0;
+		size_t current = 0;
+
+		//children of nodes under construction, see _finish
+		std::vector<NodeIndex> scratch;
+
+		std::string fileName;
+		size_t errorCount = 0;
+
+		//only the first error of every line is reported
+		size_t lastErrorLine = 0;
+
+		//type of current token, endOfInput past the last token of the range
+		//current never rests on block comment or //! line, see _advance
+		Token::Type _peek() const
+		{
+			return current < last ? (*tokens)[current].type : endOfInput;
+		}
+
+		//type of the token given number of tokens after the current one
+		Token::Type _peekAhead(size_t ahead) const;
+
+		bool _at(Token::Type type) const { return _peek() == type; }
+
+		//returns whether current token is Id spelled as word
+		bool _atWord(std::string_view word) const;
+
+		//index of the current token, or of the last one past the end, for nodes
+		//and messages that need some token
+		size_t _tokenIndex() const;
+
+		//moves to the next token, skipping block comments and //! lines,
+		//returns index of the token it moved from
+		size_t _advance();
+
+		//consumes current token if it is of given type
+		bool _accept(Token::Type type);
+
+		//consumes current token of given type, or reports error, returns its index
+		//or the current index on error
+		size_t _expect(Token::Type type, const char* what = nullptr);
+
+		//reports error at current token
+		void _error(const char* message);
+
+		//reports error about unexpected current token, expected describes what should be there
+		void _unexpected(const char* expected);
+
+		//returns whether current token is the first one on its line
+		bool _atLineStart() const;
+
+		//skips tokens up to, but not including, the next newline
+		void _skipLine();
+
+		//expects the end of line, skips the rest of it if it is not there, and all
+		//empty lines after it, nothing is expected when already at start of a line
+		void _endLine();
+
+		void _skipNewlines();
+
+		//returns scratch mark, children pushed after it belong to the next _finish
+		size_t _mark() const { return scratch.size(); }
+
+		//creates node from children pushed since mark, and pops them
+		NodeIndex _finish(size_t mark, NodeKind kind, std::uint16_t flags, size_t token);
+
+		//reads public, private, static, constant, stub, readonly, inline prefixes
+		std::uint16_t _parseModifiers();
+
+		//one declaration of file, library, scope, struct, module or interface body,
+		//without the newline after it, noNode if there was nothing to keep
+		NodeIndex _parseDeclaration(NodeKind context);
+
+		//declarations until end keyword of given block kind, returns Block
+		NodeIndex _parseDeclarations(NodeKind context);
+
+		NodeIndex _parseGlobals();
+		NodeIndex _parseTypeDecl();
+		NodeIndex _parseNative(std::uint16_t flags);
+		NodeIndex _parseFunction(std::uint16_t flags);
+		NodeIndex _parseLibrary(std::uint16_t flags);
+		NodeIndex _parseScope(std::uint16_t flags);
+		NodeIndex _parseStruct(std::uint16_t flags);
+		NodeIndex _parseInterface(std::uint16_t flags);
+		NodeIndex _parseModule(std::uint16_t flags);
+		NodeIndex _parseImplement(std::uint16_t flags);
+		NodeIndex _parseMethod(std::uint16_t flags, bool hasBody);
+		NodeIndex _parseSpecialMethod(std::uint16_t flags);
+		NodeIndex _parseAllocator();
+		NodeIndex _parseTextmacro();
+		NodeIndex _parseRunTextmacro();
+
+		//type [array] name [= value], global, member or local(without the local keyword)
+		NodeIndex _parseVariable(NodeKind kind, std::uint16_t flags);
+
+		//takes ... returns ..., pushes Parameters and TypeRef on scratch,
+		//returns are optional for constructors and destructors
+		void _parseSignature(bool returnsRequired);
+
+		//initializer name, returns Name or noNode
+		NodeIndex _parseInitializer();
+
+		NodeIndex _parseTypeRef();
+
+		//ends the block started by opening keyword, reports the keyword that is missing
+		//alternative is the other accepted spelling(endclass for endstruct), Id for none
+		void _parseBlockEnd(Token::Type end, Token::Type alternative = Token::Type::Id);
+
+		//statements until any end keyword, returns Block
+		NodeIndex _parseStatements();
+
+		//single statement without the newline after it
+		NodeIndex _parseStatement();
+
+		//rest of assignment to already parsed target, from the operator on
+		NodeIndex _parseAssignment(NodeIndex target);
+
+		NodeIndex _parseIf();
+		NodeIndex _parseLoop();
+		NodeIndex _parseWhile();
+		NodeIndex _parseFor();
+
+		//statement starting by expression, assignment or call without set or call
+		NodeIndex _parseExpressionStatement();
+
+		NodeIndex _parseExpression();
+		NodeIndex _parseBinary(int precedence);
+		NodeIndex _parseUnary();
+		NodeIndex _parsePostfix(NodeIndex target);
+		NodeIndex _parsePrimary();
+	public:
+		//returned by _peek past the last token, Token::Type starts at 1
+		static constexpr Token::Type endOfInput = static_cast<Token::Type>(0);
+
+		Parser() = default;
+
+		Parser(const Parser&) = delete;
+		Parser& operator=(const Parser&) = delete;
+
+		//parses tokens lexed from source into output, which is reset first
+		//fileName is only used in error messages
+		//returns false if there were any errors, the tree is still complete
+		//apart from the lines that had them
+		bool parse(const Lexer::TokenList& tokenList, std::string_view text, Ast& output, std::string_view name = "");
+
+		//parses only tokens [from, to) of the list as if they were whole file, nodes
+		//still refer to tokens by their index in the whole list
+		bool parseRange(const Lexer::TokenList& tokenList, size_t from, size_t to, std::string_view text,
+						Ast& output, std::string_view name = "");
+
+		//returns number of errors reported by the last parse
+		size_t getErrorCount() const;
+	};
+}
+
+#endif	//_JH_HEADER_PARSER_
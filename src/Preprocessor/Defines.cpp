@@ -0,0 +1,212 @@
+#include "Defines.hpp"
+#include "../Core/Hash.hpp"
+#include "../Lexer/CharClass.hpp"
+
+namespace jh{
+	namespace{
+		//text of operand, defined is false for undefined names
+		struct Operand{
+			std::string_view text;
+			bool defined = true;
+
+			bool isTrue() const
+			{
+				return defined && !text.empty() && text != "0" && text != "false";
+			}
+		};
+
+		//recursive descent over the condition text, see Defines
+		class ConditionReader{
+			const Defines& defines;
+			std::string_view text;
+			size_t at = 0;
+			bool valid = true;
+
+			void _skipBlanks()
+			{
+				while(at < text.size() && hasCharClass(text[at], CharClass::Blank))
+					++at;
+			}
+
+			//returns next word without consuming it, empty if there is none
+			std::string_view _peekWord()
+			{
+				_skipBlanks();
+
+				size_t end = at;
+				while(end < text.size() && hasCharClass(text[end], CharClass::Ident))
+					++end;
+
+				return text.substr(at, end - at);
+			}
+
+			bool _accept(std::string_view what)
+			{
+				_skipBlanks();
+				if(text.compare(at, what.size(), what) != 0)
+					return false;
+
+				//whole words only, so that android is not and + roid
+				if(hasCharClass(what[0], CharClass::Alpha) && at + what.size() < text.size() &&
+				   hasCharClass(text[at + what.size()], CharClass::Ident))
+					return false;
+
+				at += what.size();
+				return true;
+			}
+
+			Operand _operand()
+			{
+				_skipBlanks();
+				if(at >= text.size())
+				{
+					valid = false;
+					return Operand{};
+				}
+
+				if(_accept("("))
+				{
+					bool value = _condition();
+					if(!_accept(")"))
+						valid = false;
+
+					return Operand{ value ? "true" : "false" };
+				}
+
+				if(text[at] == '\"')
+				{
+					size_t end = text.find('\"', at + 1);
+					if(end == std::string_view::npos)
+					{
+						valid = false;
+						return Operand{};
+					}
+
+					Operand operand{ text.substr(at + 1, end - at - 1) };
+					at = end + 1;
+					return operand;
+				}
+
+				auto word = _peekWord();
+				if(word.empty() || word == "not" || word == "and" || word == "or")
+				{
+					valid = false;
+					return Operand{};
+				}
+
+				at += word.size();
+				if(hasCharClass(word[0], CharClass::Digit) || word == "true" || word == "false")
+					return Operand{ word };
+
+				auto* value = defines.find(word);
+				if(!value)
+					return Operand{ std::string_view(), false };
+
+				return Operand{ *value };
+			}
+
+			bool _factor()
+			{
+				if(_accept("not"))
+					return !_factor();
+
+				auto left = _operand();
+				if(_accept("=="))
+					return left.text == _operand().text;
+				if(_accept("!="))
+					return left.text != _operand().text;
+
+				return left.isTrue();
+			}
+
+			bool _term()
+			{
+				bool value = _factor();
+				while(valid && _accept("and"))
+					value = _factor() && value;
+
+				return value;
+			}
+
+			bool _condition()
+			{
+				bool value = _term();
+				while(valid && _accept("or"))
+					value = _term() || value;
+
+				return value;
+			}
+		public:
+			ConditionReader(const Defines& owner, std::string_view condition) : defines(owner), text(condition)
+			{
+			}
+
+			bool read(bool& result)
+			{
+				result = _condition();
+				_skipBlanks();
+
+				valid = valid && at == text.size();
+				result = result && valid;
+				return valid;
+			}
+		};
+	}
+
+	void Defines::define(std::string_view name, std::string_view value)
+	{
+		for(auto& entry : values)
+		{
+			if(entry.first == name)
+			{
+				entry.second = value;
+				return;
+			}
+		}
+
+		values.emplace_back(std::string(name), std::string(value));
+	}
+
+	void Defines::undefine(std::string_view name)
+	{
+		for(size_t i = 0; i < values.size(); ++i)
+		{
+			if(values[i].first == name)
+			{
+				values.erase(values.begin() + i);
+				return;
+			}
+		}
+	}
+
+	const std::string* Defines::find(std::string_view name) const
+	{
+		for(const auto& entry : values)
+		{
+			if(entry.first == name)
+				return &entry.second;
+		}
+
+		return nullptr;
+	}
+
+	bool Defines::empty() const
+	{
+		return values.empty();
+	}
+
+	std::uint64_t Defines::hash() const
+	{
+		//sum of hashes of the entries does not depend on their order
+		std::uint64_t result = hash64(std::string_view("Defines"));
+		for(const auto& entry : values)
+			result += hash64(entry.second, hash64(entry.first));
+
+		return result;
+	}
+
+	bool Defines::evaluate(std::string_view condition, bool& result) const
+	{
+		return ConditionReader(*this, condition).read(result);
+	}
+}
@@ -0,0 +1,48 @@
+#ifndef _JH_HEADER_DEFINES_
+#define _JH_HEADER_DEFINES_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace jh{
+	/*
+		Names defined for conditional compilation(#if, #elseif, #else, #endif)
+
+		Condition is the rest of the #if or #elseif line:
+			condition: term {or term}
+			term:      factor {and factor}
+			factor:    not factor | operand [== operand | != operand]
+			operand:   ( condition ) | name | integer | "string" | true | false
+		Operand on its own is true unless it is undefined name, or its value is empty,
+		0 or false. == and != compare the text of the operands, value of name is what it
+		is defined to, undefined name has empty value.
+	*/
+	class Defines{
+		//builds have few defines, not worth a hash table
+		std::vector<std::pair<std::string, std::string>> values;
+	public:
+		//defines name, or changes its value if it is defined already
+		void define(std::string_view name, std::string_view value = "true");
+
+		void undefine(std::string_view name);
+
+		//returns value of name, nullptr if it is not defined
+		const std::string* find(std::string_view name) const;
+
+		bool empty() const;
+
+		//returns hash of every name and value, independent of the order they were defined in
+		//two Defines with the same hash select the same code
+		std::uint64_t hash() const;
+
+		//evaluates condition into result, returns false if condition is not valid
+		//result is then false
+		bool evaluate(std::string_view condition, bool& result) const;
+	};
+}
+
+#endif	//_JH_HEADER_DEFINES_
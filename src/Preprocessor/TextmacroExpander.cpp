@@ -0,0 +1,664 @@
+#include "TextmacroExpander.hpp"
+#include "../Core/Error.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace jh{
+	namespace{
+		inline bool isWordChar(char c)
+		{
+			return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+		}
+
+		//reads words and quoted arguments of single //! line
+		struct LineReader{
+			std::string_view text;
+			size_t at = 0;
+
+			void skipBlanks()
+			{
+				while(at < text.size() && (text[at] == ' ' || text[at] == '\t' || text[at] == '\r'))
+					++at;
+			}
+
+			std::string_view word()
+			{
+				skipBlanks();
+				size_t start = at;
+				while(at < text.size() && isWordChar(text[at]))
+					++at;
+
+				return text.substr(start, at - start);
+			}
+
+			bool accept(char c)
+			{
+				skipBlanks();
+				if(at >= text.size() || text[at] != c)
+					return false;
+
+				++at;
+				return true;
+			}
+
+			//contents of "...", false if there is no complete string
+			bool quoted(std::string_view& contents)
+			{
+				if(!accept('"'))
+					return false;
+
+				size_t start = at;
+				for(; at < text.size() && text[at] != '"'; ++at)
+				{
+					if(text[at] == '\\')
+						++at;
+				}
+
+				if(at >= text.size())
+					return false;
+
+				contents = text.substr(start, at - start);
+				++at;
+				return true;
+			}
+		};
+
+		//returns first word of //! line
+		std::string_view directive(std::string_view text)
+		{
+			LineReader reader{ text };
+			return reader.word();
+		}
+	}
+
+	void TextmacroExpander::_error(size_t line, const std::string& message)
+	{
+		++errorCount;
+
+		if(fileName.empty())
+			error() << "line " << line << ": " << message << "\n";
+		else
+			error() << fileName << ":" << line << ": " << message << "\n";
+	}
+
+	std::string_view TextmacroExpander::_tokenText(const Token& token) const
+	{
+		size_t position = token.position;
+		if(position < source.size())
+			return source.substr(position, token.length);
+
+		return std::string_view(generated).substr(position - source.size(), token.length);
+	}
+
+	bool TextmacroExpander::_hasMacros() const
+	{
+		for(const auto& token : *tokens)
+		{
+			switch(token.type)
+			{
+				case Token::Type::Keyword_textmacro:
+				case Token::Type::Keyword_runtextmacro:
+					return true;
+				case Token::Type::Operator_preprocessor:
+				{
+					auto word = directive(_tokenText(token));
+					if(word == "textmacro" || word == "textmacro_once" || word == "runtextmacro")
+						return true;
+
+					break;
+				}
+				default:
+					break;
+			}
+		}
+
+		return false;
+	}
+
+	void TextmacroExpander::_collectTemplates()
+	{
+		const auto& list = *tokens;
+
+		for(size_t i = 0; i < list.size(); ++i)
+		{
+			const auto& token = list[i];
+			size_t start = i;
+			size_t line = token.line;
+
+			std::string_view name;
+			std::vector<std::string_view> parameters;
+			bool once = false;
+
+			if(token.type == Token::Type::Keyword_textmacro)
+			{
+				//textmacro Name takes A, B
+				++i;
+				if(i < list.size() && list[i].type == Token::Type::Id)
+					name = _tokenText(list[i++]);
+
+				if(i < list.size() && list[i].type == Token::Type::Keyword_takes)
+				{
+					for(++i; i < list.size() && list[i].type == Token::Type::Id;)
+					{
+						parameters.push_back(_tokenText(list[i++]));
+						if(i >= list.size() || list[i].type != Token::Type::Operator_comma)
+							break;
+
+						++i;
+					}
+				}
+			}
+			else if(token.type == Token::Type::Operator_preprocessor)
+			{
+				//! textmacro Name takes A, B
+				LineReader reader{ _tokenText(token) };
+				auto word = reader.word();
+				if(word != "textmacro" && word != "textmacro_once")
+					continue;
+
+				once = word == "textmacro_once";
+				name = reader.word();
+				if(reader.word() == "takes")
+				{
+					do{
+						parameters.push_back(reader.word());
+					}while(reader.accept(','));
+				}
+			}
+			else
+				continue;
+
+			if(name.empty())
+				_error(line, "expected textmacro name");
+
+			//body starts on the next line, and ends at the first endtextmacro
+			while(i < list.size() && list[i].type != Token::Type::Operator_newline)
+				++i;
+
+			size_t first = std::min(i + 1, list.size());
+			size_t end = first;
+			for(; end < list.size(); ++end)
+			{
+				if(list[end].type == Token::Type::Keyword_endtextmacro)
+					break;
+
+				if(list[end].type == Token::Type::Operator_preprocessor && directive(_tokenText(list[end])) == "endtextmacro")
+					break;
+			}
+
+			if(end == list.size())
+				_error(line, "textmacro " + std::string(name) + " is missing endtextmacro");
+			else if(!name.empty())
+				_addTemplate(name, std::move(parameters), once, line, first, end);
+
+			i = std::min(end, list.size() - 1);
+			definitions.push_back({ start, i + 1 });
+		}
+	}
+
+	void TextmacroExpander::_addTemplate(std::string_view name, std::vector<std::string_view>&& parameters, bool once,
+										 size_t line, size_t first, size_t last)
+	{
+		if(templateIndex.count(name))
+		{
+			if(!once)
+				_error(line, "textmacro " + std::string(name) + " is defined more than once");
+
+			return;
+		}
+
+		const auto& list = *tokens;
+
+		//tokens that an argument can be glued to, forming one token once substituted
+		auto glues = [&](const Token& token){
+			switch(token.type)
+			{
+				case Token::Type::Operator_textmacroarg:
+				case Token::Type::Id:
+				case Token::Type::Literal_int:
+				case Token::Type::Literal_real:
+					return true;
+				case Token::Type::Operator_string:
+				case Token::Type::Operator_rawcode:
+				case Token::Type::Operator_preprocessor:
+				case Token::Type::Operator_dComment:
+				case Token::Type::Operator_newline:
+					return false;
+				default:
+					//keywords
+					return std::isalpha(static_cast<unsigned char>(source[token.position])) != 0;
+			}
+		};
+
+		auto begin = [&](const Token& token) -> size_t {
+			return token.position - (token.type == Token::Type::Operator_textmacroarg);
+		};
+
+		auto end = [&](const Token& token) -> size_t {
+			if(token.type == Token::Type::Operator_textmacroarg)
+				return token.position + token.length + 1;
+
+			if(tokenHasLength(token.type))
+				return token.position + token.length;
+
+			size_t at = token.position;
+			while(at < source.size() && isWordChar(source[at]))
+				++at;
+
+			return at;
+		};
+
+		Template macro;
+		macro.name = name;
+		macro.parameters = std::move(parameters);
+		macro.firstPiece = pieces.size();
+
+		for(size_t i = first; i < last;)
+		{
+			const auto& token = list[i];
+			switch(token.type)
+			{
+				case Token::Type::Operator_string:
+				case Token::Type::Operator_rawcode:
+				case Token::Type::Operator_preprocessor:
+				{
+					//arguments are substituted inside strings and //! lines as well
+					auto contents = _tokenText(token);
+					size_t position = token.position;
+					if(contents.find('$') == std::string_view::npos)
+						pieces.push_back({ i, false, 0, 0 });
+					else if(token.type == Token::Type::Operator_preprocessor)
+						pieces.push_back({ i, true, position - 3, position + contents.size() });
+					else
+						pieces.push_back({ i, true, position - 1, position + contents.size() + 1 });
+
+					++i;
+					continue;
+				}
+				default:
+					break;
+			}
+
+			if(!glues(token))
+			{
+				pieces.push_back({ i, false, 0, 0 });
+				++i;
+				continue;
+			}
+
+			size_t j = i;
+			bool argument = token.type == Token::Type::Operator_textmacroarg;
+			while(j + 1 < last && glues(list[j + 1]) && end(list[j]) == begin(list[j + 1]))
+			{
+				++j;
+				argument |= list[j].type == Token::Type::Operator_textmacroarg;
+			}
+
+			if(!argument)
+			{
+				for(; i <= j; ++i)
+					pieces.push_back({ i, false, 0, 0 });
+
+				continue;
+			}
+
+			for(size_t k = i; k <= j; ++k)
+			{
+				if(list[k].type != Token::Type::Operator_textmacroarg)
+					continue;
+
+				auto argumentName = _tokenText(list[k]);
+				if(std::find(macro.parameters.begin(), macro.parameters.end(), argumentName) == macro.parameters.end())
+				{
+					_error(list[k].line, "textmacro " + std::string(name) + " has no argument " +
+						std::string(argumentName));
+				}
+			}
+
+			pieces.push_back({ i, true, begin(token), end(list[j]) });
+			i = j + 1;
+		}
+
+		macro.lastPiece = pieces.size();
+		templateIndex.emplace(name, templates.size());
+		templates.push_back(std::move(macro));
+	}
+
+	TextmacroExpander::CallKind TextmacroExpander::_readCall(const Lexer::TokenList& list, size_t index, Call& call) const
+	{
+		const auto& token = list[index];
+		call.optional = false;
+		call.arguments.clear();
+
+		if(token.type == Token::Type::Operator_preprocessor)
+		{
+			//! runtextmacro optional Name("a", "b")
+			LineReader reader{ _tokenText(token) };
+			if(reader.word() != "runtextmacro")
+				return CallKind::None;
+
+			call.end = index + 1;
+			call.name = reader.word();
+			if(call.name == "optional")
+			{
+				call.optional = true;
+				call.name = reader.word();
+			}
+
+			if(call.name.empty() || !reader.accept('('))
+				return CallKind::Invalid;
+
+			if(reader.accept(')'))
+				return CallKind::Valid;
+
+			do{
+				std::string_view argument;
+				if(!reader.quoted(argument))
+					return CallKind::Invalid;
+
+				call.arguments.push_back(argument);
+			}while(reader.accept(','));
+
+			return reader.accept(')') ? CallKind::Valid : CallKind::Invalid;
+		}
+
+		if(token.type != Token::Type::Keyword_runtextmacro)
+			return CallKind::None;
+
+		//runtextmacro optional Name("a", "b")
+		size_t i = index + 1;
+		auto at = [&](Token::Type type){
+			return i < list.size() && list[i].type == type;
+		};
+
+		call.end = i;
+		if(at(Token::Type::Keyword_optional))
+		{
+			call.optional = true;
+			++i;
+		}
+
+		if(!at(Token::Type::Id))
+			return CallKind::Invalid;
+
+		call.name = _tokenText(list[i++]);
+		if(!at(Token::Type::Operator_LPar))
+			return CallKind::Invalid;
+
+		++i;
+		while(!at(Token::Type::Operator_RPar))
+		{
+			if(!at(Token::Type::Operator_string))
+				return CallKind::Invalid;
+
+			call.arguments.push_back(_tokenText(list[i++]));
+			if(at(Token::Type::Operator_comma))
+				++i;
+			else if(!at(Token::Type::Operator_RPar))
+				return CallKind::Invalid;
+		}
+
+		call.end = i + 1;
+		return CallKind::Valid;
+	}
+
+	void TextmacroExpander::_splice(const Call& call, size_t line, Lexer::TokenList& into)
+	{
+		auto found = templateIndex.find(call.name);
+		if(found == templateIndex.end())
+		{
+			if(!call.optional)
+				_error(line, "unknown textmacro " + std::string(call.name));
+
+			return;
+		}
+
+		size_t macro = found->second;
+		const auto& parameters = templates[macro].parameters;
+		if(call.arguments.size() != parameters.size())
+		{
+			_error(line, "textmacro " + std::string(call.name) + " takes " + std::to_string(parameters.size()) +
+				" arguments, got " + std::to_string(call.arguments.size()));
+			return;
+		}
+
+		//macro index and arguments, separated by a character strings can not hold
+		key.assign(reinterpret_cast<const char*>(&macro), sizeof(macro));
+		for(auto argument : call.arguments)
+		{
+			key += '\n';
+			key += argument;
+		}
+
+		TokenRange range;
+		auto memo = instances.find(key);
+		if(memo != instances.end())
+			range = memo->second;
+		else
+		{
+			//arguments can be views of generated text, which grows while expanding
+			std::string saved = key;
+			std::vector<std::string> arguments(call.arguments.begin(), call.arguments.end());
+
+			range = _instantiate(macro, arguments, line);
+			instances.emplace(std::move(saved), range);
+		}
+
+		size_t first = into.size();
+		into.insert(into.end(), instanceTokens.begin() + range.first, instanceTokens.begin() + range.last);
+		for(size_t i = first; i < into.size(); ++i)
+			into[i].line = static_cast<int>(line);
+	}
+
+	void TextmacroExpander::_substitute(std::string_view raw, const Template& macro, const std::vector<std::string>& arguments)
+	{
+		size_t at = 0;
+		while(at < raw.size())
+		{
+			auto dollar = raw.find('$', at);
+			auto close = dollar == std::string_view::npos ? dollar : raw.find('$', dollar + 1);
+			if(close == std::string_view::npos)
+			{
+				generated.append(raw.substr(at));
+				return;
+			}
+
+			generated.append(raw.substr(at, dollar - at));
+
+			auto name = raw.substr(dollar + 1, close - dollar - 1);
+			auto parameter = std::find(macro.parameters.begin(), macro.parameters.end(), name);
+			if(parameter == macro.parameters.end())
+			{
+				//just a $ in a string, the closing one may start an argument
+				generated += '$';
+				at = dollar + 1;
+				continue;
+			}
+
+			generated.append(arguments[parameter - macro.parameters.begin()]);
+			at = close + 1;
+		}
+	}
+
+	TokenRange TextmacroExpander::_instantiate(size_t macro, const std::vector<std::string>& arguments, size_t line)
+	{
+		const auto& instance = templates[macro];
+		if(std::find(running.begin(), running.end(), macro) != running.end())
+		{
+			_error(line, "textmacro " + std::string(instance.name) + " runs itself");
+			return { 0, 0 };
+		}
+
+		//every depth of nested runs has its own pair of lists, kept between runs
+		size_t depth = running.size();
+		running.push_back(macro);
+		while(scratch.size() < 2 * depth + 2)
+			scratch.emplace_back();
+
+		auto& body = scratch[2 * depth];
+		auto& expandedBody = scratch[2 * depth + 1];
+		body.clear();
+		expandedBody.clear();
+		for(size_t i = instance.firstPiece; i < instance.lastPiece; ++i)
+		{
+			const auto& piece = pieces[i];
+			if(!piece.substituted)
+			{
+				body.push_back((*tokens)[piece.token]);
+				continue;
+			}
+
+			//only the substituted text is lexed, and its tokens moved past the source
+			size_t offset = generated.size();
+			_substitute(source.substr(piece.textBegin, piece.textEnd - piece.textBegin), instance, arguments);
+
+			pieceLexer.reset();
+			for(auto token : pieceLexer.tokenize(std::string_view(generated).substr(offset)))
+			{
+				token.position += static_cast<int>(source.size() + offset);
+				body.push_back(token);
+			}
+		}
+
+		//runs inside the body are expanded before the instance is stored
+		_expandCalls(body, line, expandedBody);
+		running.pop_back();
+
+		TokenRange range{ instanceTokens.size(), 0 };
+		instanceTokens.insert(instanceTokens.end(), expandedBody.begin(), expandedBody.end());
+		range.last = instanceTokens.size();
+		return range;
+	}
+
+	void TextmacroExpander::_expandCalls(const Lexer::TokenList& list, size_t line, Lexer::TokenList& into)
+	{
+		Call call;
+		for(size_t i = 0; i < list.size();)
+		{
+			auto type = list[i].type;
+			if(type != Token::Type::Keyword_runtextmacro && type != Token::Type::Operator_preprocessor)
+			{
+				into.push_back(list[i++]);
+				continue;
+			}
+
+			switch(_readCall(list, i, call))
+			{
+				case CallKind::None:
+					into.push_back(list[i++]);
+					break;
+				case CallKind::Valid:
+					_splice(call, line, into);
+					i = call.end;
+					break;
+				case CallKind::Invalid:
+					_error(line, "expected runtextmacro name(\"argument\", ...)");
+					i = call.end;
+					while(i < list.size() && list[i].type != Token::Type::Operator_newline)
+						++i;
+
+					break;
+			}
+		}
+	}
+
+	bool TextmacroExpander::expand(const Lexer::TokenList& tokenList, std::string_view input, std::string_view name)
+	{
+		tokens = &tokenList;
+		source = input;
+		fileName = name;
+		errorCount = 0;
+		expanded = false;
+
+		templates.clear();
+		templateIndex.clear();
+		pieces.clear();
+		definitions.clear();
+		instances.clear();
+		instanceTokens.clear();
+		running.clear();
+		generated.clear();
+		output.clear();
+		text.clear();
+		splices.clear();
+
+		if(!_hasMacros())
+			return true;
+
+		expanded = true;
+		_collectTemplates();
+
+		const auto& list = *tokens;
+		output.reserve(list.size());
+
+		Call call;
+		size_t nextDefinition = 0;
+		for(size_t i = 0; i < list.size();)
+		{
+			if(nextDefinition < definitions.size() && i == definitions[nextDefinition].first)
+			{
+				i = definitions[nextDefinition++].last;
+				continue;
+			}
+
+			auto type = list[i].type;
+			if(type == Token::Type::Keyword_runtextmacro || type == Token::Type::Operator_preprocessor)
+			{
+				auto kind = _readCall(list, i, call);
+				if(kind == CallKind::Valid)
+				{
+					size_t before = output.size();
+					_splice(call, list[i].line, output);
+					if(output.size() > before)
+						splices.push_back({ before, output.size() });
+
+					i = call.end;
+					continue;
+				}
+
+				if(kind == CallKind::Invalid)
+				{
+					_error(list[i].line, "expected runtextmacro name(\"argument\", ...)");
+					i = call.end;
+					while(i < list.size() && list[i].type != Token::Type::Operator_newline)
+						++i;
+
+					continue;
+				}
+			}
+
+			output.push_back(list[i++]);
+		}
+
+		text.reserve(source.size() + generated.size());
+		text.append(source);
+		text.append(generated);
+
+		return errorCount == 0;
+	}
+
+	bool TextmacroExpander::hasExpanded() const
+	{
+		return expanded;
+	}
+
+	const Lexer::TokenList& TextmacroExpander::getTokens() const
+	{
+		return output;
+	}
+
+	std::string_view TextmacroExpander::getText() const
+	{
+		return text;
+	}
+
+	const std::vector<TokenRange>& TextmacroExpander::getSplices() const
+	{
+		return splices;
+	}
+
+	size_t TextmacroExpander::getErrorCount() const
+	{
+		return errorCount;
+	}
+}
@@ -0,0 +1,162 @@
+#ifndef _JH_HEADER_TEXTMACROEXPANDER_
+#define _JH_HEADER_TEXTMACROEXPANDER_
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "../Lexer/Lexer.hpp"
+
+namespace jh{
+	//tokens [first, last) of a token list
+	struct TokenRange{
+		size_t first;
+		size_t last;
+	};
+
+	/*
+		Expands textmacros on lexed tokens, before parsing
+
+		Both spellings are understood, textmacro, runtextmacro and endtextmacro as
+		keywords, and as //! lines of vJass. Macros are collected from the whole file
+		first, so they can be run before they are defined.
+
+		Body of every macro is kept as a template, a list of pieces that are either
+		token of the file, used as is, or a span of text holding $ARG$, with the tokens
+		glued to it($NAME$_Init is one identifier once substituted). Running the macro
+		copies the tokens, and substitutes and lexes only the pieces with arguments.
+		Each distinct macro and argument list is expanded once, any other run with the
+		same arguments only copies the tokens of the first one.
+
+		Text produced by substitution is appended after the source, getText is the
+		source followed by it, and every token refers to a position in getText. Tokens
+		from the file keep their position, so only files with textmacros get a copy
+		of the source.
+	*/
+	class TextmacroExpander{
+		//token of the file, or text with arguments substituted on every run
+		struct Piece{
+			size_t token;
+			bool substituted;
+			size_t textBegin;
+			size_t textEnd;
+		};
+
+		struct Template{
+			std::string_view name;
+			std::vector<std::string_view> parameters;
+
+			//range of pieces
+			size_t firstPiece;
+			size_t lastPiece;
+		};
+
+		//runtextmacro as found in tokens
+		struct Call{
+			std::string_view name;
+			bool optional = false;
+			std::vector<std::string_view> arguments;
+
+			//index of the first token past the call
+			size_t end = 0;
+		};
+
+		enum class CallKind{
+			None,
+			Valid,
+			Invalid,
+		};
+
+		const Lexer::TokenList* tokens = nullptr;
+		std::string_view source;
+		std::string fileName;
+
+		std::vector<Template> templates;
+		std::unordered_map<std::string_view, size_t> templateIndex;
+		std::vector<Piece> pieces;
+
+		//token ranges of definitions, skipped in the output
+		std::vector<TokenRange> definitions;
+
+		//every expansion, as range of instanceTokens, keyed by macro and arguments
+		std::unordered_map<std::string, TokenRange> instances;
+		Lexer::TokenList instanceTokens;
+		std::string key;
+
+		//macros being expanded, a macro must not run itself
+		std::vector<size_t> running;
+
+		//body of a run and the body with its own runs expanded, per depth
+		//deque, so that lists of outer runs stay in place while inner ones are added
+		std::deque<Lexer::TokenList> scratch;
+
+		//text made by substitution, placed right after source
+		std::string generated;
+
+		//lexes substituted pieces
+		Lexer pieceLexer;
+
+		Lexer::TokenList output;
+		std::string text;
+		std::vector<TokenRange> splices;
+		bool expanded = false;
+
+		size_t errorCount = 0;
+
+		void _error(size_t line, const std::string& message);
+
+		//returns text of token from the file or from an expansion
+		std::string_view _tokenText(const Token& token) const;
+
+		//returns whether there is anything for the expander in the file
+		bool _hasMacros() const;
+
+		//finds every definition and makes its template
+		void _collectTemplates();
+
+		//makes template of tokens [first, last) of the file
+		void _addTemplate(std::string_view name, std::vector<std::string_view>&& parameters, bool once,
+						  size_t line, size_t first, size_t last);
+
+		//returns whether token at index of list starts runtextmacro, reads it into call
+		CallKind _readCall(const Lexer::TokenList& list, size_t index, Call& call) const;
+
+		//appends tokens of called macro into into, with line of the call
+		void _splice(const Call& call, size_t line, Lexer::TokenList& into);
+
+		//returns tokens of given macro run with given arguments, in instanceTokens
+		TokenRange _instantiate(size_t macro, const std::vector<std::string>& arguments, size_t line);
+
+		//appends raw with every $ARG$ of macro replaced into generated
+		void _substitute(std::string_view raw, const Template& macro, const std::vector<std::string>& arguments);
+
+		//copies list into into, expanding every runtextmacro in it
+		void _expandCalls(const Lexer::TokenList& list, size_t line, Lexer::TokenList& into);
+	public:
+		TextmacroExpander() = default;
+
+		TextmacroExpander(const TextmacroExpander&) = delete;
+		TextmacroExpander& operator=(const TextmacroExpander&) = delete;
+
+		//expands textmacros of tokens lexed from input, fileName is only used in
+		//error messages, returns false if there were any errors
+		bool expand(const Lexer::TokenList& tokenList, std::string_view input, std::string_view name = "");
+
+		//returns whether the file had any textmacros, if not, getTokens and getText
+		//are empty, and the input is to be used as it is
+		bool hasExpanded() const;
+
+		const Lexer::TokenList& getTokens() const;
+		std::string_view getText() const;
+
+		//returns ranges of getTokens that came from textmacros, in order
+		const std::vector<TokenRange>& getSplices() const;
+
+		//returns number of errors reported by the last expand
+		size_t getErrorCount() const;
+	};
+}
+
+#endif	//_JH_HEADER_TEXTMACROEXPANDER_
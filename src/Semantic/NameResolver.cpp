@@ -0,0 +1,297 @@
+#include "NameResolver.hpp"
+#include "../Core/Error.hpp"
+
+namespace jh{
+	void NameResolver::_error(NodeIndex node, const std::string& message)
+	{
+		++errorCount;
+
+		size_t line = ast->token(node).line;
+		if(fileName.empty())
+			error() << "line " << line << ": " << message << "\n";
+		else
+			error() << fileName << ":" << line << ": " << message << "\n";
+	}
+
+	Interner::Symbol NameResolver::_intern(NodeIndex node)
+	{
+		auto token = (*ast)[node].token;
+		if(tokenNames && (*tokenNames)[token] != Interner::invalidSymbol)
+			return (*tokenNames)[token];
+
+		return table.intern(ast->text(node));
+	}
+
+	SymbolIndex NameResolver::_enclosingStruct(ScopeIndex scope) const
+	{
+		for(; scope != SymbolTable::noScope; scope = table.getScope(scope).parent)
+		{
+			const auto& level = table.getScope(scope);
+			if(level.kind == NodeKind::Struct)
+				return level.owner;
+		}
+
+		return noSymbol;
+	}
+
+	SymbolIndex NameResolver::_declare(NodeIndex node, SymbolKind kind, ScopeIndex scope)
+	{
+		const auto& level = table.getScope(scope);
+		auto flags = (*ast)[node].flags;
+		auto name = _intern(node);
+
+		bool prefixed = level.kind == NodeKind::Library || level.kind == NodeKind::Scope;
+		bool isPrivate = prefixed && (flags & NodeFlag::Private);
+		bool isPublic = prefixed && (flags & NodeFlag::Public);
+
+		auto outputName = name;
+		if(level.kind == NodeKind::Struct)
+			outputName = table.mangle(level.publicPrefix, name);
+		else if(isPrivate)
+			outputName = table.mangle(level.privatePrefix, name);
+		else if(isPublic)
+			outputName = table.mangle(level.publicPrefix, name);
+
+		auto symbol = table.add(Declaration{ kind, 0, flags, scope, SymbolTable::noScope, name, outputName, node });
+		nodeSymbols[node] = symbol;
+
+		//libraries and scopes are not names code can refer to
+		if(kind == SymbolKind::Library || kind == SymbolKind::Scope)
+			return symbol;
+
+		//members without modifier are global, public ones are also global under the long name
+		auto visibleIn = prefixed && !isPrivate && !isPublic ? SymbolTable::fileScope : scope;
+		if(table.bind(visibleIn, name, symbol) != symbol ||
+		   (isPublic && table.bind(SymbolTable::fileScope, outputName, symbol) != symbol))
+			_error(node, std::string(ast->text(node)) + " is already declared");
+
+		return symbol;
+	}
+
+	void NameResolver::_declareBlock(NodeIndex block, ScopeIndex scope)
+	{
+		for(auto declaration : ast->children(block))
+		{
+			if(declaration == noNode)
+				continue;
+
+			const auto& node = (*ast)[declaration];
+			switch(node.kind)
+			{
+				case NodeKind::Globals:
+					for(auto variable : ast->children(declaration))
+						_declare(variable, SymbolKind::Global, scope);
+
+					break;
+				case NodeKind::TypeDecl:
+					_declare(declaration, SymbolKind::Type, scope);
+					break;
+				case NodeKind::Native:
+					_declare(declaration, SymbolKind::Native, scope);
+					break;
+				case NodeKind::Function:
+					_declare(declaration, SymbolKind::Function, scope);
+					break;
+				case NodeKind::Variable:
+					_declare(declaration, SymbolKind::Member, scope);
+					break;
+				case NodeKind::Method:
+					//operators share name of the member they stand for, and constructors
+					//and destructors have no name to refer to
+					if(!(node.flags & (NodeFlag::Operator | NodeFlag::Constructor | NodeFlag::Destructor)))
+						_declare(declaration, SymbolKind::Method, scope);
+
+					break;
+				case NodeKind::Allocator:
+					_declareBlock(ast->child(declaration, 0), scope);
+					break;
+				case NodeKind::Library:
+				case NodeKind::Scope:
+				{
+					bool library = node.kind == NodeKind::Library;
+					auto symbol = _declare(declaration, library ? SymbolKind::Library : SymbolKind::Scope, scope);
+					auto body = table.addScope(scope, node.kind, symbol);
+					table[symbol].body = body;
+
+					_declareBlock(ast->child(declaration, library ? 2 : 1), body);
+					break;
+				}
+				case NodeKind::Struct:
+				case NodeKind::Interface:
+				{
+					bool isStruct = node.kind == NodeKind::Struct;
+					auto symbol = _declare(declaration, isStruct ? SymbolKind::Struct : SymbolKind::Interface, scope);
+					auto body = table.addScope(scope, node.kind, symbol);
+					table[symbol].body = body;
+
+					_declareBlock(ast->child(declaration, isStruct ? 1 : 0), body);
+					break;
+				}
+				default:
+					//modules are declared where they are implemented, textmacros are gone
+					break;
+			}
+		}
+	}
+
+	void NameResolver::_resolveBlock(NodeIndex block, ScopeIndex scope)
+	{
+		for(auto declaration : ast->children(block))
+		{
+			if(declaration == noNode)
+				continue;
+
+			const auto& node = (*ast)[declaration];
+			switch(node.kind)
+			{
+				case NodeKind::Globals:
+					for(auto variable : ast->children(declaration))
+						_resolveSubtree(variable, scope);
+
+					break;
+				case NodeKind::TypeDecl:
+				case NodeKind::Variable:
+					_resolveSubtree(declaration, scope);
+					break;
+				case NodeKind::Native:
+				case NodeKind::Function:
+				case NodeKind::Method:
+					_resolveFunction(declaration, scope);
+					break;
+				case NodeKind::Allocator:
+					_resolveBlock(ast->child(declaration, 0), scope);
+					break;
+				case NodeKind::Library:
+				case NodeKind::Scope:
+				{
+					bool library = node.kind == NodeKind::Library;
+					auto body = table[nodeSymbols[declaration]].body;
+
+					//initializer is usually private function of the library itself
+					if(ast->child(declaration, 0) != noNode)
+						_resolveName(ast->child(declaration, 0), body);
+
+					_resolveBlock(ast->child(declaration, library ? 2 : 1), body);
+					break;
+				}
+				case NodeKind::Struct:
+				{
+					auto body = table[nodeSymbols[declaration]].body;
+					if(ast->child(declaration, 0) != noNode)
+						_resolveName(ast->child(declaration, 0), scope);
+
+					_resolveBlock(ast->child(declaration, 1), body);
+					break;
+				}
+				case NodeKind::Interface:
+					_resolveBlock(ast->child(declaration, 0), table[nodeSymbols[declaration]].body);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	void NameResolver::_resolveSubtree(NodeIndex node, ScopeIndex scope)
+	{
+		for(NodeIndex index = ast->subtreeStart(node); index < node; ++index)
+		{
+			const auto& current = (*ast)[index];
+			switch(current.kind)
+			{
+				case NodeKind::Parameter:
+					_declare(index, SymbolKind::Parameter, scope);
+					break;
+				case NodeKind::Local:
+					_declare(index, SymbolKind::Local, scope);
+					break;
+				case NodeKind::Name:
+				case NodeKind::TypeRef:
+					_resolveName(index, scope);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	void NameResolver::_resolveName(NodeIndex node, ScopeIndex scope)
+	{
+		auto type = ast->token(node).type;
+		if(type == Token::Type::Id)
+		{
+			//names that were never interned are not declared anywhere
+			auto name = nameOf(node);
+			if(name != Interner::invalidSymbol)
+				nodeSymbols[node] = table.lookup(scope, name);
+		}
+		else if(type == Token::Type::Keyword_thistype)
+			nodeSymbols[node] = _enclosingStruct(scope);
+	}
+
+	void NameResolver::_resolveFunction(NodeIndex function, ScopeIndex parent)
+	{
+		auto scope = table.addScope(parent, NodeKind::Function, nodeSymbols[function]);
+		if(nodeSymbols[function] != noSymbol)
+			table[nodeSymbols[function]].body = scope;
+
+		_resolveSubtree(function, scope);
+	}
+
+	Interner& NameResolver::prepareNames()
+	{
+		table.clearNames();
+		return table.getNames();
+	}
+
+	bool NameResolver::resolve(const Ast& tree, const std::vector<Interner::Symbol>* symbols, std::string_view name)
+	{
+		ast = &tree;
+		tokenNames = symbols;
+		fileName = name;
+		errorCount = 0;
+
+		if(!tokenNames)
+			table.clearNames();
+
+		table.clear();
+		nodeSymbols.assign(tree.size(), noSymbol);
+
+		auto root = tree.getRoot();
+		if(root == noNode)
+			return true;
+
+		_declareBlock(root, SymbolTable::fileScope);
+		_resolveBlock(root, SymbolTable::fileScope);
+
+		return !errorCount;
+	}
+
+	Interner::Symbol NameResolver::nameOf(NodeIndex node) const
+	{
+		auto token = (*ast)[node].token;
+		if(tokenNames && (*tokenNames)[token] != Interner::invalidSymbol)
+			return (*tokenNames)[token];
+
+		return table.findName(ast->text(node));
+	}
+
+	const SymbolTable& NameResolver::getTable() const
+	{
+		return table;
+	}
+
+	std::string_view NameResolver::outputName(NodeIndex node) const
+	{
+		auto symbol = nodeSymbols[node];
+		if(symbol == noSymbol)
+			return ast->text(node);
+
+		return table.name(table[symbol].outputName);
+	}
+
+	size_t NameResolver::getErrorCount() const
+	{
+		return errorCount;
+	}
+}
@@ -0,0 +1,121 @@
+#ifndef _JH_HEADER_NAMERESOLVER_
+#define _JH_HEADER_NAMERESOLVER_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Parser/Ast.hpp"
+#include "SymbolTable.hpp"
+
+namespace jh{
+	/*
+		Declares every name of Ast into SymbolTable, and binds every use to its declaration
+
+		Runs in two passes. The first one declares everything visible outside functions,
+		types, globals, natives, functions, structs and their members, so they can be used
+		before they are declared, as vJass allows. The second one walks every function,
+		global initializer and member, and resolves each Name and TypeRef.
+
+		vJass visibility:
+			members of libraries and scopes without modifier are global
+			private members are only visible inside, and written as Scope__name
+			public members are visible inside as name, and outside as Scope_name
+		Nested scopes continue the prefix of their parent, Outer_Inner_name. Members and
+		methods of structs are always written as s__Struct_name.
+
+		Names are symbols the lexer interned while lexing, only tokens it did not intern
+		are hashed again. Function bodies are walked as the range of node indices they occupy, since nodes
+		are added children first, so this is one linear pass without recursion, locals are
+		declared when the scan reaches them, after their initial value. Names that are
+		not declared in the file(natives of common.j, ...) are left unresolved, and are
+		written as they are.
+	*/
+	class NameResolver{
+		const Ast* ast = nullptr;
+		SymbolTable table;
+
+		//symbol of every token of the tree in the names of table, invalidSymbol for
+		//tokens that were not interned, nullptr if none were
+		const std::vector<Interner::Symbol>* tokenNames = nullptr;
+
+		//declaration every node declares or refers to, noSymbol for the others
+		std::vector<SymbolIndex> nodeSymbols;
+
+		std::string fileName;
+		size_t errorCount = 0;
+
+		void _error(NodeIndex node, const std::string& message);
+
+		//returns symbol of the token of node, interning its text if the lexer did not
+		Interner::Symbol _intern(NodeIndex node);
+
+		//returns the innermost struct of scope chain, noSymbol outside structs
+		SymbolIndex _enclosingStruct(ScopeIndex scope) const;
+
+		//declares node into scope, and makes it visible according to its modifiers
+		SymbolIndex _declare(NodeIndex node, SymbolKind kind, ScopeIndex scope);
+
+		//first pass over declarations of block inside scope
+		void _declareBlock(NodeIndex block, ScopeIndex scope);
+
+		//second pass over declarations of block
+		void _resolveBlock(NodeIndex block, ScopeIndex scope);
+
+		//resolves every name in subtree of node inside scope, declares parameters and
+		//locals into scope on the way
+		void _resolveSubtree(NodeIndex node, ScopeIndex scope);
+
+		//binds Name or TypeRef to declaration visible from scope
+		void _resolveName(NodeIndex node, ScopeIndex scope);
+
+		//resolves function, native or method in new scope inside parent
+		void _resolveFunction(NodeIndex function, ScopeIndex parent);
+	public:
+		NameResolver() = default;
+
+		NameResolver(const NameResolver&) = delete;
+		NameResolver& operator=(const NameResolver&) = delete;
+
+		//clears the names and returns them, for the lexer to intern identifiers of the
+		//next file into(see Lexer::setInterner), so that names are compared as symbols
+		Interner& prepareNames();
+
+		//resolves names of tree, symbols is the symbol of every token of the tree in the
+		//names given by prepareNames, invalidSymbol for tokens that were not interned
+		//(those spliced in by textmacros), nullptr if no token was, the names are then
+		//cleared and names interned from text, fileName is only used in error messages
+		//returns false if any name was declared twice in one scope
+		bool resolve(const Ast& tree, const std::vector<Interner::Symbol>* symbols, std::string_view name = "");
+
+		//returns symbol of the name of node, Interner::invalidSymbol if no declaration
+		//has that name
+		Interner::Symbol nameOf(NodeIndex node) const;
+
+		const SymbolTable& getTable() const;
+
+		//returns declaration node declares or refers to, noSymbol if there is none
+		SymbolIndex symbolOf(NodeIndex node) const { return nodeSymbols[node]; }
+
+		//returns whether node is written into Jass with other name than its token,
+		//names of structs and interfaces are written as integer
+		bool isRenamed(NodeIndex node) const
+		{
+			auto symbol = nodeSymbols[node];
+			if(symbol == noSymbol)
+				return false;
+
+			const auto& declaration = table[symbol];
+			return declaration.outputName != declaration.name || declaration.kind == SymbolKind::Struct ||
+				   declaration.kind == SymbolKind::Interface;
+		}
+
+		//returns name node is written as in Jass, text of its token if it is not renamed
+		std::string_view outputName(NodeIndex node) const;
+
+		//returns number of errors reported by the last resolve
+		size_t getErrorCount() const;
+	};
+}
+
+#endif	//_JH_HEADER_NAMERESOLVER_
@@ -0,0 +1,168 @@
+#include "SymbolTable.hpp"
+#include <algorithm>
+
+namespace jh{
+	SymbolTable::SymbolTable(size_t expectedSymbols) : names(expectedSymbols)
+	{
+		size_t capacity = 16;
+		while(capacity < expectedSymbols * 2)
+			capacity *= 2;
+
+		slots.assign(capacity, { 0, noSymbol });
+		clear();
+	}
+
+	void SymbolTable::clear()
+	{
+		if(used)
+			std::fill(slots.begin(), slots.end(), Slot{ 0, noSymbol });
+
+		used = 0;
+		fileSymbols.clear();
+		declarations.clear();
+		scopes.clear();
+
+		auto empty = names.intern("");
+		scopes.push_back(ScopeLevel{ noScope, NodeKind::File, noSymbol, empty, empty, 0 });
+	}
+
+	void SymbolTable::clearNames()
+	{
+		names.clear();
+	}
+
+	void SymbolTable::reserve(size_t symbolCount)
+	{
+		declarations.reserve(symbolCount);
+		while(slots.size() < symbolCount * 2)
+			_grow();
+	}
+
+	Interner::Symbol SymbolTable::mangle(Interner::Symbol prefix, Interner::Symbol name)
+	{
+		scratch.assign(names.name(prefix));
+		scratch += names.name(name);
+		return names.intern(scratch);
+	}
+
+	ScopeIndex SymbolTable::addScope(ScopeIndex parent, NodeKind kind, SymbolIndex owner)
+	{
+		ScopeLevel scope{ parent, kind, owner, scopes[parent].publicPrefix, scopes[parent].privatePrefix, 0 };
+
+		//libraries and scopes prefix their members, structs prefix all of them
+		if(kind == NodeKind::Library || kind == NodeKind::Scope)
+		{
+			scratch.assign(names.name(scopes[parent].publicPrefix));
+			scratch += names.name(declarations[owner].name);
+			scratch += '_';
+			scope.publicPrefix = names.intern(scratch);
+
+			scratch += '_';
+			scope.privatePrefix = names.intern(scratch);
+		}
+		else if(kind == NodeKind::Struct)
+		{
+			//members of structs are globals of Jass, s__Name_member
+			scratch.assign("s__");
+			scratch += names.name(declarations[owner].outputName);
+			scratch += '_';
+			scope.publicPrefix = names.intern(scratch);
+			scope.privatePrefix = scope.publicPrefix;
+		}
+
+		scopes.push_back(scope);
+		return static_cast<ScopeIndex>(scopes.size() - 1);
+	}
+
+	SymbolIndex SymbolTable::add(const Declaration& declaration)
+	{
+		declarations.push_back(declaration);
+		return static_cast<SymbolIndex>(declarations.size() - 1);
+	}
+
+	SymbolIndex SymbolTable::bind(ScopeIndex scope, Interner::Symbol name, SymbolIndex symbol)
+	{
+		if(scope == fileScope)
+		{
+			if(name >= fileSymbols.size())
+				fileSymbols.resize(names.size(), noSymbol);
+
+			auto& bound = fileSymbols[name];
+			if(bound == noSymbol)
+				bound = symbol;
+
+			return bound;
+		}
+
+		scopes[scope].boundNames |= std::uint64_t(1) << (name & 63);
+
+		auto key = _key(scope, name);
+		size_t mask = slots.size() - 1;
+
+		for(size_t index = _hash(key) & mask;; index = (index + 1) & mask)
+		{
+			auto& slot = slots[index];
+			if(slot.symbol == noSymbol)
+			{
+				slot = { key, symbol };
+				if(++used * 2 > slots.size())
+					_grow();
+
+				return symbol;
+			}
+
+			if(slot.key == key)
+				return slot.symbol;
+		}
+	}
+
+	SymbolIndex SymbolTable::find(ScopeIndex scope, Interner::Symbol name) const
+	{
+		if(scope == fileScope)
+			return name < fileSymbols.size() ? fileSymbols[name] : noSymbol;
+
+		if(!(scopes[scope].boundNames & (std::uint64_t(1) << (name & 63))))
+			return noSymbol;
+
+		auto key = _key(scope, name);
+		size_t mask = slots.size() - 1;
+
+		for(size_t index = _hash(key) & mask;; index = (index + 1) & mask)
+		{
+			const auto& slot = slots[index];
+			if(slot.symbol == noSymbol || slot.key == key)
+				return slot.symbol;
+		}
+	}
+
+	SymbolIndex SymbolTable::lookup(ScopeIndex scope, Interner::Symbol name) const
+	{
+		for(; scope != noScope; scope = scopes[scope].parent)
+		{
+			auto symbol = find(scope, name);
+			if(symbol != noSymbol)
+				return symbol;
+		}
+
+		return noSymbol;
+	}
+
+	void SymbolTable::_grow()
+	{
+		std::vector<Slot> old(slots.size() * 2, { 0, noSymbol });
+		old.swap(slots);
+
+		size_t mask = slots.size() - 1;
+		for(const auto& slot : old)
+		{
+			if(slot.symbol == noSymbol)
+				continue;
+
+			size_t index = _hash(slot.key) & mask;
+			while(slots[index].symbol != noSymbol)
+				index = (index + 1) & mask;
+
+			slots[index] = slot;
+		}
+	}
+}
@@ -0,0 +1,189 @@
+#ifndef _JH_HEADER_SYMBOLTABLE_
+#define _JH_HEADER_SYMBOLTABLE_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Core/Interner.hpp"
+#include "../Parser/Ast.hpp"
+
+namespace jh{
+	using SymbolIndex = std::uint32_t;
+	using ScopeIndex = std::uint32_t;
+
+	//stands in for name that is not declared in the file
+	constexpr SymbolIndex noSymbol = 0xFFFFFFFF;
+
+	enum class SymbolKind : std::uint8_t{
+		Library,
+		Scope,
+		Type,
+		Struct,
+		Interface,
+		Global,
+		Native,
+		Function,
+		Member,
+		Method,
+		Parameter,
+		Local,
+	};
+
+	//single declared name
+	struct Declaration{
+		SymbolKind kind;
+		std::uint8_t unused = 0;
+
+		//NodeFlag of the declaration
+		std::uint16_t flags;
+
+		//scope the name is declared in, and the one it opens(members of struct,
+		//locals of function, ...), noScope if it opens none
+		ScopeIndex scope;
+		ScopeIndex body;
+
+		Interner::Symbol name;
+
+		//name written into Jass, differs from name for private and public members
+		//of libraries and scopes, and for members of structs
+		Interner::Symbol outputName;
+
+		NodeIndex node;
+	};
+
+	//level of the scope chain, file, library, scope, struct or function
+	struct ScopeLevel{
+		ScopeIndex parent;
+		NodeKind kind;
+
+		//declaration that opened the scope, noSymbol for the file
+		SymbolIndex owner;
+
+		//prepended to names of public and private members, Name_ and Name__
+		//the prefix of nested scope continues the one of its parent, structs prefix
+		//every member by s__Name_
+		Interner::Symbol publicPrefix;
+		Interner::Symbol privatePrefix;
+
+		//bit name % 64 is set for every name bound in the scope, so that lookup skips
+		//most scopes that do not have the name without probing the table
+		std::uint64_t boundNames = 0;
+	};
+
+	/*
+		Declarations of single file, and the scopes they are declared in
+
+		Names are interned, usually by the lexer already, and every scope maps them
+		to declarations through one shared open addressing table keyed by scope and
+		symbol together, so looking name up in one scope is single hash of two
+		integers and usually single probe. Scopes form a chain by parent index in
+		compact array, lookup walks it from the innermost scope out, which is few
+		levels even for methods of structs in libraries.
+
+		Most names used in a function are globals, so the file scope is not in the table,
+		but in an array indexed by the symbol itself, and every scope keeps a filter of
+		the names bound in it, so that looking global up from inside a function usually
+		does not touch the table at all.
+
+		Mangled names of private and public members are made once, when the member is
+		declared, by prefix of its scope that is interned already, so uses only copy
+		the symbol.
+	*/
+	class SymbolTable{
+		struct Slot{
+			std::uint64_t key;
+			SymbolIndex symbol;
+		};
+
+		//power of two in size, kept at most half full
+		std::vector<Slot> slots;
+		size_t used = 0;
+
+		//declarations of the file scope, indexed by name
+		std::vector<SymbolIndex> fileSymbols;
+
+		std::vector<Declaration> declarations;
+		std::vector<ScopeLevel> scopes;
+		Interner names;
+
+		//builds mangled names
+		std::string scratch;
+
+		static std::uint64_t _key(ScopeIndex scope, Interner::Symbol name)
+		{
+			return (static_cast<std::uint64_t>(scope) << 32) | name;
+		}
+
+		static size_t _hash(std::uint64_t key)
+		{
+			//fibonacci hashing, the high bits are well mixed even for sequential keys
+			return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+		}
+
+		//doubles the table and places every entry again
+		void _grow();
+	public:
+		static constexpr ScopeIndex fileScope = 0;
+		static constexpr ScopeIndex noScope = 0xFFFFFFFF;
+
+		explicit SymbolTable(size_t expectedSymbols = 1024);
+
+		SymbolTable(const SymbolTable&) = delete;
+		SymbolTable& operator=(const SymbolTable&) = delete;
+
+		//removes every declaration and scope apart from the file, keeping the memory
+		//names stay, they are cleared by clearNames
+		void clear();
+
+		//removes every interned name, the table has to be cleared after it as well
+		void clearNames();
+
+		//returns the names, which the lexer interns identifiers of the file into before
+		//they are declared, see Lexer::setInterner
+		Interner& getNames() { return names; }
+
+		//reserves memory for given number of declarations
+		void reserve(size_t symbolCount);
+
+		//returns symbol of given name, adding it if it was not interned yet
+		Interner::Symbol intern(std::string_view name) { return names.intern(name); }
+
+		//returns symbol of given name, Interner::invalidSymbol if it was never interned
+		Interner::Symbol findName(std::string_view name) const { return names.find(name); }
+
+		//returns interned prefix + name
+		Interner::Symbol mangle(Interner::Symbol prefix, Interner::Symbol name);
+
+		//adds scope inside parent, opened by owner, which names the prefixes
+		ScopeIndex addScope(ScopeIndex parent, NodeKind kind, SymbolIndex owner);
+
+		//adds declaration, without making it visible in any scope, see bind
+		SymbolIndex add(const Declaration& declaration);
+
+		//makes symbol visible as name inside scope, returns the symbol already bound
+		//to the name in that scope if there is one, symbol otherwise
+		SymbolIndex bind(ScopeIndex scope, Interner::Symbol name, SymbolIndex symbol);
+
+		//returns symbol bound to name in given scope only, noSymbol if there is none
+		SymbolIndex find(ScopeIndex scope, Interner::Symbol name) const;
+
+		//returns symbol bound to name in given scope, or the closest one of its parents
+		SymbolIndex lookup(ScopeIndex scope, Interner::Symbol name) const;
+
+		const Declaration& operator[](SymbolIndex symbol) const { return declarations[symbol]; }
+		Declaration& operator[](SymbolIndex symbol) { return declarations[symbol]; }
+
+		const ScopeLevel& getScope(ScopeIndex scope) const { return scopes[scope]; }
+
+		std::string_view name(Interner::Symbol symbol) const { return names.name(symbol); }
+
+		//returns number of declarations
+		size_t size() const { return declarations.size(); }
+
+		size_t getScopeCount() const { return scopes.size(); }
+	};
+}
+
+#endif	//_JH_HEADER_SYMBOLTABLE_